@@ -70,6 +70,11 @@ if __name__ == '__main__':
 
     parsed_test = config.parse.parse_config({'executable_name': '000-test-main'}, module_dir=[os.path.join(test_root, 'cpp', 'modules')], compile_all_modules=True)
 
+    # The prefetcher harness may replay access logs to any prefetcher in the search path. It models replacement itself, so besides the prefetchers it
+    # only compiles the modules of the default configuration.
+    harness_name, harness_elements, harness_modules, harness_module_info, *harness_rest = config.parse.parse_config({'executable_name': 'prefetcher-harness'}, module_dir=args.module_dir, pref_dir=args.prefetcher_dir)
+    parsed_harness = (harness_name, harness_elements, sorted(set(harness_modules) | set(harness_module_info['pref'])), harness_module_info, *harness_rest)
+
     parsed_configs = (
             config.parse.parse_config(*c, module_dir=args.module_dir, branch_dir=args.branch_dir, btb_dir=args.btb_dir, pref_dir=args.prefetcher_dir, repl_dir=args.replacement_dir, compile_all_modules=args.compile_all_modules)
         for c in config_files)
@@ -78,5 +83,6 @@ if __name__ == '__main__':
         for c in parsed_configs:
             wr.write_files(c)
         wr.write_files(parsed_test, bindir_name=os.path.join(test_root, 'bin'), srcdir_names=[os.path.join(test_root, 'cpp', 'src')], objdir_name=os.path.join(objdir_name, 'test'))
+        wr.write_files(parsed_harness, srcdir_names=[os.path.join(champsim_root, 'harness')], objdir_name=os.path.join(objdir_name, 'harness'))
 
 # vim: set filetype=python:
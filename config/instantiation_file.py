@@ -18,12 +18,14 @@ import operator
 
 from . import util
 
-pmem_fmtstr = 'MEMORY_CONTROLLER {name}{{{frequency}, {io_freq}, {tRP}, {tRCD}, {tCAS}, {turn_around_time}, {{{_ulptr}}}}};'
-vmem_fmtstr = 'VirtualMemory vmem{{{pte_page_size}, {num_levels}, {minor_fault_penalty}, {dram_name}}};'
+pmem_fmtstr = 'MEMORY_CONTROLLER {name}{{{frequency}, {io_freq}, {tRP}, {tRCD}, {tCAS}, {turn_around_time}, {{{_ulptr}}}{_far}}};'
+far_memory_fmtstr = ', FAR_MEMORY{{{io_freq}, {link_queue_size}, {link_latency}, {device_latency}, {transfer_time}, {migration_threshold}, {migration_pages}}}'
+vmem_fmtstr = 'VirtualMemory vmem{{{pte_page_size}, {num_levels}, {minor_fault_penalty}, {dram_name}, VirtualMemory::placement_type::{placement}}};'
 
 queue_fmtstr = 'champsim::channel {name}{{{rq_size}, {pq_size}, {wq_size}, {_offset_bits}, {_queue_check_full_addr:b}}};'
 
 core_builder_parts = {
+    'ftq_size': '.ftq_size({ftq_size})',
     'ifetch_buffer_size': '.ifetch_buffer_size({ifetch_buffer_size})',
     'decode_buffer_size': '.decode_buffer_size({dispatch_buffer_size})',
     'dispatch_buffer_size': '.dispatch_buffer_size({decode_buffer_size})',
@@ -43,6 +45,14 @@ core_builder_parts = {
     'dispatch_latency': '.dispatch_latency({dispatch_latency})',
     'schedule_latency': '.schedule_latency({schedule_latency})',
     'execute_latency': '.execute_latency({execute_latency})',
+    'physical_registers': '.physical_registers({physical_registers})',
+    'model': '.model(O3_CPU::model_type::{model})',
+    'mlp_window': '.mlp_window({mlp_window})',
+    'issue_width': '.issue_width({issue_width})',
+    'dependent_loads': '.dependent_loads({dependent_loads:b})',
+    'threads': '.threads({threads})',
+    'fetch_policy': '.fetch_policy(O3_CPU::fetch_policy_type::{fetch_policy})',
+    'partitioned_queues': '.partitioned_queues({partitioned_queues:b})',
     'dib_set': '  .dib_set({dib_set})',
     'dib_way': '  .dib_way({dib_way})',
     'dib_window': '  .dib_window({dib_window})'
@@ -65,7 +75,24 @@ cache_builder_parts = {
     'fill_latency': '.fill_latency({fill_latency})',
     'max_tag_check': '.tag_bandwidth({max_tag_check})',
     'max_fill': '.fill_bandwidth({max_fill})',
-    '_offset_bits': '.offset_bits({_offset_bits})'
+    '_offset_bits': '.offset_bits({_offset_bits})',
+    'prefetch_arbitration': '.prefetch_arbitration(champsim::prefetch_arbiter::policy::{prefetch_arbitration})',
+    'access_log': '.access_log("{access_log}")'
+}
+
+dram_cache_builder_parts = {
+    'frequency': '.frequency({frequency})',
+    'io_freq': '.io_frequency({io_freq})',
+    'sets': '.sets({sets})',
+    'mshr_size': '.mshr_size({mshr_size})',
+    'max_tag_check': '.tag_bandwidth({max_tag_check})',
+    'max_fill': '.fill_bandwidth({max_fill})',
+    'channels': '.channels({channels})',
+    'banks': '.banks({banks})',
+    'row_size': '.row_size({row_size})',
+    'channel_width': '.channel_width({channel_width})',
+    'tCAS': '.timing({tRP}, {tRCD}, {tCAS})',
+    'miss_predictor_size': '.miss_predictor_size({miss_predictor_size})'
 }
 
 default_ptw_queue = {
@@ -82,10 +109,11 @@ def vector_string(iterable):
         return hoisted[0]
     return '{'+', '.join(hoisted)+'}'
 
-def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
+def get_instantiation_lines(cores, caches, ptws, pmem, vmem, dram_caches=tuple()):
     upper_level_pairs = tuple(itertools.chain(
         ((elem['lower_level'], elem['name']) for elem in ptws),
         ((elem['lower_level'], elem['name']) for elem in caches),
+        ((elem['lower_level'], elem['name']) for elem in dram_caches),
         ((elem['lower_translate'], elem['name']) for elem in caches if 'lower_translate' in elem),
         *(((elem['L1I'], elem['name']), (elem['L1D'], elem['name'])) for elem in cores)
     ))
@@ -95,6 +123,7 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
     subdict_keys = ('rq_size', 'pq_size', 'wq_size', '_offset_bits', '_queue_check_full_addr')
     upper_levels = util.chain(upper_levels,
             *({c['name']: util.subdict(c, subdict_keys)} for c in caches),
+            *({d['name']: util.subdict(d, subdict_keys)} for d in dram_caches),
             *({p['name']: util.chain(default_ptw_queue, util.subdict(p, subdict_keys))} for p in ptws),
             {pmem['name']: {
                     'rq_size':'std::numeric_limits<std::size_t>::max()',
@@ -120,6 +149,7 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
 
     yield pmem_fmtstr.format(
             _ulptr=vector_string('&{}_to_{}_queues'.format(ul, pmem['name']) for ul in upper_levels[pmem['name']]['uppers']),
+            _far=far_memory_fmtstr.format(io_freq=pmem['io_freq'], **pmem['far_memory']) if 'far_memory' in pmem else '',
             **pmem)
     yield vmem_fmtstr.format(dram_name=pmem['name'], **vmem)
 
@@ -160,12 +190,19 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
             ('wq_check_full_addr', True): '.set_wq_checks_full_addr()',
             ('wq_check_full_addr', False): '.reset_wq_checks_full_addr()',
             ('virtual_prefetch', True): '.set_virtual_prefetch()',
-            ('virtual_prefetch', False): '.reset_virtual_prefetch()'
+            ('virtual_prefetch', False): '.reset_virtual_prefetch()',
+            ('prefetch_throttle', True): '.set_prefetch_throttle()',
+            ('prefetch_throttle', False): '.reset_prefetch_throttle()',
+            ('prefetch_bandit', True): '.set_prefetch_bandit()',
+            ('prefetch_bandit', False): '.reset_prefetch_bandit()'
         }
 
         yield from (v.format(**elem) for k,v in cache_builder_parts.items() if k in elem)
         yield from (v.format(**elem) for k,v in local_cache_builder_parts.items() if k[0] in elem and k[1] == elem[k[0]])
 
+        if elem.get('prefetcher_parameters'):
+            yield '.prefetcher_parameters({{{}}})'.format(', '.join('{{"{}", {}}}'.format(k,v) for k,v in elem['prefetcher_parameters'].items()))
+
         # Create prefetch activation masks
         if 'prefetch_activate' in elem:
             yield '.prefetch_activate({})'.format(', '.join('access_type::'+t for t in elem['prefetch_activate']))
@@ -185,6 +222,18 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
         yield '};'
         yield ''
 
+    for elem in dram_caches:
+        yield 'DRAM_CACHE {}{{DRAM_CACHE::Builder{{}}'.format(elem['name'])
+        yield '.name("{name}")'.format(**elem)
+
+        yield from (v.format(**elem) for k,v in dram_cache_builder_parts.items() if k in elem)
+
+        yield '.upper_levels({{{}}})'.format(vector_string('&{}_to_{}_queues'.format(ul, elem['name']) for ul in upper_levels[elem['name']]['uppers']))
+        yield '.lower_level({})'.format('&{}_to_{}_queues'.format(elem['name'], elem['lower_level']))
+
+        yield '};'
+        yield ''
+
     for cpu in cores:
         yield 'O3_CPU {}{{O3_CPU::Builder{{ champsim::defaults::default_core }}'.format(cpu['name'])
 
@@ -230,12 +279,20 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
     yield '}'
     yield ''
 
+    if dram_caches:
+        yield 'std::vector<std::reference_wrapper<DRAM_CACHE>> dram_cache_view() override {'
+        yield '  return {'
+        yield '    ' + ', '.join('{name}'.format(**elem) for elem in dram_caches)
+        yield '  };'
+        yield '}'
+        yield ''
+
     yield 'MEMORY_CONTROLLER& dram_view() override {{ return {}; }}'.format(pmem['name'])
     yield ''
 
     yield 'std::vector<std::reference_wrapper<champsim::operable>> operable_view() override {'
     yield '  return {'
-    yield '    ' + ', '.join('{name}'.format(**elem) for elem in itertools.chain(cores, ptws, caches, (pmem,)))
+    yield '    ' + ', '.join('{name}'.format(**elem) for elem in itertools.chain(cores, ptws, caches, dram_caches, (pmem,)))
     yield '  };'
     yield '}'
     yield ''
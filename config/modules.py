@@ -13,6 +13,7 @@
 # limitations under the License.
 
 import os
+import re
 import itertools
 
 from . import util
@@ -44,6 +45,21 @@ class ModuleSearchContext:
         files = itertools.starmap(os.path.join, itertools.chain(*(zip(itertools.repeat(b), d) for b,d,_ in base_dirs)))
         return [self.data_from_path(f) for f in files]
 
+# Whether the sources of a module define the given function. Modules found without a path are assumed to define every function.
+def defines_function(module_data, fname):
+    path = module_data.get('fname')
+    if path is None or not os.path.isdir(path):
+        return True
+
+    pattern = re.compile(r'\b{}\s*\('.format(fname))
+    for base, _, files in os.walk(path):
+        for f in files:
+            if os.path.splitext(f)[1] in ('.c', '.cc', '.cpp', '.h', '.hpp'):
+                with open(os.path.join(base, f)) as rfp:
+                    if pattern.search(rfp.read()):
+                        return True
+    return False
+
 # A unifying function for the four module types to return their information
 def data_getter(prefix, module_name, funcs):
     return {
@@ -61,7 +77,7 @@ def get_btb_data(module_name):
 def get_pref_data(module_name, is_instruction_cache=False):
     prefix = 'ipref' if is_instruction_cache else 'pref'
     return util.chain(
-            data_getter(prefix, module_name, ('prefetcher_initialize', 'prefetcher_cache_operate', 'prefetcher_branch_operate', 'prefetcher_cache_fill', 'prefetcher_cycle_operate', 'prefetcher_final_stats')),
+            data_getter(prefix, module_name, ('prefetcher_initialize', 'prefetcher_cache_operate', 'prefetcher_branch_operate', 'prefetcher_cache_fill', 'prefetcher_cycle_operate', 'prefetcher_final_stats', 'prefetcher_aggressiveness_update', 'prefetcher_configuration_update')),
             { 'deprecated_func_map' : {
                     'l1i_prefetcher_initialize': '_'.join((prefix, module_name, 'prefetcher_initialize')),
                     'l1d_prefetcher_initialize': '_'.join((prefix, module_name, 'prefetcher_initialize')),
@@ -113,31 +129,41 @@ def discriminator_function_declaration(fname, rtype, args, varname, secondary_va
     argstring = ', '.join((a[0]+' '+a[1]) for a in args)
     yield '{} {}::impl_{}({})'.format(rtype, classname, fname, argstring)
 
+# Generate C++ code that records which module variant is about to be called, if the owner tracks it
+def discriminator_marked_call(call, k, classname, marker):
+    if marker is None:
+        return call
+    return '{{ intern_->{} = {}::{}; {} }}'.format(marker, classname, k, call)
+
 # Generate C++ code for the body of a discriminator function that returns void
-def discriminator_function_definition_void(fname, args, varname, zipped_keys_and_funcs, classname):
+def discriminator_function_definition_void(fname, args, varname, zipped_keys_and_funcs, classname, marker=None):
+    # An optional function that no module defines ignores its arguments
+    if len(zipped_keys_and_funcs) == 0:
+        yield from ('  (void){};'.format(a[1]) for a in args)
+
     # Discriminate between the module variants
-    yield from ('  if constexpr (({} & {}::{}) != 0) intern_->{}({});'.format(varname, classname, k, n, ', '.join(a[1] for a in args)) for k,n in zipped_keys_and_funcs)
+    yield from ('  if constexpr (({} & {}::{}) != 0) {}'.format(varname, classname, k, discriminator_marked_call('intern_->{}({});'.format(n, ', '.join(a[1] for a in args)), k, classname, marker)) for k,n in zipped_keys_and_funcs)
 
 # Generate C++ code for the body of a discriminator function that returns nonvoid
-def discriminator_function_definition_nonvoid(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname):
+def discriminator_function_definition_nonvoid(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname, marker=None):
     # Declare result
     yield '  ' + rtype + ' result{};'
     yield '  ' + join_op + '<decltype(result)> joiner{};'
 
     # Discriminate between the module variants
-    yield from ('  if constexpr (({} & {}::{}) != 0) result = joiner(result, intern_->{}({}));'.format(varname, classname, k, n, ', '.join(a[1] for a in args)) for k,n in zipped_keys_and_funcs)
+    yield from ('  if constexpr (({} & {}::{}) != 0) {}'.format(varname, classname, k, discriminator_marked_call('result = joiner(result, intern_->{}({}));'.format(n, ', '.join(a[1] for a in args)), k, classname, marker)) for k,n in zipped_keys_and_funcs)
 
     # Return result
     yield '  return result;'
 
 # Generate C++ code for the body of a discriminator function
-def discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname):
+def discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname, marker=None):
     yield '{'
 
     if rtype == 'void':
-        yield from discriminator_function_definition_void(fname, args, varname, zipped_keys_and_funcs, classname)
+        yield from discriminator_function_definition_void(fname, args, varname, zipped_keys_and_funcs, classname, marker=marker)
     else:
-        yield from discriminator_function_definition_nonvoid(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname)
+        yield from discriminator_function_definition_nonvoid(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname, marker=marker)
 
     yield '}'
 
@@ -147,15 +173,22 @@ def get_module_variant_declarations(fname, fnamelist, args=tuple(), rtype='void'
     yield ''
 
 # For a given module function, generate C++ code defining the discriminator function
-def get_discriminator(fname, varname, secondary_varname, zipped_keys_and_funcs, args=tuple(), rtype='void', join_op=None, *tail, classname=None):
+def get_discriminator(fname, varname, secondary_varname, zipped_keys_and_funcs, args=tuple(), rtype='void', join_op=None, *tail, classname=None, marker=None):
     yield from discriminator_function_declaration(fname, rtype, args, varname, secondary_varname, classname)
-    yield from discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname.split(':')[0])
+    yield from discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname.split(':')[0], marker=marker)
     yield ''
 
 # For a set of module data, generate C++ code defining the constants that distinguish the modules
 def constants_for_modules(prefix, mod_data):
     yield from ('constexpr static unsigned long long {0}{2:{prec}} = 1ull << {1};'.format(prefix, n, data['name'], prec=max(len(k['name']) for k in mod_data)) for n,data in enumerate(mod_data))
 
+# For a set of module data, generate C++ code naming the module behind each constant
+def names_for_modules(prefix, mod_data, arrayname):
+    mod_data = list(mod_data)
+    yield 'constexpr static std::array<std::pair<unsigned long long, std::string_view>, {}> {}{{{{'.format(len(mod_data), arrayname)
+    yield from ('  std::pair{{{}{}, std::string_view{{"{}"}}}},'.format(prefix, data['name'], os.path.basename(data.get('fname', data['name']))) for data in mod_data)
+    yield '}};'
+
 # Return a pair containing two generators: The first generates C++ code declaring all functions for the O3_CPU modules, and the second generates C++ code defining the functions
 def get_ooo_cpu_module_lines(branch_data, btb_data):
     branch_prefix = 'b'
@@ -205,6 +238,15 @@ def get_cache_module_lines(pref_data, repl_data):
         ('prefetcher_final_stats',)
     ]
 
+    # Functions that a prefetcher may leave undefined, in which case it is not called
+    pref_optional_variant_data = [
+        ('prefetcher_aggressiveness_update', (('unsigned', 'level'),)),
+        ('prefetcher_configuration_update', (('unsigned', 'degree'), ('unsigned', 'distance')))
+    ]
+
+    def pref_defining(fname):
+        return [v for v in pref_data.values() if defines_function(v, fname)]
+
     pref_branch_variant_data = [
         ('prefetcher_branch_operate', (('uint64_t', 'ip'), ('uint8_t', 'branch_type'), ('uint64_t', 'branch_target')))
     ]
@@ -225,9 +267,11 @@ def get_cache_module_lines(pref_data, repl_data):
         itertools.chain(
             constants_for_modules(pref_prefix, pref_data.values()), ('',),
             constants_for_modules(repl_prefix, repl_data.values()), ('',),
+            names_for_modules(pref_prefix, pref_data.values(), 'prefetcher_names'), ('',),
 
             # Establish functions common to all prefetchers
             *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in pref_data.values()], *finfo) for fname, *finfo in pref_nonbranch_variant_data),
+            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in pref_defining(fname)], *finfo) for fname, *finfo in pref_optional_variant_data),
 
             # Establish functions that only matter to instruction prefetchers
             ('', '// Assert data prefetchers do not operate on branches'),
@@ -239,7 +283,8 @@ def get_cache_module_lines(pref_data, repl_data):
         ),
 
         itertools.chain(
-            *(get_discriminator(fname, pref_varname, repl_varname, [(pref_prefix + v['name'], v['func_map'][fname]) for v in pref_data.values()], *finfo, classname=classname) for fname, *finfo in itertools.chain(pref_nonbranch_variant_data, pref_branch_variant_data)),
+            *(get_discriminator(fname, pref_varname, repl_varname, [(pref_prefix + v['name'], v['func_map'][fname]) for v in pref_data.values()], *finfo, classname=classname, marker='active_prefetcher') for fname, *finfo in itertools.chain(pref_nonbranch_variant_data, pref_branch_variant_data)),
+            *(get_discriminator(fname, pref_varname, repl_varname, [(pref_prefix + v['name'], v['func_map'][fname]) for v in pref_defining(fname)], *finfo, classname=classname, marker='active_prefetcher') for fname, *finfo in pref_optional_variant_data),
             *(get_discriminator(fname, repl_varname, pref_varname, [(repl_prefix + v['name'], v['func_map'][fname]) for v in repl_data.values()], *finfo, classname=classname) for fname, *finfo in repl_variant_data)
         )
        )
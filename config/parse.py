@@ -24,7 +24,9 @@ from . import util
 default_root = { 'block_size': 64, 'page_size': 4096, 'heartbeat_frequency': 10000000, 'num_cores': 1 }
 default_core = { 'frequency' : 4000 }
 default_pmem = { 'name': 'DRAM', 'frequency': 3200, 'channels': 1, 'ranks': 1, 'banks': 8, 'rows': 65536, 'columns': 128, 'lines_per_column': 8, 'channel_width': 8, 'wq_size': 64, 'rq_size': 64, 'tRP': 12.5, 'tRCD': 12.5, 'tCAS': 12.5, 'turn_around_time': 7.5 }
-default_vmem = { 'pte_page_size': (1 << 12), 'num_levels': 5, 'minor_fault_penalty': 200 }
+default_vmem = { 'pte_page_size': (1 << 12), 'num_levels': 5, 'minor_fault_penalty': 200, 'placement': 'first_touch' }
+default_dram_cache = { 'name': 'DRC', 'frequency': 2000, 'sets': (1 << 20), 'mshr_size': 64, 'max_tag_check': 2, 'max_fill': 2, 'rq_size': 64, 'wq_size': 64, 'pq_size': 64, 'channels': 8, 'banks': 16, 'row_size': 2048, 'channel_width': 16, 'tRP': 14, 'tRCD': 14, 'tCAS': 14, 'miss_predictor_size': 256 }
+default_far_memory = { 'link_queue_size': 64, 'link_latency': 25, 'device_latency': 80, 'transfer_time': 2, 'migration_threshold': 0, 'migration_pages': 1024 }
 
 cache_deprecation_keys = {
     'max_read': 'max_tag_check',
@@ -69,7 +71,7 @@ def normalize_config(config_file):
 
     # Default core elements
     # Give cores numeric indices
-    core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB')
+    core_keys_to_copy = ('frequency', 'ftq_size', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'physical_registers', 'model', 'mlp_window', 'issue_width', 'dependent_loads', 'threads', 'fetch_policy', 'partitioned_queues', 'branch_predictor', 'btb', 'DIB')
     cores = [util.chain(cpu, util.subdict(config_file, core_keys_to_copy), {'name': 'cpu'+str(i), '_index': i}) for i,cpu in enumerate(cores)]
 
     pinned_cache_names = ('L1I', 'L1D', 'ITLB', 'DTLB', 'L2C', 'STLB')
@@ -119,6 +121,8 @@ def parse_normalized(cores, caches, ptws, pmem, vmem, merged_configs, branch_con
 
     pmem = util.chain(pmem, default_pmem)
     vmem = util.chain(vmem, default_vmem)
+    if 'far_memory' in pmem:
+        pmem['far_memory'] = util.chain(pmem['far_memory'], default_far_memory)
 
     cores = [util.chain(cpu, {'DIB': dict()}, default_core) for cpu in cores]
 
@@ -160,8 +164,15 @@ def parse_normalized(cores, caches, ptws, pmem, vmem, merged_configs, branch_con
     # Remove caches that are inaccessible
     caches = filter_inaccessible(caches, [cpu[name] for cpu,name in itertools.product(cores, ('ITLB', 'DTLB', 'L1I', 'L1D'))])
 
+    # A DRAM cache sits between the last-level caches and the physical memory
+    dram_caches = []
+    if 'dram_cache' in merged_configs:
+        drc = util.chain(merged_configs['dram_cache'], {'lower_level': pmem['name'], '_offset_bits': 'champsim::lg2(' + str(config_file['block_size']) + ')', '_queue_check_full_addr': False}, default_dram_cache)
+        drc['io_freq'] = drc['frequency'] # Save value
+        dram_caches.append(drc)
+
     pmem['io_freq'] = pmem['frequency'] # Save value
-    scale_frequencies(itertools.chain(cores, caches.values(), ptws.values(), (pmem,)))
+    scale_frequencies(itertools.chain(cores, caches.values(), ptws.values(), dram_caches, (pmem,)))
 
     # TODO can these be removed in favor of the defaults in inc/defaults.hpp?
     # All cores have a default branch predictor and BTB
@@ -199,12 +210,16 @@ def parse_normalized(cores, caches, ptws, pmem, vmem, merged_configs, branch_con
             ({'name': c['name'], '_prefetcher_data': [util.chain({'_is_instruction_prefetcher': c.get('_is_instruction_cache',False)}, prefetcher_context.find(f)) for f in util.wrap_list(c.get('prefetcher',[]))]} for c in caches.values())
             )
 
+    # Caches that would end at the physical memory end at the DRAM cache instead
+    for drc in dram_caches:
+        caches = util.combine_named(({'name': c['name'], 'lower_level': drc['name']} for c in caches.values() if c.get('lower_level') == drc['lower_level']), caches.values())
+
     cores = list(util.combine_named(cores,
             ({'name': c['name'], '_branch_predictor_data': [branch_context.find(f) for f in util.wrap_list(c.get('branch_predictor',[]))]} for c in cores),
             ({'name': c['name'], '_btb_data': [btb_context.find(f) for f in util.wrap_list(c.get('btb',[]))]} for c in cores)
             ).values())
 
-    elements = {'cores': cores, 'caches': tuple(caches.values()), 'ptws': tuple(ptws.values()), 'pmem': pmem, 'vmem': vmem}
+    elements = {'cores': cores, 'caches': tuple(caches.values()), 'ptws': tuple(ptws.values()), 'pmem': pmem, 'vmem': vmem, 'dram_caches': tuple(dram_caches)}
     module_info = {
             'repl': util.combine_named(*(c['_replacement_data'] for c in caches.values()), replacement_context.find_all()),
             'pref': util.combine_named(*(c['_prefetcher_data'] for c in caches.values()), prefetcher_context.find_all()),
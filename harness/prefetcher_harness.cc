@@ -0,0 +1,140 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "access_log.h"
+#include "cache.h"
+#include "defaults.hpp"
+#include "prefetch_replay.h"
+#include <CLI/CLI.hpp>
+#include <fmt/core.h>
+
+namespace
+{
+// Modules are chosen by template parameter, so every prefetcher that was compiled gets its own instantiation to choose from by name
+template <std::size_t... I>
+std::unique_ptr<CACHE> make_cache(CACHE::Builder<CACHE::pprefetcherDno, CACHE::rreplacementDlru> builder, std::string_view name, std::index_sequence<I...>)
+{
+  std::unique_ptr<CACHE> retval;
+  ((name == CACHE::prefetcher_names[I].second ? void(retval = std::make_unique<CACHE>(builder.template prefetcher<CACHE::prefetcher_names[I].first>()))
+                                                : void()),
+   ...);
+  return retval;
+}
+
+std::unique_ptr<CACHE> make_cache(CACHE::Builder<CACHE::pprefetcherDno, CACHE::rreplacementDlru> builder, std::string_view name)
+{
+  return make_cache(builder, name, std::make_index_sequence<std::size(CACHE::prefetcher_names)>{});
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  CLI::App app{"Replays a recorded cache access log to prefetchers, without simulating timing"};
+
+  std::vector<std::string> prefetchers;
+  std::vector<std::string> parameter_strings;
+  uint32_t sets = 0;
+  uint32_t ways = 0;
+  uint64_t fill_latency = 0;
+  uint64_t warmup_accesses = 0;
+  std::string log_name;
+  bool list_prefetchers = false;
+
+  app.add_flag("--list", list_prefetchers, "List the prefetchers that may be replayed, then exit");
+  app.add_option("-p,--prefetcher", prefetchers, "A prefetcher to replay the log to. Each is replayed separately.");
+  app.add_option("--param", parameter_strings, "A prefetcher parameter, as name=value");
+  app.add_option("--sets", sets, "The number of sets in the cache. If not specified, the default for an LLC.");
+  app.add_option("--ways", ways, "The number of ways in the cache. If not specified, the default for an LLC.");
+  app.add_option("--fill-latency", fill_latency, "The number of accesses between a miss or prefetch and its fill. If not specified, fills are immediate.");
+  app.add_option("-w,--warmup-accesses", warmup_accesses, "The number of accesses before statistics are gathered");
+  app.add_option("log", log_name, "The access log to replay")->check(CLI::ExistingFile);
+
+  CLI11_PARSE(app, argc, argv);
+
+  if (list_prefetchers) {
+    for (const auto& module : CACHE::prefetcher_names)
+      fmt::print("{}\n", module.second);
+    return 0;
+  }
+
+  if (log_name.empty() || std::empty(prefetchers)) {
+    fmt::print(stderr, "A log and at least one prefetcher must be given\n");
+    return 1;
+  }
+
+  std::map<std::string, uint64_t> parameters;
+  for (const auto& parameter : parameter_strings) {
+    auto split = parameter.find('=');
+    if (split == std::string::npos) {
+      fmt::print(stderr, "Prefetcher parameter {} is not of the form name=value\n", parameter);
+      return 1;
+    }
+    parameters.insert_or_assign(parameter.substr(0, split), std::stoull(parameter.substr(split + 1), nullptr, 0));
+  }
+
+  // Read the whole log first, so that the replay rate is that of the prefetcher
+  std::vector<champsim::access_record> records;
+  champsim::access_log_reader reader{log_name};
+  for (auto record = reader.read(); record.has_value(); record = reader.read())
+    records.push_back(*record);
+
+  auto builder = champsim::defaults::default_llc;
+  builder.name("harness").prefetcher_parameters(parameters);
+  if (sets > 0)
+    builder.sets(sets);
+  if (ways > 0)
+    builder.ways(ways);
+
+  fmt::print("Replaying {} accesses from {}\n", std::size(records), log_name);
+
+  for (const auto& name : prefetchers) {
+    auto cache = make_cache(builder, name);
+    if (cache == nullptr) {
+      fmt::print(stderr, "No prefetcher named {}. Use --list to see the choices.\n", name);
+      return 1;
+    }
+
+    cache->initialize();
+    cache->begin_phase();
+    champsim::prefetch_replay replay{*cache, fill_latency};
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < std::size(records); ++i) {
+      cache->warmup = i < warmup_accesses;
+      if (i == warmup_accesses)
+        replay.begin_measurement();
+      replay.replay(records[i]);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const auto& stats = replay.get_stats();
+    fmt::print("\n{} ({} sets, {} ways)\n", name, cache->NUM_SET, cache->NUM_WAY);
+    fmt::print("  DEMAND ACCESS: {:10d} MISS: {:10d} RECORDED MISS: {:10d}\n", stats.demand_accesses, stats.demand_misses, stats.recorded_demand_misses);
+    fmt::print("  PREFETCH ISSUED: {:10d} USEFUL: {:10d} LATE: {:10d} USELESS: {:10d}\n", stats.pf_issued, stats.pf_useful, stats.pf_late, stats.pf_useless);
+    fmt::print("  ACCURACY: {:.4g} COVERAGE: {:.4g}\n", stats.accuracy(), stats.coverage());
+    fmt::print("  REPLAYED {} accesses in {:.3g} s ({:.4g} accesses/s)\n", std::size(records), elapsed.count(),
+               static_cast<double>(std::size(records)) / elapsed.count());
+  }
+
+  return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ACCESS_LOG_H
+#define ACCESS_LOG_H
+
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+
+#include "channel.h"
+
+namespace champsim
+{
+// An access that a cache showed to its prefetcher
+struct access_record {
+  uint64_t address = 0;
+  uint64_t ip = 0;
+  bool hit = false;
+  access_type type = access_type::LOAD;
+};
+
+/**
+ * Access logs are flat files of records, each of the address and ip in the byte order of the host, followed by one byte each for the hit and the type.
+ */
+constexpr std::size_t ACCESS_RECORD_SIZE = 2 * sizeof(uint64_t) + 2;
+
+class access_log_writer
+{
+  std::ofstream stream;
+
+public:
+  explicit access_log_writer(const std::string& file_name);
+  void write(const access_record& record);
+};
+
+class access_log_reader
+{
+  std::ifstream stream;
+
+public:
+  explicit access_log_reader(const std::string& file_name);
+
+  // Returns nothing at the end of the log
+  std::optional<access_record> read();
+};
+} // namespace champsim
+
+#endif
@@ -25,9 +25,13 @@
 #include <array>
 #include <bitset>
 #include <deque>
+#include <map>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_set>
 #include <vector>
 
 #include "champsim.h"
@@ -35,9 +39,38 @@
 #include "channel.h"
 #include "module_impl.h"
 #include "operable.h"
+#include "prefetch_arbiter.h"
+#include "prefetch_feedback.h"
+#include "prefetch_orchestrator.h"
 #include <type_traits>
 
 
+namespace champsim
+{
+class access_log_writer;
+
+// How long a prefetcher expects a line to be useful, which replacement policies may use to choose where to insert a prefetched line
+enum class insertion_priority { low, normal, high };
+} // namespace champsim
+
+struct prefetch_source_stats {
+  std::string name;
+  uint64_t requested = 0;
+  uint64_t issued = 0;
+  uint64_t duplicate = 0;
+  uint64_t dropped = 0;
+  uint64_t useful = 0;
+  uint64_t useless = 0;
+};
+
+// Counts intervals of cycles in power-of-two buckets. Bucket 0 counts zero, bucket i counts [2^(i-1), 2^i), and the last bucket also counts longer intervals.
+struct cycle_histogram {
+  constexpr static std::size_t NUM_BUCKETS = 24;
+  std::array<uint64_t, NUM_BUCKETS> buckets = {};
+
+  void record(uint64_t cycles);
+};
+
 struct cache_stats {
   std::string name;
   // prefetch stats
@@ -46,6 +79,17 @@ struct cache_stats {
   uint64_t pf_useful = 0;
   uint64_t pf_useless = 0;
   uint64_t pf_fill = 0;
+  uint64_t pf_late = 0;
+  uint64_t pf_pollution = 0;
+  uint64_t pf_throttled = 0;
+
+  // prefetch timeliness
+  cycle_histogram pf_lead_time{};       // from the fill of a prefetch to its first use
+  cycle_histogram pf_late_by{};         // from the first demand for a prefetch in flight to its fill
+  cycle_histogram pf_unused_lifetime{}; // from the fill of a prefetch to its eviction without use
+
+  // one entry per prefetcher composed on the cache
+  std::vector<prefetch_source_stats> pf_sources = {};
 
   std::array<std::array<uint64_t, NUM_CPUS>, champsim::to_underlying(access_type::NUM_TYPES)> hits = {};
   std::array<std::array<uint64_t, NUM_CPUS>, champsim::to_underlying(access_type::NUM_TYPES)> misses = {};
@@ -65,12 +109,6 @@ class CACHE : public champsim::operable
   using request_type = typename channel_type::request_type;
   using response_type = typename channel_type::response_type;
 
- uint64_t current_core_cycle[NUM_CPUS], 
-                stall_cycle[NUM_CPUS], 
-                last_drc_read_mode, 
-                last_drc_write_mode,
-                drc_blocks;
-
   struct tag_lookup_type {
     uint64_t address;
     uint64_t v_address;
@@ -80,6 +118,8 @@ class CACHE : public champsim::operable
 
     uint32_t pf_metadata;
     uint32_t cpu;
+    std::size_t pf_source = 0;
+    champsim::insertion_priority priority = champsim::insertion_priority::normal;
 
     access_type type;
     bool prefetch_from_this;
@@ -91,8 +131,8 @@ class CACHE : public champsim::operable
 
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
 
-    std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
-    std::vector<std::deque<response_type>*> to_return{};
+    channel_type::dependents_type instr_depend_on_me{};
+    channel_type::return_list_type to_return{};
 
     explicit tag_lookup_type(request_type req) : tag_lookup_type(req, false, false) {}
     tag_lookup_type(request_type req, bool local_pref, bool skip);
@@ -107,17 +147,23 @@ class CACHE : public champsim::operable
 
     uint32_t pf_metadata;
     uint32_t cpu;
+    std::size_t pf_source;
+    champsim::insertion_priority priority;
 
     access_type type;
     bool prefetch_from_this;
 
+    uint8_t miss_depth = 0;
+    bool served_by_memory = false;
+
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
 
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
     uint64_t cycle_enqueued;
+    uint64_t cycle_demanded = std::numeric_limits<uint64_t>::max(); // when a demand first found this prefetch in flight
 
-    std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
-    std::vector<std::deque<response_type>*> to_return{};
+    channel_type::dependents_type instr_depend_on_me{};
+    channel_type::return_list_type to_return{};
 
     mshr_type(tag_lookup_type req, uint64_t cycle);
     static mshr_type merge(mshr_type predecessor, mshr_type successor);
@@ -142,6 +188,9 @@ class CACHE : public champsim::operable
     uint64_t data = 0;
 
     uint32_t pf_metadata = 0;
+    std::size_t pf_source = 0;
+    champsim::insertion_priority priority = champsim::insertion_priority::normal;
+    uint64_t cycle_filled = 0;
 
     BLOCK() = default;
     explicit BLOCK(mshr_type mshr);
@@ -162,6 +211,26 @@ class CACHE : public champsim::operable
   std::deque<tag_lookup_type> inflight_tag_check{};
   std::deque<tag_lookup_type> translation_stash{};
 
+  champsim::prefetch_feedback pf_feedback{};
+  std::optional<champsim::prefetch_orchestrator> pf_orchestrator{};
+  // The writer is only complete in cache.cc, so that including this header does not include the file streams
+  struct access_log_deleter {
+    void operator()(champsim::access_log_writer* log) const;
+  };
+  std::unique_ptr<champsim::access_log_writer, access_log_deleter> access_log{};
+  void open_access_log(const std::string& file_name);
+  void record_demand_access(const tag_lookup_type& handle_pkt, bool hit);
+
+  // Prefetchers composed on this cache queue their candidates separately, then an arbiter moves them into internal_PQ
+  std::vector<std::string_view> prefetch_source_names{};
+  std::vector<std::deque<tag_lookup_type>> prefetch_candidates{};
+  std::unordered_set<uint64_t> pending_prefetch_blocks{}; // the blocks of every candidate and every prefetch in internal_PQ, while prefetchers are composed
+  std::optional<champsim::prefetch_arbiter> pf_arbiter{};
+
+  std::size_t prefetch_source_index() const;
+  std::vector<prefetch_source_stats> new_source_stats() const;
+  void arbitrate_prefetches();
+
 public:
   std::vector<channel_type*> upper_levels;
   channel_type* lower_level;
@@ -178,6 +247,11 @@ public:
   const bool prefetch_as_load;
   const bool match_offset_bits;
   const bool virtual_prefetch;
+  const bool prefetch_throttle;
+  const bool prefetch_bandit;
+  const std::map<std::string, uint64_t> prefetcher_parameters; // given to the prefetcher modules by the configuration
+  const unsigned long long prefetcher_flags;
+  unsigned long long active_prefetcher = 0; // the constant of the prefetcher module being called, set by the module discriminators
   bool ever_seen_data = false;
   const unsigned pref_activate_mask = (1 << champsim::to_underlying(access_type::LOAD)) | (1 << champsim::to_underlying(access_type::PREFETCH));
 
@@ -218,8 +292,16 @@ public:
   [[deprecated("Use get_set_index() instead.")]] uint64_t get_set(uint64_t address) const;
   [[deprecated("This function should not be used to access the blocks directly.")]] uint64_t get_way(uint64_t address, uint64_t set) const;
 
+  unsigned get_prefetch_aggressiveness() const;
+  uint64_t get_prefetcher_parameter(const std::string& name, uint64_t default_value) const;
+
   uint64_t invalidate_entry(uint64_t inval_addr);
-  int prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata);
+  int prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata,
+                    champsim::insertion_priority priority = champsim::insertion_priority::normal);
+  champsim::insertion_priority get_insertion_priority(uint32_t set, uint32_t way) const;
+
+  // Removes the prefetches waiting to be issued and returns their addresses, for tools that replay accesses to a prefetcher without simulating timing
+  std::vector<uint64_t> take_queued_prefetches();
 
   [[deprecated("Use CACHE::prefetch_line(pf_addr, fill_this_level, prefetch_metadata) instead.")]] int
   prefetch_line(uint64_t ip, uint64_t base_addr, uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata);
@@ -237,6 +319,8 @@ public:
     virtual void impl_prefetcher_cycle_operate() = 0;
     virtual void impl_prefetcher_final_stats() = 0;
     virtual void impl_prefetcher_branch_operate(uint64_t ip, uint8_t branch_type, uint64_t branch_target) = 0;
+    virtual void impl_prefetcher_aggressiveness_update(unsigned level) = 0;
+    virtual void impl_prefetcher_configuration_update(unsigned degree, unsigned distance) = 0;
 
     virtual void impl_initialize_replacement() = 0;
     virtual uint32_t impl_find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr,
@@ -257,6 +341,8 @@ public:
     void impl_prefetcher_cycle_operate();
     void impl_prefetcher_final_stats();
     void impl_prefetcher_branch_operate(uint64_t ip, uint8_t branch_type, uint64_t branch_target);
+    void impl_prefetcher_aggressiveness_update(unsigned level);
+    void impl_prefetcher_configuration_update(unsigned degree, unsigned distance);
 
     void impl_initialize_replacement();
     uint32_t impl_find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr,
@@ -283,6 +369,11 @@ public:
   {
     module_pimpl->impl_prefetcher_branch_operate(ip, branch_type, branch_target);
   }
+  void impl_prefetcher_aggressiveness_update(unsigned level) { module_pimpl->impl_prefetcher_aggressiveness_update(level); }
+  void impl_prefetcher_configuration_update(unsigned degree, unsigned distance)
+  {
+    module_pimpl->impl_prefetcher_configuration_update(degree, distance);
+  }
 
   void impl_initialize_replacement() { module_pimpl->impl_initialize_replacement(); }
   uint32_t impl_find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type)
@@ -319,6 +410,11 @@ public:
     bool m_pref_load{};
     bool m_wq_full_addr{};
     bool m_va_pref{};
+    bool m_pf_throttle{};
+    bool m_pf_bandit{};
+    std::map<std::string, uint64_t> m_pref_params{};
+    std::string m_access_log{};
+    champsim::prefetch_arbiter::policy m_pf_arbitration{champsim::prefetch_arbiter::policy::priority};
 
     unsigned m_pref_act_mask{};
     std::vector<CACHE::channel_type*> m_uls{};
@@ -332,7 +428,9 @@ public:
         : m_name(other.m_name), m_freq_scale(other.m_freq_scale), m_sets(other.m_sets), m_ways(other.m_ways), m_pq_size(other.m_pq_size),
           m_mshr_size(other.m_mshr_size), m_hit_lat(other.m_hit_lat), m_fill_lat(other.m_fill_lat), m_latency(other.m_latency), m_max_tag(other.m_max_tag),
           m_max_fill(other.m_max_fill), m_offset_bits(other.m_offset_bits), m_pref_load(other.m_pref_load), m_wq_full_addr(other.m_wq_full_addr),
-          m_va_pref(other.m_va_pref), m_pref_act_mask(other.m_pref_act_mask), m_uls(other.m_uls), m_ll(other.m_ll), m_lt(other.m_lt)
+          m_va_pref(other.m_va_pref), m_pf_throttle(other.m_pf_throttle), m_pf_bandit(other.m_pf_bandit), m_pref_params(other.m_pref_params),
+          m_access_log(other.m_access_log), m_pf_arbitration(other.m_pf_arbitration), m_pref_act_mask(other.m_pref_act_mask), m_uls(other.m_uls), m_ll(other.m_ll),
+          m_lt(other.m_lt)
     {
     }
 
@@ -429,6 +527,41 @@ public:
       m_va_pref = false;
       return *this;
     }
+    self_type& set_prefetch_throttle()
+    {
+      m_pf_throttle = true;
+      return *this;
+    }
+    self_type& reset_prefetch_throttle()
+    {
+      m_pf_throttle = false;
+      return *this;
+    }
+    self_type& set_prefetch_bandit()
+    {
+      m_pf_bandit = true;
+      return *this;
+    }
+    self_type& reset_prefetch_bandit()
+    {
+      m_pf_bandit = false;
+      return *this;
+    }
+    self_type& prefetcher_parameters(std::map<std::string, uint64_t> pref_params_)
+    {
+      m_pref_params = std::move(pref_params_);
+      return *this;
+    }
+    self_type& access_log(std::string access_log_)
+    {
+      m_access_log = std::move(access_log_);
+      return *this;
+    }
+    self_type& prefetch_arbitration(champsim::prefetch_arbiter::policy arbitration_)
+    {
+      m_pf_arbitration = arbitration_;
+      return *this;
+    }
     template <typename... Elems>
     self_type& prefetch_activate(Elems... pref_act_elems)
     {
@@ -467,9 +600,31 @@ public:
       : champsim::operable(b.m_freq_scale), upper_levels(std::move(b.m_uls)), lower_level(b.m_ll), lower_translate(b.m_lt), NAME(b.m_name), NUM_SET(b.m_sets),
         NUM_WAY(b.m_ways), MSHR_SIZE(b.m_mshr_size), PQ_SIZE(b.m_pq_size), HIT_LATENCY((b.m_hit_lat > 0) ? b.m_hit_lat : b.m_latency - b.m_fill_lat),
         FILL_LATENCY(b.m_fill_lat), OFFSET_BITS(b.m_offset_bits), MAX_TAG(b.m_max_tag), MAX_FILL(b.m_max_fill), prefetch_as_load(b.m_pref_load),
-        match_offset_bits(b.m_wq_full_addr), virtual_prefetch(b.m_va_pref), pref_activate_mask(b.m_pref_act_mask),
+        match_offset_bits(b.m_wq_full_addr), virtual_prefetch(b.m_va_pref), prefetch_throttle(b.m_pf_throttle),
+        prefetch_bandit(b.m_pf_bandit), prefetcher_parameters(std::move(b.m_pref_params)), prefetcher_flags(P_FLAG),
+        active_prefetcher(P_FLAG & (~P_FLAG + 1)), pref_activate_mask(b.m_pref_act_mask),
         module_pimpl(std::make_unique<module_model<P_FLAG, R_FLAG>>(this))
   {
+    for (auto [flag, name] : prefetcher_names) {
+      if ((P_FLAG & flag) != 0)
+        prefetch_source_names.push_back(name);
+    }
+    if (std::empty(prefetch_source_names))
+      prefetch_source_names.push_back("");
+
+    if (std::size(prefetch_source_names) > 1) {
+      prefetch_candidates.resize(std::size(prefetch_source_names));
+      pf_arbiter.emplace(b.m_pf_arbitration, std::size(prefetch_source_names));
+    }
+
+    if (prefetch_bandit)
+      pf_orchestrator.emplace();
+
+    if (!std::empty(b.m_access_log))
+      open_access_log(b.m_access_log);
+
+    sim_stats.pf_sources = new_source_stats();
+    roi_stats.pf_sources = new_source_stats();
   }
 };
 
@@ -26,6 +26,10 @@
 
 #include <string_view>
 
+#include "util/block_index.h"
+#include "util/ring_buffer.h"
+#include "util/small_vector.h"
+
 struct ooo_model_instr;
 
 enum class access_type : unsigned {
@@ -62,6 +66,11 @@ struct cache_queue_stats {
 
 class channel
 {
+public:
+  // Packets rarely carry more than a few dependents, so these lists are stored inline
+  using dependents_type = small_vector<std::reference_wrapper<ooo_model_instr>, 4>;
+
+private:
   struct request {
     bool forward_checked = false;
     bool is_translated = true;
@@ -79,17 +88,23 @@ class channel
     uint64_t instr_id = 0;
     uint64_t ip = 0;
 
-    std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
+    dependents_type instr_depend_on_me{};
   };
 
   struct response {
-    uint64_t address;
-    uint64_t v_address;
-    uint64_t data;
+    uint64_t address = 0;
+    uint64_t v_address = 0;
+    uint64_t data = 0;
     uint32_t pf_metadata = 0;
-    std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
 
-    response(uint64_t addr, uint64_t v_addr, uint64_t data_, uint32_t pf_meta, std::vector<std::reference_wrapper<ooo_model_instr>> deps)
+    // The number of caches that missed before the request was served, and whether it was served by memory
+    uint8_t miss_depth = 0;
+    bool served_by_memory = false;
+
+    dependents_type instr_depend_on_me{};
+
+    response() = default;
+    response(uint64_t addr, uint64_t v_addr, uint64_t data_, uint32_t pf_meta, dependents_type deps)
         : address(addr), v_address(v_addr), data(data_), pf_metadata(pf_meta), instr_depend_on_me(deps)
     {
     }
@@ -109,9 +124,12 @@ public:
   using response_type = response;
   using request_type = request;
   using stats_type = cache_queue_stats;
+  using queue_type = block_indexed_queue<request_type>;
+  using response_queue_type = ring_buffer<response_type>;
+  using return_list_type = small_vector<response_queue_type*, 4>;
 
-  std::deque<request_type> RQ{}, PQ{}, WQ{};
-  std::deque<response_type> returned{};
+  queue_type RQ{}, PQ{}, WQ{};
+  response_queue_type returned{};
 
   stats_type sim_stats{}, roi_stats{};
 
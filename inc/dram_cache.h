@@ -0,0 +1,249 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRAM_CACHE_H
+#define DRAM_CACHE_H
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "champsim_constants.h"
+#include "channel.h"
+#include "operable.h"
+#include "util/bits.h"
+
+struct dram_cache_stats {
+  std::string name{};
+
+  std::array<uint64_t, champsim::to_underlying(access_type::NUM_TYPES)> hits = {};
+  std::array<uint64_t, champsim::to_underlying(access_type::NUM_TYPES)> misses = {};
+
+  uint64_t ROW_BUFFER_HIT = 0, ROW_BUFFER_MISS = 0;
+
+  // Outcomes of the miss predictor. A late miss was predicted to hit, and a wasted fetch was predicted to miss.
+  uint64_t predictor_correct = 0, predictor_late_miss = 0, predictor_wasted_fetch = 0;
+
+  uint64_t writebacks = 0;
+  uint64_t total_miss_latency = 0;
+};
+
+/*
+ * A direct-mapped DRAM cache with its tags stored alongside the data, in the style of the Alloy cache.
+ * Each set holds one tag-and-data unit (TAD) that is read from the stacked DRAM in a single burst, so a lookup costs one DRAM access.
+ * A miss predictor indexed by the instruction pointer sends predicted misses to memory in parallel with the lookup.
+ */
+class DRAM_CACHE : public champsim::operable
+{
+  using channel_type = champsim::channel;
+  using request_type = typename channel_type::request_type;
+  using response_type = typename channel_type::response_type;
+
+  struct BLOCK {
+    bool valid = false;
+    bool dirty = false;
+    uint64_t address = 0;
+  };
+
+  struct bank_type {
+    uint64_t open_row = std::numeric_limits<uint64_t>::max();
+    uint64_t ready_cycle = 0;
+  };
+
+  struct mshr_type {
+    uint64_t address = 0;
+    uint64_t v_address = 0;
+    uint64_t data = 0;
+    uint64_t ip = 0;
+
+    uint32_t pf_metadata = 0;
+    uint32_t cpu = std::numeric_limits<uint32_t>::max();
+
+    access_type type{access_type::LOAD};
+
+    bool predicted_miss = false;
+    bool lookup_done = false;
+    bool hit = false;
+    bool memory_issued = false;
+    bool memory_returned = false;
+
+    uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
+    uint64_t cycle_enqueued = 0;
+
+    channel_type::dependents_type instr_depend_on_me{};
+    channel_type::return_list_type to_return{};
+
+    mshr_type(const request_type& req, uint64_t cycle);
+  };
+
+  std::vector<BLOCK> block;
+  std::vector<bank_type> banks;
+  std::vector<uint64_t> bus_ready_cycle;
+  std::vector<uint8_t> miss_predictor;
+
+  std::deque<mshr_type> MSHR;
+  std::deque<request_type> writebacks;
+
+  bool handle_read(const request_type& pkt, channel_type* ul);
+  bool handle_write(const request_type& pkt);
+  void finish_lookup(mshr_type& mshr_entry);
+  void finish_packet(const response_type& packet);
+  bool issue_read(mshr_type& mshr_entry);
+  void fill(const mshr_type& mshr_entry);
+  void evict(std::size_t set);
+  void respond(const mshr_type& mshr_entry);
+
+  uint64_t schedule_access(std::size_t set);
+  std::size_t predictor_index(uint64_t ip, uint32_t cpu) const;
+
+  // The miss predictor holds 3-bit saturating counters, and predicts a miss in the upper half of their range
+  static constexpr uint8_t PREDICTOR_MAX = 7;
+  static constexpr uint8_t PREDICTOR_THRESHOLD = 4;
+
+public:
+  std::vector<channel_type*> upper_levels;
+  channel_type* lower_level;
+
+  const std::string NAME;
+  const uint32_t NUM_SET, MSHR_SIZE;
+  const long int MAX_TAG, MAX_FILL;
+  const std::size_t CHANNELS, BANKS, TADS_PER_ROW;
+  const uint64_t tRP, tRCD, tCAS, BURST_CYCLES;
+
+  // A TAD holds one block and its tag
+  static constexpr std::size_t TAD_SIZE = BLOCK_SIZE + 8;
+
+  using stats_type = dram_cache_stats;
+  stats_type sim_stats, roi_stats;
+
+  class Builder
+  {
+    std::string_view m_name{};
+    double m_freq_scale{1};
+    int m_io_freq{1};
+    uint32_t m_sets{1};
+    uint32_t m_mshr_size{1};
+    uint32_t m_max_tag_check{1};
+    uint32_t m_max_fill{1};
+    std::size_t m_channels{1};
+    std::size_t m_banks{1};
+    std::size_t m_row_size{2048};
+    std::size_t m_channel_width{16};
+    double m_t_rp{}, m_t_rcd{}, m_t_cas{};
+    std::size_t m_predictor_size{0};
+    std::vector<DRAM_CACHE::channel_type*> m_uls{};
+    DRAM_CACHE::channel_type* m_ll{};
+
+    friend class DRAM_CACHE;
+
+  public:
+    Builder& name(std::string_view name_)
+    {
+      m_name = name_;
+      return *this;
+    }
+    Builder& frequency(double freq_scale_)
+    {
+      m_freq_scale = freq_scale_;
+      return *this;
+    }
+    Builder& io_frequency(int io_freq_)
+    {
+      m_io_freq = io_freq_;
+      return *this;
+    }
+    Builder& sets(uint32_t sets_)
+    {
+      m_sets = sets_;
+      return *this;
+    }
+    Builder& mshr_size(uint32_t mshr_size_)
+    {
+      m_mshr_size = mshr_size_;
+      return *this;
+    }
+    Builder& tag_bandwidth(uint32_t max_read_)
+    {
+      m_max_tag_check = max_read_;
+      return *this;
+    }
+    Builder& fill_bandwidth(uint32_t max_fill_)
+    {
+      m_max_fill = max_fill_;
+      return *this;
+    }
+    Builder& channels(std::size_t channels_)
+    {
+      m_channels = channels_;
+      return *this;
+    }
+    Builder& banks(std::size_t banks_)
+    {
+      m_banks = banks_;
+      return *this;
+    }
+    Builder& row_size(std::size_t row_size_)
+    {
+      m_row_size = row_size_;
+      return *this;
+    }
+    Builder& channel_width(std::size_t channel_width_)
+    {
+      m_channel_width = channel_width_;
+      return *this;
+    }
+    Builder& timing(double t_rp_, double t_rcd_, double t_cas_)
+    {
+      m_t_rp = t_rp_;
+      m_t_rcd = t_rcd_;
+      m_t_cas = t_cas_;
+      return *this;
+    }
+    Builder& miss_predictor_size(std::size_t predictor_size_)
+    {
+      m_predictor_size = predictor_size_;
+      return *this;
+    }
+    Builder& upper_levels(std::vector<DRAM_CACHE::channel_type*>&& uls_)
+    {
+      m_uls = std::move(uls_);
+      return *this;
+    }
+    Builder& lower_level(DRAM_CACHE::channel_type* ll_)
+    {
+      m_ll = ll_;
+      return *this;
+    }
+  };
+
+  explicit DRAM_CACHE(Builder builder);
+
+  long operate() override final;
+
+  void initialize() override final;
+  void begin_phase() override final;
+  void end_phase(unsigned cpu) override final;
+  void print_deadlock() override final;
+
+  std::size_t get_set_index(uint64_t address) const;
+  bool predict_miss(uint64_t ip, uint32_t cpu) const;
+};
+
+#endif
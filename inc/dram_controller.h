@@ -19,13 +19,20 @@
 
 #include <array>
 #include <cmath>
+#include <deque>
 #include <limits>
+#include <list>
 #include <optional>
 #include <string>
+#include <unordered_map>
 
 #include "champsim_constants.h"
 #include "channel.h"
 #include "operable.h"
+#include "util/block_index.h"
+
+// Convert a time in microseconds to a whole number of cycles at the given I/O frequency in MT/s, rounding up
+uint64_t cycles(double time, int io_freq);
 
 struct dram_stats {
   std::string name{};
@@ -34,6 +41,11 @@ struct dram_stats {
   unsigned WQ_ROW_BUFFER_HIT = 0, WQ_ROW_BUFFER_MISS = 0, RQ_ROW_BUFFER_HIT = 0, RQ_ROW_BUFFER_MISS = 0, WQ_FULL = 0;
 };
 
+struct far_memory_stats {
+  std::string name{};
+  uint64_t reads = 0, writes = 0, link_full = 0, total_read_latency = 0, promotions = 0, demotions = 0;
+};
+
 struct DRAM_CHANNEL {
   using response_type = typename champsim::channel::response_type;
   struct request_type {
@@ -49,8 +61,8 @@ struct DRAM_CHANNEL {
     uint64_t data = 0;
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
 
-    std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
-    std::vector<std::deque<response_type>*> to_return{};
+    champsim::channel::dependents_type instr_depend_on_me{};
+    champsim::channel::return_list_type to_return{};
 
     explicit request_type(typename champsim::channel::request_type);
   };
@@ -58,6 +70,9 @@ struct DRAM_CHANNEL {
   using queue_type = std::vector<std::optional<value_type>>;
   queue_type WQ{DRAM_WQ_SIZE}, RQ{DRAM_RQ_SIZE};
 
+  // Block address indices over the occupied slots of each queue. Slots must be filled and released through insert() and release().
+  champsim::block_index wq_index{LOG2_BLOCK_SIZE}, rq_index{LOG2_BLOCK_SIZE};
+
   struct BANK_REQUEST {
     bool valid = false, row_buffer_hit = false;
 
@@ -78,10 +93,63 @@ struct DRAM_CHANNEL {
   using stats_type = dram_stats;
   stats_type roi_stats, sim_stats;
 
+  queue_type::iterator insert(queue_type& queue, request_type packet);
+  void release(queue_type::iterator slot);
+
   void check_collision();
   void print_deadlock();
 };
 
+/*
+ * A memory tier attached over a serial link, such as CXL-attached memory.
+ * Requests wait in the link queue for the link, cross it, and are serviced by the device with a fixed latency.
+ * Pages that are accessed often enough may be promoted to the near tier, which costs a page transfer on the link.
+ */
+struct FAR_MEMORY {
+  using response_type = typename champsim::channel::response_type;
+  struct request_type {
+    bool is_write = false;
+
+    uint32_t pf_metadata = 0;
+
+    uint64_t address = 0;
+    uint64_t v_address = 0;
+    uint64_t data = 0;
+    uint64_t cycle_enqueued = 0;
+    uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
+
+    champsim::channel::dependents_type instr_depend_on_me{};
+    champsim::channel::return_list_type to_return{};
+  };
+
+  // A zero-sized link queue disables the tier
+  std::size_t LINK_QUEUE_SIZE = 0;
+  uint64_t LINK_LATENCY = 0, DEVICE_LATENCY = 0, TRANSFER_CYCLES = 1;
+  unsigned MIGRATION_THRESHOLD = 0;
+  std::size_t MIGRATION_PAGES = 0;
+
+  std::deque<request_type> link_queue{}, inflight{};
+  uint64_t link_cycle_available = 0;
+  uint64_t migration_cycles = 0;
+
+  std::unordered_map<uint64_t, unsigned> page_accesses{};
+  std::list<uint64_t> promoted_lru{};
+  std::unordered_map<uint64_t, std::list<uint64_t>::iterator> promoted_pages{};
+
+  using stats_type = far_memory_stats;
+  stats_type roi_stats, sim_stats;
+
+  FAR_MEMORY() = default;
+  FAR_MEMORY(int io_freq, std::size_t link_queue_size, double link_latency, double device_latency, double transfer_time, unsigned migration_threshold,
+             std::size_t migration_pages);
+
+  bool enabled() const;
+  bool is_promoted(uint64_t address);
+  bool add(request_type packet, uint64_t current_cycle);
+  long operate(uint64_t current_cycle, bool warmup);
+  void print_deadlock();
+};
+
 class MEMORY_CONTROLLER : public champsim::operable
 {
   using channel_type = champsim::channel;
@@ -103,8 +171,10 @@ class MEMORY_CONTROLLER : public champsim::operable
 
 public:
   std::array<DRAM_CHANNEL, DRAM_CHANNELS> channels;
+  FAR_MEMORY far_memory;
 
-  MEMORY_CONTROLLER(double freq_scale, int io_freq, double t_rp, double t_rcd, double t_cas, double turnaround, std::vector<channel_type*>&& ul);
+  MEMORY_CONTROLLER(double freq_scale, int io_freq, double t_rp, double t_rcd, double t_cas, double turnaround, std::vector<channel_type*>&& ul,
+                    FAR_MEMORY far = {});
 
   void initialize() override final;
   long operate() override final;
@@ -113,6 +183,7 @@ public:
   void print_deadlock() override final;
 
   std::size_t size() const;
+  bool is_far(uint64_t address);
 
   uint32_t dram_get_channel(uint64_t address);
   uint32_t dram_get_rank(uint64_t address);
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "cache.h"
+#include "dram_cache.h"
 #include "dram_controller.h"
 #include "ooo_cpu.h"
 #include "operable.h"
@@ -33,6 +34,7 @@ struct environment {
   virtual std::vector<std::reference_wrapper<CACHE>> cache_view() = 0;
   virtual std::vector<std::reference_wrapper<PageTableWalker>> ptw_view() = 0;
   virtual MEMORY_CONTROLLER& dram_view() = 0;
+  virtual std::vector<std::reference_wrapper<DRAM_CACHE>> dram_cache_view() { return {}; }
   virtual std::vector<std::reference_wrapper<operable>> operable_view() = 0;
 };
 } // namespace champsim
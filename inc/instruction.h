@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "trace_instruction.h"
+#include "util/inline_vector.h"
 
 // branch types
 enum branch_type {
@@ -49,6 +50,7 @@ struct ooo_model_instr {
   bool branch_mispredicted = 0; // A branch can be mispredicted even if the direction prediction is correct when the predicted target is not correct
 
   std::array<uint8_t, 2> asid = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
+  uint8_t thread_id = 0;
 
   uint8_t branch_type = NOT_BRANCH;
   uint64_t branch_target = 0;
@@ -58,18 +60,25 @@ struct ooo_model_instr {
   uint8_t decoded = 0;
   uint8_t scheduled = 0;
   uint8_t executed = 0;
+  bool retired = false; // retired, but younger than an unretired instruction of another thread
 
   unsigned completed_mem_ops = 0;
   int num_reg_dependent = 0;
 
-  std::vector<uint8_t> destination_registers = {}; // output registers
-  std::vector<uint8_t> source_registers = {};      // input registers
+  // the deepest level of the memory hierarchy that served one of this instruction's loads
+  uint8_t miss_depth = 0;
+  bool served_by_memory = false;
 
-  std::vector<uint64_t> destination_memory = {};
-  std::vector<uint64_t> source_memory = {};
+  // Operands are held inline, bounded by the widest trace format, so that instructions do not allocate as they move through the pipeline
+  champsim::inline_vector<uint8_t, NUM_INSTR_DESTINATIONS_SPARC> destination_registers = {}; // output registers
+  champsim::inline_vector<uint8_t, NUM_INSTR_SOURCES> source_registers = {};                 // input registers
 
-  // these are indices of instructions in the ROB that depend on me
-  std::vector<std::reference_wrapper<ooo_model_instr>> registers_instrs_depend_on_me;
+  champsim::inline_vector<uint64_t, NUM_INSTR_DESTINATIONS_SPARC> destination_memory = {};
+  champsim::inline_vector<uint64_t, NUM_INSTR_SOURCES> source_memory = {};
+
+  // the physical registers this instruction writes, and the ones that held its destinations before it, which are freed when it retires
+  champsim::inline_vector<uint32_t, NUM_INSTR_DESTINATIONS_SPARC> destination_physical_registers = {};
+  champsim::inline_vector<uint32_t, NUM_INSTR_DESTINATIONS_SPARC> previous_physical_registers = {};
 
 private:
   template <typename T>
@@ -131,6 +140,7 @@ private:
   }
 
 public:
+  ooo_model_instr() = default;
   ooo_model_instr(uint8_t cpu, input_instr instr) : ooo_model_instr(instr, {cpu, cpu}) {}
   ooo_model_instr(uint8_t, cloudsuite_instr instr) : ooo_model_instr(instr, {instr.asid[0], instr.asid[1]}) {}
 
@@ -30,6 +30,7 @@
 #include <optional>
 #include <queue>
 #include <stdexcept>
+#include <unordered_map>
 #include <vector>
 
 #include "champsim.h"
@@ -38,7 +39,12 @@
 #include "instruction.h"
 #include "module_impl.h"
 #include "operable.h"
+#include "util/bits.h"
+#include "util/block_index.h"
 #include "util/lru_table.h"
+#include "util/small_vector.h"
+#include "util/staged_ring.h"
+#include "util/timing_wheel.h"
 #include <type_traits>
 
 enum STATUS { INFLIGHT = 1, COMPLETED = 2 };
@@ -59,17 +65,53 @@ public:
   CacheBus(uint32_t cpu_idx, champsim::channel* ll) : lower_level(ll), cpu(cpu_idx) {}
   bool issue_read(request_type packet);
   bool issue_write(request_type packet);
+  bool issue_prefetch(request_type packet);
 };
 
+/*
+ * Each cycle is attributed to one component of the CPI stack. A cycle that retires nothing is charged to whatever blocks the head of the ROB.
+ * Cycles spent waiting on a load are charged when the load returns, to the level that served it. Caches below the second level count as the LLC.
+ */
+enum class cpi_component : unsigned {
+  RETIRING = 0,
+  FRONTEND,
+  BRANCH_RECOVERY,
+  LOAD_L1D,
+  LOAD_L2C,
+  LOAD_LLC,
+  LOAD_DRAM,
+  LSQ_FULL,
+  MEMORY_QUEUE_FULL,
+  EXECUTION,
+  NUM_COMPONENTS,
+};
+
+inline constexpr std::array<std::string_view, champsim::to_underlying(cpi_component::NUM_COMPONENTS)> cpi_component_names{
+    "RETIRING"sv, "FRONTEND"sv, "BRANCH_RECOVERY"sv, "LOAD_L1D"sv, "LOAD_L2C"sv, "LOAD_LLC"sv, "LOAD_DRAM"sv, "LSQ_FULL"sv, "MEMORY_QUEUE_FULL"sv, "EXECUTION"sv};
+
 struct cpu_stats {
   std::string name;
   uint64_t begin_instrs = 0, begin_cycles = 0;
   uint64_t end_instrs = 0, end_cycles = 0;
   uint64_t total_rob_occupancy_at_branch_mispredict = 0;
 
+  uint64_t total_ftq_occupancy = 0;
+  uint64_t ftq_prefetches = 0;
+  uint64_t frontend_stall_cycles = 0;
+
+  std::array<uint64_t, champsim::to_underlying(cpi_component::NUM_COMPONENTS)> cpi_stack = {};
+
   std::array<long long, 8> total_branch_types = {};
   std::array<long long, 8> branch_type_misses = {};
 
+  struct thread_stats {
+    uint64_t begin_instrs = 0, end_instrs = 0;
+    uint64_t branch_mispredicts = 0;
+
+    uint64_t instrs() const { return end_instrs - begin_instrs; }
+  };
+  std::vector<thread_stats> threads{};
+
   uint64_t instrs() const { return end_instrs - begin_instrs; }
   uint64_t cycles() const { return end_cycles - begin_cycles; }
 };
@@ -81,19 +123,37 @@ struct LSQ_ENTRY {
   uint64_t event_cycle = 0;
 
   std::array<uint8_t, 2> asid = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
+  uint8_t thread_id = 0;
   bool fetch_issued = false;
 
   uint64_t producer_id = std::numeric_limits<uint64_t>::max();
   std::vector<std::reference_wrapper<std::optional<LSQ_ENTRY>>> lq_depend_on_me{};
 
-  LSQ_ENTRY(uint64_t id, uint64_t addr, uint64_t ip, std::array<uint8_t, 2> asid);
-  void finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const;
+  LSQ_ENTRY(uint64_t id, uint64_t addr, uint64_t ip, std::array<uint8_t, 2> asid, uint8_t thread = 0);
+  using rob_iterator = champsim::ring_buffer<ooo_model_instr>::iterator;
+  rob_iterator finish(rob_iterator begin, rob_iterator end) const;
 };
 
 // cpu
 class O3_CPU : public champsim::operable
 {
 public:
+  /*
+   * The out-of-order model runs every instruction through the full pipeline.
+   * The load issuer skips the frontend and the register scheduler. It admits instructions from the trace directly into a window of at most
+   * MLP_WINDOW instructions, ISSUE_WIDTH per cycle, and retires them in order once their memory operations finish. If DEPENDENT_LOADS is set,
+   * an instruction that accesses memory is not admitted until every instruction in the window has finished, as if each load's address came from
+   * the previous load.
+   */
+  enum class model_type { out_of_order, load_issuer };
+
+  /*
+   * A core may run several hardware threads, each reading its own trace. Fetch picks one thread each cycle. Round-robin takes turns among the
+   * threads that can fetch, and ICOUNT picks the one with the fewest instructions in flight.
+   * The threads share the ROB, LQ, and SQ. If the queues are partitioned, each thread may hold at most an equal share of each.
+   */
+  enum class fetch_policy_type { round_robin, icount };
+
   uint32_t cpu = 0;
 
   // cycle
@@ -122,30 +182,105 @@ public:
   using dib_type = champsim::lru_table<uint64_t, dib_shift, dib_shift>;
   dib_type DIB;
 
+  // Every in-flight instruction is held in one ring, oldest first, divided into the stages below. Instructions do not move as they advance,
+  // so references to them stay valid from the time they are predicted until they retire. This holds because the ring is reserved for the bounds
+  // of all stages, so it never grows, and because instructions only enter the youngest stage in use, so no younger stage is ever moved.
+  // The stage views point into the ring, so an O3_CPU may be neither copied nor moved.
+  using instr_window_type = champsim::staged_ring<ooo_model_instr, 5>;
+  instr_window_type instr_window{};
+
   // reorder buffer, load/store queue, register file
-  std::deque<ooo_model_instr> IFETCH_BUFFER;
-  std::deque<ooo_model_instr> DISPATCH_BUFFER;
-  std::deque<ooo_model_instr> DECODE_BUFFER;
-  std::deque<ooo_model_instr> ROB;
+  instr_window_type::stage_type ROB = instr_window.stage(0);
+  instr_window_type::stage_type DISPATCH_BUFFER = instr_window.stage(1);
+  instr_window_type::stage_type DECODE_BUFFER = instr_window.stage(2);
+  instr_window_type::stage_type IFETCH_BUFFER = instr_window.stage(3);
+  instr_window_type::stage_type FTQ = instr_window.stage(4);
 
   std::vector<std::optional<LSQ_ENTRY>> LQ;
   std::deque<LSQ_ENTRY> SQ;
 
-  std::array<std::vector<std::reference_wrapper<ooo_model_instr>>, std::numeric_limits<uint8_t>::max() + 1> reg_producers;
+  // Indices over the load and store queues, so that memory operations are matched without scanning the queues.
+  // Free LQ slots are allocated lowest first, and loads that may issue are kept in slot order.
+  // Stores are indexed by their sequence number, where SQ.front() has sequence number sq_base_seq.
+  std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<std::size_t>> lq_free_slots;
+  std::vector<std::size_t> lq_unissued;
+  std::unordered_multimap<uint64_t, std::size_t> lq_instr_index;
+  champsim::block_index lq_block_index{LOG2_BLOCK_SIZE};
+  champsim::block_index sq_address_index{};
+  uint64_t sq_base_seq = 0;
+
+  // Register renaming. Each architectural register is mapped to the physical register that will hold its latest value, or to NO_REGISTER if its
+  // value is not held in the physical register file. Instructions waiting on a physical register are woken when its producer completes.
+  struct physical_register {
+    bool ready = true;
+    champsim::small_vector<std::reference_wrapper<ooo_model_instr>, 4> consumers{};
+  };
+  static constexpr uint32_t NO_REGISTER = std::numeric_limits<uint32_t>::max();
+  using register_alias_table_type = std::array<uint32_t, std::numeric_limits<uint8_t>::max() + 1>;
+  std::vector<physical_register> physical_register_file;
+  std::vector<uint32_t> free_physical_registers;
+
+  // Instructions are tracked by the state they wait on, so that each stage only visits the instructions it can act on.
+  // Instructions at ROB positions below schedule_index have been scheduled, and scheduler_occupancy of them have not begun execution.
+  // The ready queue and the completion queue are kept in program order.
+  std::size_t schedule_index = 0;
+  long scheduler_occupancy = 0;
+  std::vector<std::reference_wrapper<ooo_model_instr>> ready_queue;
+  champsim::timing_wheel<std::reference_wrapper<ooo_model_instr>> execution_wheel;
+  std::vector<std::reference_wrapper<ooo_model_instr>> completion_queue;
 
   // Constants
-  const std::size_t IFETCH_BUFFER_SIZE, DISPATCH_BUFFER_SIZE, DECODE_BUFFER_SIZE, ROB_SIZE, SQ_SIZE;
+  const std::size_t FTQ_SIZE, IFETCH_BUFFER_SIZE, DISPATCH_BUFFER_SIZE, DECODE_BUFFER_SIZE, ROB_SIZE, SQ_SIZE;
   const long int FETCH_WIDTH, DECODE_WIDTH, DISPATCH_WIDTH, SCHEDULER_SIZE, EXEC_WIDTH;
   const long int LQ_WIDTH, SQ_WIDTH;
   const long int RETIRE_WIDTH;
   const unsigned BRANCH_MISPREDICT_PENALTY, DISPATCH_LATENCY, DECODE_LATENCY, SCHEDULING_LATENCY, EXEC_LATENCY;
   const long int L1I_BANDWIDTH, L1D_BANDWIDTH;
 
+  const model_type MODEL;
+  const std::size_t MLP_WINDOW;
+  const long int ISSUE_WIDTH;
+  const bool DEPENDENT_LOADS;
+
+  const std::size_t NUM_THREADS;
+  const fetch_policy_type FETCH_POLICY;
+  const bool PARTITIONED_QUEUES;
+
+  // The state each hardware thread keeps for itself. Everything else in the core is shared.
+  // A thread's oldest unretired instruction is found at retirement. Its stores older than that may leave the SQ.
+  struct thread_context {
+    std::deque<ooo_model_instr> input_queue{};
+    register_alias_table_type register_alias_table{};
+    uint64_t fetch_resume_cycle = 0;
+
+    uint64_t num_retired = 0;
+    uint64_t begin_phase_instr = 0;
+    uint64_t oldest_unretired = std::numeric_limits<uint64_t>::max();
+    bool retire_blocked = false;
+
+    std::size_t in_flight = 0;
+    std::size_t rob_occupancy = 0, lq_occupancy = 0, sq_occupancy = 0;
+  };
+  std::vector<thread_context> threads;
+  std::size_t last_fetch_thread = 0;
+
+  // Instructions from every thread share one window, so the core numbers them in the order they enter it
+  uint64_t next_instr_id = 0;
+
   // branch
-  uint64_t fetch_resume_cycle = 0;
+  uint64_t last_prefetched_block = std::numeric_limits<uint64_t>::max();
+
+  // cycle accounting
+  uint64_t pending_load_stall_cycles = 0;
+  bool memory_queue_rejected = false;
+
+  // A core whose stages all stalled, and none because a lower level turned a request away, is quiescent. It only accounts for its cycles
+  // until wake_cycle, a memory return, or new input from the trace.
+  uint64_t wake_cycle = 0;
+  std::size_t quiescent_input_size = 0;
+  bool issue_rejected = false;
 
-  const long IN_QUEUE_SIZE = 2 * FETCH_WIDTH;
-  std::deque<ooo_model_instr> input_queue;
+  const long IN_QUEUE_SIZE = 2 * (MODEL == model_type::load_issuer ? ISSUE_WIDTH : FETCH_WIDTH);
 
   CacheBus L1I_bus, L1D_bus;
   CACHE* l1i;
@@ -155,7 +290,12 @@ public:
   void begin_phase() override final;
   void end_phase(unsigned cpu) override final;
 
-  void initialize_instruction();
+  long initialize_instruction();
+  long fill_fetch_target_queue();
+  void account_cycle(uint64_t retired);
+  bool quiescent() const;
+  uint64_t next_wake_cycle();
+  std::size_t input_size() const;
   long check_dib();
   long fetch_instruction();
   long promote_to_decode();
@@ -167,12 +307,19 @@ public:
   long complete_inflight_instruction();
   long handle_memory_return();
   long retire_rob();
+  long admit_to_window();
 
+  long operate_load_issuer();
+  std::optional<std::size_t> select_fetch_thread() const;
+  ooo_model_instr take_input(std::size_t thread);
+  std::size_t thread_share(std::size_t size) const;
+  bool window_has_room(std::size_t thread, const ooo_model_instr& instr, std::size_t window_size) const;
   bool do_init_instruction(ooo_model_instr& instr);
   bool do_predict_branch(ooo_model_instr& instr);
   void do_check_dib(ooo_model_instr& instr);
-  bool do_fetch_instruction(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end);
+  bool do_fetch_instruction(instr_window_type::iterator begin, instr_window_type::iterator end);
   void do_dib_update(const ooo_model_instr& instr);
+  bool do_rename(ooo_model_instr& instr);
   void do_scheduling(ooo_model_instr& instr);
   void do_execution(ooo_model_instr& rob_it);
   void do_memory_scheduling(ooo_model_instr& instr);
@@ -182,10 +329,12 @@ public:
   void do_finish_store(const LSQ_ENTRY& sq_entry);
   bool do_complete_store(const LSQ_ENTRY& sq_entry);
   bool execute_load(const LSQ_ENTRY& lq_entry);
+  void release_lq_entry(std::size_t slot);
 
   uint64_t roi_instr() const { return roi_stats.instrs(); }
   uint64_t roi_cycle() const { return roi_stats.cycles(); }
   uint64_t sim_instr() const { return num_retired - begin_phase_instr; }
+  uint64_t sim_thread_instr() const;
   uint64_t sim_cycle() const { return current_cycle - sim_stats.begin_cycles; }
 
   void print_deadlock() override final;
@@ -247,6 +396,7 @@ public:
     std::size_t m_dib_set{};
     std::size_t m_dib_way{};
     std::size_t m_dib_window{};
+    std::size_t m_ftq_size{};
     std::size_t m_ifetch_buffer_size{};
     std::size_t m_decode_buffer_size{};
     std::size_t m_dispatch_buffer_size{};
@@ -266,6 +416,15 @@ public:
     unsigned m_dispatch_latency{};
     unsigned m_schedule_latency{};
     unsigned m_execute_latency{};
+    std::size_t m_physical_registers{};
+
+    model_type m_model{model_type::out_of_order};
+    std::size_t m_mlp_window{16};
+    unsigned m_issue_width{4};
+    bool m_dependent_loads{false};
+    std::size_t m_threads{1};
+    fetch_policy_type m_fetch_policy{fetch_policy_type::round_robin};
+    bool m_partitioned_queues{false};
 
     CACHE* m_l1i{};
     long int m_l1i_bw{};
@@ -278,12 +437,14 @@ public:
     template <unsigned long long OTHER_B, unsigned long long OTHER_T>
     Builder(builder_conversion_tag, const Builder<OTHER_B, OTHER_T>& other)
         : m_cpu(other.m_cpu), m_freq_scale(other.m_freq_scale), m_dib_set(other.m_dib_set), m_dib_way(other.m_dib_way), m_dib_window(other.m_dib_window),
-          m_ifetch_buffer_size(other.m_ifetch_buffer_size), m_decode_buffer_size(other.m_decode_buffer_size),
+          m_ftq_size(other.m_ftq_size), m_ifetch_buffer_size(other.m_ifetch_buffer_size), m_decode_buffer_size(other.m_decode_buffer_size),
           m_dispatch_buffer_size(other.m_dispatch_buffer_size), m_rob_size(other.m_rob_size), m_lq_size(other.m_lq_size), m_sq_size(other.m_sq_size),
           m_fetch_width(other.m_fetch_width), m_decode_width(other.m_decode_width), m_dispatch_width(other.m_dispatch_width),
           m_schedule_width(other.m_schedule_width), m_execute_width(other.m_execute_width), m_lq_width(other.m_lq_width), m_sq_width(other.m_sq_width),
           m_retire_width(other.m_retire_width), m_mispredict_penalty(other.m_mispredict_penalty), m_decode_latency(other.m_decode_latency),
           m_dispatch_latency(other.m_dispatch_latency), m_schedule_latency(other.m_schedule_latency), m_execute_latency(other.m_execute_latency),
+          m_physical_registers(other.m_physical_registers), m_model(other.m_model), m_mlp_window(other.m_mlp_window), m_issue_width(other.m_issue_width), m_dependent_loads(other.m_dependent_loads),
+          m_threads(other.m_threads), m_fetch_policy(other.m_fetch_policy), m_partitioned_queues(other.m_partitioned_queues),
           m_l1i(other.m_l1i), m_l1i_bw(other.m_l1i_bw), m_l1d_bw(other.m_l1d_bw), m_fetch_queues(other.m_fetch_queues), m_data_queues(other.m_data_queues)
     {
     }
@@ -316,6 +477,11 @@ public:
       m_dib_window = dib_window_;
       return *this;
     }
+    self_type& ftq_size(std::size_t ftq_size_)
+    {
+      m_ftq_size = ftq_size_;
+      return *this;
+    }
     self_type& ifetch_buffer_size(std::size_t ifetch_buffer_size_)
     {
       m_ifetch_buffer_size = ifetch_buffer_size_;
@@ -411,6 +577,46 @@ public:
       m_execute_latency = execute_latency_;
       return *this;
     }
+    self_type& physical_registers(std::size_t physical_registers_)
+    {
+      m_physical_registers = physical_registers_;
+      return *this;
+    }
+    self_type& model(model_type model_)
+    {
+      m_model = model_;
+      return *this;
+    }
+    self_type& mlp_window(std::size_t mlp_window_)
+    {
+      m_mlp_window = mlp_window_;
+      return *this;
+    }
+    self_type& issue_width(unsigned issue_width_)
+    {
+      m_issue_width = issue_width_;
+      return *this;
+    }
+    self_type& dependent_loads(bool dependent_loads_)
+    {
+      m_dependent_loads = dependent_loads_;
+      return *this;
+    }
+    self_type& threads(std::size_t threads_)
+    {
+      m_threads = threads_;
+      return *this;
+    }
+    self_type& fetch_policy(fetch_policy_type fetch_policy_)
+    {
+      m_fetch_policy = fetch_policy_;
+      return *this;
+    }
+    self_type& partitioned_queues(bool partitioned_queues_)
+    {
+      m_partitioned_queues = partitioned_queues_;
+      return *this;
+    }
     self_type& l1i(CACHE* l1i_)
     {
       m_l1i = l1i_;
@@ -452,14 +658,36 @@ public:
   template <unsigned long long B_FLAG, unsigned long long T_FLAG>
   explicit O3_CPU(Builder<B_FLAG, T_FLAG> b)
       : champsim::operable(b.m_freq_scale), cpu(b.m_cpu), DIB(b.m_dib_set, b.m_dib_way, {champsim::lg2(b.m_dib_window)}, {champsim::lg2(b.m_dib_window)}),
-        LQ(b.m_lq_size), IFETCH_BUFFER_SIZE(b.m_ifetch_buffer_size), DISPATCH_BUFFER_SIZE(b.m_dispatch_buffer_size), DECODE_BUFFER_SIZE(b.m_decode_buffer_size),
+        LQ(b.m_lq_size), FTQ_SIZE(b.m_ftq_size), IFETCH_BUFFER_SIZE(b.m_ifetch_buffer_size), DISPATCH_BUFFER_SIZE(b.m_dispatch_buffer_size), DECODE_BUFFER_SIZE(b.m_decode_buffer_size),
         ROB_SIZE(b.m_rob_size), SQ_SIZE(b.m_sq_size), FETCH_WIDTH(b.m_fetch_width), DECODE_WIDTH(b.m_decode_width), DISPATCH_WIDTH(b.m_dispatch_width),
         SCHEDULER_SIZE(b.m_schedule_width), EXEC_WIDTH(b.m_execute_width), LQ_WIDTH(b.m_lq_width), SQ_WIDTH(b.m_sq_width), RETIRE_WIDTH(b.m_retire_width),
         BRANCH_MISPREDICT_PENALTY(b.m_mispredict_penalty), DISPATCH_LATENCY(b.m_dispatch_latency), DECODE_LATENCY(b.m_decode_latency),
         SCHEDULING_LATENCY(b.m_schedule_latency), EXEC_LATENCY(b.m_execute_latency), L1I_BANDWIDTH(b.m_l1i_bw), L1D_BANDWIDTH(b.m_l1d_bw),
-        L1I_bus(b.m_cpu, b.m_fetch_queues), L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), module_pimpl(std::make_unique<module_model<B_FLAG, T_FLAG>>(this))
+        MODEL(b.m_model), MLP_WINDOW(b.m_mlp_window), ISSUE_WIDTH(b.m_issue_width), DEPENDENT_LOADS(b.m_dependent_loads),
+        NUM_THREADS(b.m_threads), FETCH_POLICY(b.m_fetch_policy), PARTITIONED_QUEUES(b.m_partitioned_queues), threads(b.m_threads), L1I_bus(b.m_cpu, b.m_fetch_queues), L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), module_pimpl(std::make_unique<module_model<B_FLAG, T_FLAG>>(this))
   {
+    instr_window.reserve(FTQ_SIZE + IFETCH_BUFFER_SIZE + DECODE_BUFFER_SIZE + DISPATCH_BUFFER_SIZE + std::max<std::size_t>(ROB_SIZE, MLP_WINDOW));
+
+    for (std::size_t slot = 0; slot < std::size(LQ); ++slot)
+      lq_free_slots.push(slot);
+
+    // Without a limit, there are enough physical registers for every thread's architectural registers and every destination in the ROB
+    auto num_physical_registers = b.m_physical_registers;
+    if (num_physical_registers == 0)
+      num_physical_registers = NUM_THREADS * std::tuple_size_v<register_alias_table_type> + ROB_SIZE * NUM_INSTR_DESTINATIONS_SPARC;
+
+    for (auto& ctx : threads)
+      ctx.register_alias_table.fill(NO_REGISTER);
+    sim_stats.threads.resize(NUM_THREADS);
+    physical_register_file.resize(num_physical_registers);
+    for (auto reg = num_physical_registers; reg > 0; --reg)
+      free_physical_registers.push_back(static_cast<uint32_t>(reg - 1));
   }
+
+  O3_CPU(const O3_CPU&) = delete;
+  O3_CPU(O3_CPU&&) = delete;
+  O3_CPU& operator=(const O3_CPU&) = delete;
+  O3_CPU& operator=(O3_CPU&&) = delete;
 };
 
 #include "ooo_cpu_module_def.inc"
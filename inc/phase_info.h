@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "cache.h"
+#include "dram_cache.h"
 #include "dram_controller.h"
 #include "ooo_cpu.h"
 #include <string_view>
@@ -43,7 +44,9 @@ struct phase_stats {
   std::vector<std::string> trace_names;
   std::vector<O3_CPU::stats_type> roi_cpu_stats, sim_cpu_stats;
   std::vector<CACHE::stats_type> roi_cache_stats, sim_cache_stats;
+  std::vector<DRAM_CACHE::stats_type> roi_dram_cache_stats, sim_dram_cache_stats;
   std::vector<DRAM_CHANNEL::stats_type> roi_dram_stats, sim_dram_stats;
+  std::vector<FAR_MEMORY::stats_type> roi_far_memory_stats, sim_far_memory_stats;
 };
 
 } // namespace champsim
@@ -0,0 +1,72 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PREFETCH_ARBITER_H
+#define PREFETCH_ARBITER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class UCB;
+
+namespace champsim
+{
+/**
+ * Chooses which of several prefetchers composed on one cache may move their candidates into the cache's prefetch queue.
+ *
+ * Each cycle, the cache asks for an order over the prefetchers. Candidates are issued from the first prefetcher in the order until the queue is
+ * full, then from the next, and so on. Prefetchers absent from the order have their candidates dropped.
+ */
+class prefetch_arbiter
+{
+public:
+  enum class policy {
+    priority,    // in the order of the module constants
+    round_robin, // the first prefetcher rotates each cycle
+    accuracy,    // in order of measured accuracy
+    bandit       // one prefetcher per epoch, chosen by a UCB bandit rewarded with useful prefetches
+  };
+
+  constexpr static uint64_t EPOCH = 1024;          // fills per bandit epoch
+  constexpr static double BANDIT_EXPLORATION = 0.04; // as in the micro-armed bandit replacement policy
+
+private:
+  policy arbitration;
+  std::size_t num_sources;
+  std::size_t next_turn = 0;
+  std::vector<uint64_t> issued, useful;
+
+  std::unique_ptr<UCB> bandit;
+  std::size_t chosen_arm;
+  uint64_t epoch_fills = 0;
+  uint64_t epoch_reward = 0;
+
+public:
+  prefetch_arbiter(policy arbitration_, std::size_t num_sources_);
+  ~prefetch_arbiter();
+
+  std::vector<std::size_t> order();
+
+  void record_issued(std::size_t source);
+  void record_useful(std::size_t source);
+  void record_fill();
+
+  policy get_policy() const { return arbitration; }
+};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PREFETCH_FEEDBACK_H
+#define PREFETCH_FEEDBACK_H
+
+#include <bitset>
+#include <cstdint>
+
+namespace champsim
+{
+/**
+ * Feedback-directed prefetch throttling, after Srinath et al., "Feedback Directed Prefetching" (HPCA 2007).
+ *
+ * Over each interval of fills, the cache counts the prefetches it sent, how many of them were used, how many of those were used while still in
+ * flight, and how many demand misses were to lines that a prefetch had evicted. At the end of an interval, the accuracy, lateness, and pollution
+ * of the prefetcher move its aggressiveness up or down by one level.
+ */
+class prefetch_feedback
+{
+public:
+  constexpr static unsigned MIN_LEVEL = 1;
+  constexpr static unsigned MAX_LEVEL = 5;
+  constexpr static uint64_t INTERVAL = 8192; // fills
+  constexpr static std::size_t FILTER_SIZE = 4096;
+
+  constexpr static double ACCURACY_HIGH = 0.75;
+  constexpr static double ACCURACY_LOW = 0.40;
+  constexpr static double LATENESS_THRESHOLD = 0.01;
+  constexpr static double POLLUTION_THRESHOLD = 0.005;
+
+  struct counters_type {
+    double sent = 0;
+    double used = 0;
+    double late = 0;
+    double polluting = 0;
+    double demand_misses = 0;
+  };
+
+private:
+  unsigned current_level = (MIN_LEVEL + MAX_LEVEL) / 2;
+  uint64_t interval_fills = 0;
+  counters_type interval{}, smoothed{};
+  std::bitset<FILTER_SIZE> evicted_by_prefetch{};
+
+  static std::size_t filter_index(uint64_t block);
+
+public:
+  void record_sent() { ++interval.sent; }
+  void record_used() { ++interval.used; }
+  void record_late() { ++interval.late; }
+
+  // Returns true if the miss was to a line evicted by a prefetch
+  bool record_demand_miss(uint64_t block);
+  void record_prefetch_eviction(uint64_t block);
+  void record_demand_fill(uint64_t block);
+
+  // Returns true if the interval ended and the level changed
+  bool record_fill();
+  bool end_interval();
+
+  unsigned level() const { return current_level; }
+  counters_type counters() const { return smoothed; }
+
+  /**
+   * The occupancy ratio of the MSHR or the lower level's queue above which a new prefetch is dropped.
+   * Prefetches that would not fill this level are taken to be of low confidence, and are dropped one level earlier.
+   */
+  static double occupancy_ceiling(unsigned level, bool fill_this_level);
+
+  /**
+   * The degree a prefetcher should use at the given level.
+   * The middle level keeps the default degree, and each level above or below it adds or removes one, down to a degree of 1.
+   */
+  static int scaled_degree(int default_degree, unsigned level);
+};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PREFETCH_ORCHESTRATOR_H
+#define PREFETCH_ORCHESTRATOR_H
+
+#include <array>
+#include <cstdint>
+
+namespace champsim
+{
+/**
+ * Chooses the configuration of a cache's prefetcher with a multi-armed bandit, in the manner of the micro-armed bandit replacement policy.
+ *
+ * Arm 0 turns prefetching off, and the others pair a degree with a distance. Each epoch of demand accesses is rewarded with its hit rate. A discounted UCB policy (Garivier and Moulines, 2011) forgets old rewards, so that the choice follows phase changes
+ * in the workload. The policy is kept here, rather than taken from bandit/, whose DUCB counts pulls in integers, so that the micro-armed bandit
+ * keeps its behavior.
+ */
+class prefetch_orchestrator
+{
+public:
+  struct configuration {
+    unsigned degree;   // lines prefetched per trigger, or 0 if prefetching is off
+    unsigned distance; // steps ahead of the trigger at which the first prefetch is issued
+  };
+
+  constexpr static std::array<configuration, 7> ARMS{{{0, 0}, {1, 1}, {2, 1}, {4, 1}, {1, 4}, {2, 4}, {4, 4}}};
+  constexpr static unsigned NUM_ARMS = std::size(ARMS);
+  constexpr static uint64_t EPOCH = 2048; // demand accesses
+  constexpr static double EXPLORATION = 0.04;
+  constexpr static double DISCOUNT = 0.975;
+
+private:
+  std::array<double, NUM_ARMS> reward_sums{}; // discounted, and normalized by the mean reward of the first round
+  std::array<double, NUM_ARMS> pulls{};       // discounted
+  double reward_scale = 1;
+  bool first_round = true;
+  unsigned arm = 0;
+  uint64_t epoch_accesses = 0;
+  uint64_t epoch_hits = 0;
+
+  void update(double reward);
+  unsigned select_arm() const;
+
+public:
+  // Returns true if the epoch ended and the configuration changed
+  bool record_access(bool hit);
+
+  unsigned chosen_arm() const { return arm; }
+  configuration chosen_configuration() const { return ARMS[arm]; }
+  bool prefetch_enabled() const { return chosen_configuration().degree > 0; }
+};
+} // namespace champsim
+
+#endif
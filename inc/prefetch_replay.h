@@ -0,0 +1,91 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PREFETCH_REPLAY_H
+#define PREFETCH_REPLAY_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "access_log.h"
+
+class CACHE;
+
+namespace champsim
+{
+/**
+ * Replays an access log to the prefetcher of a cache without simulating timing.
+ *
+ * A functional model with the cache's sets and ways, replaced in least-recently-used order, decides which accesses hit. The prefetcher is shown those
+ * hits rather than the recorded ones, so that it learns from its own prefetches. Misses and prefetches fill a fixed number of accesses after they are
+ * issued.
+ */
+class prefetch_replay
+{
+public:
+  struct stats_type {
+    uint64_t accesses = 0;
+    uint64_t demand_accesses = 0;
+    uint64_t demand_misses = 0;
+    uint64_t recorded_demand_misses = 0;
+    uint64_t pf_issued = 0;  // prefetches of lines that were neither present nor in flight
+    uint64_t pf_useful = 0;
+    uint64_t pf_late = 0;    // useful prefetches that were still in flight when demanded
+    uint64_t pf_useless = 0; // prefetches evicted without use
+
+    double accuracy() const;
+    double coverage() const;
+  };
+
+private:
+  struct line_type {
+    bool valid = false;
+    bool prefetch = false;
+    uint64_t block = 0;
+    uint64_t last_used = 0;
+  };
+
+  struct fill_type {
+    uint64_t block;
+    bool prefetch;
+    uint64_t ready;
+  };
+
+  CACHE& cache;
+  const uint64_t fill_latency;
+  std::vector<line_type> lines;
+  std::deque<fill_type> inflight{}; // in the order they become ready, since the latency is fixed
+  uint64_t clock = 0;
+  stats_type stats{};
+
+  line_type* find(uint64_t block);
+  void fill(const fill_type& filled);
+  void complete_fills();
+
+public:
+  // Fill latencies are counted in accesses
+  prefetch_replay(CACHE& cache, uint64_t fill_latency);
+
+  void replay(const access_record& record);
+
+  // Discard the statistics gathered so far, such as at the end of a warmup
+  void begin_measurement() { stats = {}; }
+  const stats_type& get_stats() const { return stats; }
+};
+} // namespace champsim
+
+#endif
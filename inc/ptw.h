@@ -49,8 +49,8 @@ class PageTableWalker : public champsim::operable
     uint64_t v_address = 0;
     uint64_t data = 0;
 
-    std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
-    std::vector<std::deque<response_type>*> to_return{};
+    channel_type::dependents_type instr_depend_on_me{};
+    channel_type::return_list_type to_return{};
 
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
     uint32_t pf_metadata = 0;
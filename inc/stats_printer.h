@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "cache.h"
+#include "dram_cache.h"
 #include "dram_controller.h"
 #include "ooo_cpu.h"
 #include "phase_info.h"
@@ -30,7 +31,9 @@ class plain_printer
 
   void print(O3_CPU::stats_type);
   void print(CACHE::stats_type);
+  void print(DRAM_CACHE::stats_type);
   void print(DRAM_CHANNEL::stats_type);
+  void print(FAR_MEMORY::stats_type);
 
   template <typename T>
   void print(std::vector<T> stats_list)
@@ -0,0 +1,183 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_BLOCK_INDEX_H
+#define UTIL_BLOCK_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "util/ring_buffer.h"
+
+namespace champsim
+{
+/**
+ * A multimap from block address to the positions that hold that block.
+ * Positions for each block are kept in ascending order, so the first element is the oldest (or lowest) holder.
+ */
+class block_index
+{
+  std::unordered_map<uint64_t, std::vector<uint64_t>> positions{};
+  unsigned shamt = 0;
+
+  inline static const std::vector<uint64_t> none{};
+
+public:
+  block_index() = default;
+  explicit block_index(unsigned shamt_) : shamt(shamt_) {}
+
+  void insert(uint64_t address, uint64_t pos)
+  {
+    auto& list = positions[address >> shamt];
+    list.insert(std::upper_bound(std::begin(list), std::end(list), pos), pos);
+  }
+
+  void erase(uint64_t address, uint64_t pos)
+  {
+    if (auto found = positions.find(address >> shamt); found != std::end(positions)) {
+      auto& list = found->second;
+      if (auto it = std::lower_bound(std::begin(list), std::end(list), pos); it != std::end(list) && *it == pos)
+        list.erase(it);
+      if (std::empty(list))
+        positions.erase(found);
+    }
+  }
+
+  void clear() { positions.clear(); }
+
+  const std::vector<uint64_t>& find(uint64_t address) const
+  {
+    if (auto found = positions.find(address >> shamt); found != std::end(positions))
+      return found->second;
+    return none;
+  }
+};
+
+/**
+ * A FIFO queue that maintains a block_index over the addresses of its elements.
+ * Elements may be appended at the back and erased anywhere. Entries are held in a ring_buffer, so their slots are recycled. The address of an element must not be modified while it is in the queue.
+ */
+template <typename T>
+class block_indexed_queue
+{
+  using storage_type = ring_buffer<T>;
+  storage_type entries{};
+  ring_buffer<uint64_t> seqs{};
+  block_index index{};
+  uint64_t next_seq = 0;
+
+  void note_added()
+  {
+    seqs.push_back(next_seq);
+    index.insert(entries.back().address, next_seq++);
+  }
+
+  auto locate(uint64_t seq)
+  {
+    return std::next(std::begin(entries), std::distance(std::begin(seqs), std::lower_bound(std::begin(seqs), std::end(seqs), seq)));
+  }
+
+public:
+  using value_type = typename storage_type::value_type;
+  using reference = typename storage_type::reference;
+  using const_reference = typename storage_type::const_reference;
+  using iterator = typename storage_type::iterator;
+  using const_iterator = typename storage_type::const_iterator;
+  using size_type = typename storage_type::size_type;
+  using difference_type = typename storage_type::difference_type;
+
+  block_indexed_queue() = default;
+  explicit block_indexed_queue(unsigned shamt) : index(shamt) {}
+
+  iterator begin() { return std::begin(entries); }
+  iterator end() { return std::end(entries); }
+  const_iterator begin() const { return std::cbegin(entries); }
+  const_iterator end() const { return std::cend(entries); }
+  const_iterator cbegin() const { return std::cbegin(entries); }
+  const_iterator cend() const { return std::cend(entries); }
+
+  size_type size() const { return std::size(entries); }
+  bool empty() const { return std::empty(entries); }
+
+  void reserve(size_type capacity)
+  {
+    entries.reserve(capacity);
+    seqs.reserve(capacity);
+  }
+
+  reference front() { return entries.front(); }
+  const_reference front() const { return entries.front(); }
+  reference back() { return entries.back(); }
+  const_reference back() const { return entries.back(); }
+
+  void push_back(const value_type& value)
+  {
+    entries.push_back(value);
+    note_added();
+  }
+
+  void push_back(value_type&& value)
+  {
+    entries.push_back(std::move(value));
+    note_added();
+  }
+
+  template <typename... Args>
+  reference emplace_back(Args&&... args)
+  {
+    entries.emplace_back(std::forward<Args>(args)...);
+    note_added();
+    return back();
+  }
+
+  iterator erase(const_iterator first, const_iterator last)
+  {
+    auto first_idx = std::distance(std::cbegin(entries), first);
+    auto last_idx = std::distance(std::cbegin(entries), last);
+    for (auto idx = first_idx; idx != last_idx; ++idx)
+      index.erase(entries[static_cast<size_type>(idx)].address, seqs[static_cast<size_type>(idx)]);
+
+    seqs.erase(std::next(std::cbegin(seqs), first_idx), std::next(std::cbegin(seqs), last_idx));
+    return entries.erase(first, last);
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, std::next(pos)); }
+
+  void clear()
+  {
+    entries.clear();
+    seqs.clear();
+    index.clear();
+  }
+
+  /**
+   * Find the oldest element whose block address matches the given address, or end() if there is none.
+   */
+  iterator find(uint64_t address)
+  {
+    const auto& found = index.find(address);
+    if (std::empty(found))
+      return end();
+    return locate(found.front());
+  }
+};
+} // namespace champsim
+
+#endif
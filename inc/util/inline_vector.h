@@ -0,0 +1,107 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_INLINE_VECTOR_H
+#define UTIL_INLINE_VECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+
+namespace champsim
+{
+/**
+ * A vector with a fixed capacity of N elements, stored in an array alongside a count.
+ * It never allocates, so copying it is a fixed-size copy. Growing it past its capacity is an error.
+ */
+template <typename T, std::size_t N>
+class inline_vector
+{
+  static_assert(N <= std::numeric_limits<uint8_t>::max(), "Inline vectors hold their count in a byte");
+
+  std::array<T, N> storage{};
+  uint8_t count = 0;
+
+public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = T*;
+  using const_iterator = const T*;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  inline_vector() = default;
+  inline_vector(std::initializer_list<T> init) : inline_vector(std::begin(init), std::end(init)) {}
+
+  template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+  inline_vector(InputIt first, InputIt last)
+  {
+    for (; first != last; ++first)
+      push_back(*first);
+  }
+
+  iterator begin() { return std::data(storage); }
+  iterator end() { return std::data(storage) + count; }
+  const_iterator begin() const { return std::data(storage); }
+  const_iterator end() const { return std::data(storage) + count; }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  T* data() { return std::data(storage); }
+  const T* data() const { return std::data(storage); }
+
+  size_type size() const { return count; }
+  static constexpr size_type capacity() { return N; }
+  bool empty() const { return count == 0; }
+  bool full() const { return count == N; }
+
+  reference operator[](size_type idx) { return storage[idx]; }
+  const_reference operator[](size_type idx) const { return storage[idx]; }
+  reference front() { return storage[0]; }
+  const_reference front() const { return storage[0]; }
+  reference back() { return storage[count - 1]; }
+  const_reference back() const { return storage[count - 1]; }
+
+  void push_back(const T& value)
+  {
+    assert(!full());
+    storage[count++] = value;
+  }
+
+  iterator erase(const_iterator first, const_iterator last)
+  {
+    auto pos = begin() + std::distance(cbegin(), first);
+    auto new_end = std::copy(last, cend(), pos);
+    count = static_cast<uint8_t>(std::distance(begin(), new_end));
+    return pos;
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, std::next(pos)); }
+
+  void clear() { count = 0; }
+
+  friend bool operator==(const inline_vector& lhs, const inline_vector& rhs) { return std::equal(std::begin(lhs), std::end(lhs), std::begin(rhs), std::end(rhs)); }
+  friend bool operator!=(const inline_vector& lhs, const inline_vector& rhs) { return !(lhs == rhs); }
+};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,222 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_RING_BUFFER_H
+#define UTIL_RING_BUFFER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace champsim
+{
+/**
+ * A FIFO queue over a circular array of preallocated slots.
+ *
+ * Slots are never destroyed while the buffer lives. Popping or erasing an element leaves its slot (and any storage it owns, such as vector
+ * capacity) in place, and a later push assigns into that slot, so a queue that has reached its steady-state depth does not allocate.
+ * The capacity is always a power of two. Pushing into a full buffer doubles it; bounded users should reserve() their bound up front.
+ */
+template <typename T>
+class ring_buffer
+{
+  std::vector<T> slots{};
+  std::size_t head = 0;
+  std::size_t count = 0;
+
+  std::size_t mask() const { return std::size(slots) - 1; }
+  T& slot(std::size_t idx) { return slots[(head + idx) & mask()]; }
+  const T& slot(std::size_t idx) const { return slots[(head + idx) & mask()]; }
+
+  void grow(std::size_t new_capacity)
+  {
+    static_assert(std::is_default_constructible_v<T>, "Ring buffer slots must be default-constructible");
+    std::rotate(std::begin(slots), std::next(std::begin(slots), static_cast<std::ptrdiff_t>(head)), std::end(slots));
+    head = 0;
+    slots.resize(new_capacity);
+  }
+
+  template <bool Const>
+  class ring_iterator
+  {
+    friend class ring_buffer;
+    using buffer_type = std::conditional_t<Const, const ring_buffer, ring_buffer>;
+    buffer_type* buf = nullptr;
+    std::ptrdiff_t idx = 0;
+
+    ring_iterator(buffer_type* buf_, std::ptrdiff_t idx_) : buf(buf_), idx(idx_) {}
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T*, T*>;
+    using reference = std::conditional_t<Const, const T&, T&>;
+
+    ring_iterator() = default;
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    ring_iterator(const ring_iterator<false>& other) : buf(other.buf), idx(other.idx) // NOLINT: implicit conversion to const_iterator
+    {
+    }
+
+    reference operator*() const { return buf->slot(static_cast<std::size_t>(idx)); }
+    pointer operator->() const { return &buf->slot(static_cast<std::size_t>(idx)); }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    ring_iterator& operator++()
+    {
+      ++idx;
+      return *this;
+    }
+    ring_iterator operator++(int)
+    {
+      auto retval = *this;
+      ++idx;
+      return retval;
+    }
+    ring_iterator& operator--()
+    {
+      --idx;
+      return *this;
+    }
+    ring_iterator operator--(int)
+    {
+      auto retval = *this;
+      --idx;
+      return retval;
+    }
+    ring_iterator& operator+=(difference_type n)
+    {
+      idx += n;
+      return *this;
+    }
+    ring_iterator& operator-=(difference_type n)
+    {
+      idx -= n;
+      return *this;
+    }
+
+    friend ring_iterator operator+(ring_iterator it, difference_type n) { return it += n; }
+    friend ring_iterator operator+(difference_type n, ring_iterator it) { return it += n; }
+    friend ring_iterator operator-(ring_iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const ring_iterator& lhs, const ring_iterator& rhs) { return lhs.idx - rhs.idx; }
+
+    friend bool operator==(const ring_iterator& lhs, const ring_iterator& rhs) { return lhs.idx == rhs.idx; }
+    friend bool operator!=(const ring_iterator& lhs, const ring_iterator& rhs) { return lhs.idx != rhs.idx; }
+    friend bool operator<(const ring_iterator& lhs, const ring_iterator& rhs) { return lhs.idx < rhs.idx; }
+    friend bool operator>(const ring_iterator& lhs, const ring_iterator& rhs) { return lhs.idx > rhs.idx; }
+    friend bool operator<=(const ring_iterator& lhs, const ring_iterator& rhs) { return lhs.idx <= rhs.idx; }
+    friend bool operator>=(const ring_iterator& lhs, const ring_iterator& rhs) { return lhs.idx >= rhs.idx; }
+  };
+
+public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = ring_iterator<false>;
+  using const_iterator = ring_iterator<true>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  ring_buffer() = default;
+  explicit ring_buffer(size_type capacity) { reserve(capacity); }
+
+  iterator begin() { return {this, 0}; }
+  iterator end() { return {this, static_cast<difference_type>(count)}; }
+  const_iterator begin() const { return {this, 0}; }
+  const_iterator end() const { return {this, static_cast<difference_type>(count)}; }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  size_type size() const { return count; }
+  size_type capacity() const { return std::size(slots); }
+  bool empty() const { return count == 0; }
+  bool full() const { return count == capacity(); }
+
+  reference operator[](size_type idx) { return slot(idx); }
+  const_reference operator[](size_type idx) const { return slot(idx); }
+  reference front() { return slot(0); }
+  const_reference front() const { return slot(0); }
+  reference back() { return slot(count - 1); }
+  const_reference back() const { return slot(count - 1); }
+
+  void reserve(size_type new_capacity)
+  {
+    if (new_capacity > capacity()) {
+      size_type rounded = 1;
+      while (rounded < new_capacity)
+        rounded <<= 1;
+      grow(rounded);
+    }
+  }
+
+  void push_back(const value_type& value)
+  {
+    if (full())
+      grow(std::max<size_type>(1, 2 * capacity()));
+    slot(count++) = value;
+  }
+
+  void push_back(value_type&& value)
+  {
+    if (full())
+      grow(std::max<size_type>(1, 2 * capacity()));
+    slot(count++) = std::move(value);
+  }
+
+  template <typename... Args>
+  reference emplace_back(Args&&... args)
+  {
+    push_back(value_type{std::forward<Args>(args)...});
+    return back();
+  }
+
+  void pop_front()
+  {
+    head = (head + 1) & mask();
+    --count;
+  }
+
+  iterator erase(const_iterator first, const_iterator last)
+  {
+    auto n = static_cast<size_type>(last - first);
+    if (first == cbegin()) {
+      head = (head + n) & mask();
+      count -= n;
+      return begin();
+    }
+
+    // Rotate the erased slots behind the live elements so that they are recycled
+    auto pos = iterator{this, first.idx};
+    std::rotate(pos, iterator{this, last.idx}, end());
+    count -= n;
+    return pos;
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, std::next(pos)); }
+
+  void clear()
+  {
+    head = 0;
+    count = 0;
+  }
+};
+} // namespace champsim
+
+#endif
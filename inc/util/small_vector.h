@@ -0,0 +1,218 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_SMALL_VECTOR_H
+#define UTIL_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace champsim
+{
+/**
+ * A vector that stores up to N elements inline and only allocates when it grows past them.
+ * Elements must be trivially copyable, which covers the references and pointers that packets carry.
+ */
+template <typename T, std::size_t N>
+class small_vector
+{
+  static_assert(std::is_trivially_copyable_v<T>, "Small vector elements must be trivially copyable");
+
+  std::size_t count = 0;
+  std::size_t cap = N;
+  T* heap = nullptr;
+  alignas(T) unsigned char inline_storage[N * sizeof(T)];
+
+  T* storage() { return heap != nullptr ? heap : reinterpret_cast<T*>(inline_storage); }
+  const T* storage() const { return heap != nullptr ? heap : reinterpret_cast<const T*>(inline_storage); }
+
+  void release()
+  {
+    if (heap != nullptr)
+      std::allocator<T>{}.deallocate(heap, cap);
+    heap = nullptr;
+    cap = N;
+  }
+
+public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = T*;
+  using const_iterator = const T*;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  small_vector() = default;
+  small_vector(std::initializer_list<T> init) : small_vector(std::begin(init), std::end(init)) {}
+
+  template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+  small_vector(InputIt first, InputIt last)
+  {
+    reserve(static_cast<size_type>(std::distance(first, last)));
+    for (; first != last; ++first)
+      push_back(*first);
+  }
+
+  small_vector(const small_vector& other) { *this = other; }
+  small_vector(small_vector&& other) noexcept { *this = std::move(other); }
+  ~small_vector() { release(); }
+
+  small_vector& operator=(const small_vector& other)
+  {
+    if (this != &other) {
+      count = 0;
+      reserve(other.count);
+      std::uninitialized_copy(std::begin(other), std::end(other), storage());
+      count = other.count;
+    }
+    return *this;
+  }
+
+  small_vector& operator=(small_vector&& other) noexcept
+  {
+    if (this != &other) {
+      if (other.heap != nullptr) {
+        release();
+        heap = std::exchange(other.heap, nullptr);
+        cap = std::exchange(other.cap, N);
+        count = std::exchange(other.count, 0);
+      } else {
+        count = 0;
+        std::uninitialized_copy(std::begin(other), std::end(other), storage());
+        count = std::exchange(other.count, 0);
+      }
+    }
+    return *this;
+  }
+
+  iterator begin() { return storage(); }
+  iterator end() { return storage() + count; }
+  const_iterator begin() const { return storage(); }
+  const_iterator end() const { return storage() + count; }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  T* data() { return storage(); }
+  const T* data() const { return storage(); }
+
+  size_type size() const { return count; }
+  size_type capacity() const { return cap; }
+  bool empty() const { return count == 0; }
+
+  reference operator[](size_type idx) { return storage()[idx]; }
+  const_reference operator[](size_type idx) const { return storage()[idx]; }
+  reference front() { return storage()[0]; }
+  const_reference front() const { return storage()[0]; }
+  reference back() { return storage()[count - 1]; }
+  const_reference back() const { return storage()[count - 1]; }
+
+  void reserve(size_type new_cap)
+  {
+    if (new_cap > cap) {
+      new_cap = std::max(new_cap, 2 * cap);
+      T* new_heap = std::allocator<T>{}.allocate(new_cap);
+      std::uninitialized_copy(begin(), end(), new_heap);
+      auto old_count = count;
+      release();
+      heap = new_heap;
+      cap = new_cap;
+      count = old_count;
+    }
+  }
+
+  void resize(size_type new_count, const T& value)
+  {
+    reserve(new_count);
+    if (new_count > count)
+      std::uninitialized_fill(end(), storage() + new_count, value);
+    count = new_count;
+  }
+
+  void push_back(const T& value)
+  {
+    if (count == cap) {
+      auto copy = value; // value may alias our storage
+      reserve(count + 1);
+      ::new (static_cast<void*>(end())) T(copy);
+    } else {
+      ::new (static_cast<void*>(end())) T(value);
+    }
+    ++count;
+  }
+
+  iterator erase(const_iterator first, const_iterator last)
+  {
+    auto pos = begin() + std::distance(cbegin(), first);
+    auto new_end = std::copy(last, cend(), pos);
+    count = static_cast<size_type>(std::distance(begin(), new_end));
+    return pos;
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, std::next(pos)); }
+
+  void clear() { count = 0; }
+};
+
+/**
+ * Merge the sorted range of src into the sorted vector dest, as if by std::set_union, without allocating while the result fits inline.
+ * Elements of dest are kept when both ranges hold an equivalent element.
+ */
+template <typename T, std::size_t N, typename Compare = std::less<>>
+void set_union_into(small_vector<T, N>& dest, const small_vector<T, N>& src, Compare comp = {})
+{
+  // Count the source elements that are not already present
+  std::size_t added = 0;
+  for (auto d_it = std::cbegin(dest), s_it = std::cbegin(src); s_it != std::cend(src);) {
+    if (d_it == std::cend(dest) || comp(*s_it, *d_it)) {
+      ++added;
+      ++s_it;
+    } else if (comp(*d_it, *s_it)) {
+      ++d_it;
+    } else {
+      ++d_it;
+      ++s_it;
+    }
+  }
+
+  if (added == 0)
+    return;
+
+  // Merge from the back, so that no element is overwritten before it is moved
+  auto old_size = std::size(dest);
+  dest.resize(old_size + added, src.front());
+  auto d_it = std::next(std::begin(dest), static_cast<std::ptrdiff_t>(old_size));
+  auto s_it = std::end(src);
+  auto out = std::end(dest);
+  while (s_it != std::begin(src)) {
+    if (d_it != std::begin(dest) && !comp(*std::prev(d_it), *std::prev(s_it))) {
+      if (!comp(*std::prev(s_it), *std::prev(d_it)))
+        --s_it; // Equivalent, keep the destination element
+      *--out = *--d_it;
+    } else {
+      *--out = *--s_it;
+    }
+  }
+}
+} // namespace champsim
+
+#endif
@@ -0,0 +1,171 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_STAGED_RING_H
+#define UTIL_STAGED_RING_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include "util/ring_buffer.h"
+
+namespace champsim
+{
+/**
+ * A ring of elements divided into consecutive stages. Stage 0 holds the oldest elements, and each later stage holds younger ones.
+ *
+ * Elements enter at the back of a stage and leave the oldest stage from its front. Passing elements from the front of one stage to the back of the
+ * next older stage moves the boundary between them rather than the elements, so an element keeps its slot for as long as it is in the ring.
+ * Slots are reused only after the ring wraps around, so references to an element remain safe to read for a while after it leaves.
+ *
+ * References are invalidated in two cases. Adding an element to a full ring grows it, which moves every element, so bounded users should
+ * reserve() the sum of their stage bounds up front. Adding an element to a stage while a younger stage is occupied moves each element of the
+ * younger stages back by one slot.
+ */
+template <typename T, std::size_t STAGES>
+class staged_ring
+{
+  ring_buffer<T> elements{};
+  std::array<std::size_t, STAGES> stage_sizes{};
+
+  std::size_t offset(std::size_t stage) const { return std::accumulate(std::begin(stage_sizes), std::next(std::begin(stage_sizes), stage), std::size_t{0}); }
+
+public:
+  using value_type = T;
+  using iterator = typename ring_buffer<T>::iterator;
+  using const_iterator = typename ring_buffer<T>::const_iterator;
+
+  /**
+   * A view of one stage, with the interface of a double-ended queue.
+   */
+  class stage_type
+  {
+    staged_ring* ring;
+    std::size_t idx;
+
+    std::size_t& count() { return ring->stage_sizes[idx]; }
+    std::size_t count() const { return ring->stage_sizes[idx]; }
+
+  public:
+    using value_type = T;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = typename staged_ring::iterator;
+    using const_iterator = typename staged_ring::const_iterator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    stage_type(staged_ring& ring_, std::size_t idx_) : ring(&ring_), idx(idx_) { assert(idx < STAGES); }
+
+    iterator begin() { return std::next(std::begin(ring->elements), static_cast<difference_type>(ring->offset(idx))); }
+    iterator end() { return std::next(begin(), static_cast<difference_type>(count())); }
+    const_iterator begin() const { return std::next(std::cbegin(ring->elements), static_cast<difference_type>(ring->offset(idx))); }
+    const_iterator end() const { return std::next(begin(), static_cast<difference_type>(count())); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    size_type size() const { return count(); }
+    bool empty() const { return count() == 0; }
+
+    reference operator[](size_type pos) { return begin()[static_cast<difference_type>(pos)]; }
+    const_reference operator[](size_type pos) const { return begin()[static_cast<difference_type>(pos)]; }
+    reference at(size_type pos)
+    {
+      if (pos >= size())
+        throw std::out_of_range{"staged_ring::stage_type::at"};
+      return (*this)[pos];
+    }
+    const_reference at(size_type pos) const
+    {
+      if (pos >= size())
+        throw std::out_of_range{"staged_ring::stage_type::at"};
+      return (*this)[pos];
+    }
+    reference front() { return *begin(); }
+    const_reference front() const { return *begin(); }
+    reference back() { return *std::prev(end()); }
+    const_reference back() const { return *std::prev(end()); }
+
+    void push_back(const value_type& value) { emplace_back(value); }
+    void push_back(value_type&& value) { emplace_back(std::move(value)); }
+
+    /**
+     * Add an element to the back of this stage.
+     * If the ring is full, it grows, and references to every element are invalidated. If a younger stage is occupied, its elements move back by
+     * one slot, and references to them are invalidated.
+     */
+    template <typename... Args>
+    reference emplace_back(Args&&... args)
+    {
+      auto pos = ring->offset(idx) + count();
+      ring->elements.push_back(value_type{std::forward<Args>(args)...});
+
+      if (pos + 1 != std::size(ring->elements))
+        std::rotate(std::next(std::begin(ring->elements), static_cast<difference_type>(pos)), std::prev(std::end(ring->elements)), std::end(ring->elements));
+
+      ++count();
+      return back();
+    }
+
+    template <typename InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last)
+    {
+      auto pos_idx = std::distance(cbegin(), pos);
+      auto old_size = static_cast<difference_type>(size());
+      for (; first != last; ++first)
+        emplace_back(*first);
+      std::rotate(std::next(begin(), pos_idx), std::next(begin(), old_size), end());
+      return std::next(begin(), pos_idx);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+      assert(cbegin() <= first && first <= last && last <= cend());
+      count() -= static_cast<size_type>(std::distance(first, last));
+      return ring->elements.erase(first, last);
+    }
+    iterator erase(const_iterator pos) { return erase(pos, std::next(pos)); }
+    void pop_front() { erase(cbegin()); }
+
+    /**
+     * Pass the n oldest elements of this stage to the back of the next older stage.
+     */
+    void advance(size_type n)
+    {
+      assert(idx > 0 && n <= count());
+      count() -= n;
+      ring->stage_sizes[idx - 1] += n;
+    }
+  };
+
+  staged_ring() = default;
+  explicit staged_ring(std::size_t capacity) : elements(capacity) {}
+
+  void reserve(std::size_t capacity) { elements.reserve(capacity); }
+  std::size_t size() const { return std::size(elements); }
+  std::size_t capacity() const { return elements.capacity(); }
+
+  stage_type stage(std::size_t idx) { return stage_type{*this, idx}; }
+};
+} // namespace champsim
+
+#endif
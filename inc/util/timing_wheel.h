@@ -0,0 +1,99 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_TIMING_WHEEL_H
+#define UTIL_TIMING_WHEEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace champsim
+{
+/**
+ * A calendar of events keyed by the cycle at which they become due.
+ *
+ * Events are kept in a circular array of buckets, one per cycle, so scheduling an event and collecting the events due in a cycle both cost time
+ * proportional to the number of events involved rather than to the number of events pending. The number of buckets is a power of two and grows
+ * when an event is scheduled further ahead than the wheel reaches. Events scheduled for a cycle that has already been collected are due at the
+ * next collection.
+ */
+template <typename T>
+class timing_wheel
+{
+  std::vector<std::vector<std::pair<uint64_t, T>>> buckets{};
+  uint64_t next_cycle = 0;
+  std::size_t count = 0;
+
+  std::size_t mask() const { return std::size(buckets) - 1; }
+
+  void grow(std::size_t new_size)
+  {
+    std::vector<std::vector<std::pair<uint64_t, T>>> old_buckets(new_size);
+    std::swap(buckets, old_buckets);
+
+    // Re-bucket in due order so that events due in the same cycle keep the order in which they were scheduled
+    for (uint64_t cycle = next_cycle; cycle < next_cycle + std::size(old_buckets); ++cycle) {
+      auto& bucket = old_buckets[cycle & (std::size(old_buckets) - 1)];
+      for (auto& event : bucket)
+        buckets[event.first & mask()].push_back(std::move(event));
+    }
+  }
+
+public:
+  std::size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+
+  void schedule(uint64_t cycle, T value)
+  {
+    cycle = std::max(cycle, next_cycle);
+    if (cycle - next_cycle >= std::size(buckets)) {
+      std::size_t new_size = std::max<std::size_t>(1, std::size(buckets));
+      while (cycle - next_cycle >= new_size)
+        new_size <<= 1;
+      grow(new_size);
+    }
+
+    buckets[cycle & mask()].emplace_back(cycle, std::move(value));
+    ++count;
+  }
+
+  /**
+   * Pass every event due at or before the given cycle to the function, in the order they are due.
+   */
+  template <typename F>
+  void advance(uint64_t cycle, F&& func)
+  {
+    if (cycle < next_cycle)
+      return;
+
+    // Every pending event is due within one turn of the wheel, so a longer jump only needs to visit each bucket once
+    auto last_cycle = std::min<uint64_t>(cycle, next_cycle + std::size(buckets) - 1);
+    for (; count > 0 && next_cycle <= last_cycle; ++next_cycle) {
+      auto& bucket = buckets[next_cycle & mask()];
+      for (auto& event : bucket)
+        func(std::move(event.second));
+      count -= std::size(bucket);
+      bucket.clear();
+    }
+    next_cycle = cycle + 1;
+  }
+};
+} // namespace champsim
+
+#endif
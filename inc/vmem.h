@@ -31,6 +31,10 @@ inline constexpr std::size_t PTE_BYTES = 8;
 
 class VirtualMemory
 {
+public:
+  // How physical pages are handed out when a far memory tier is present
+  enum class placement_type { first_touch, interleave };
+
 private:
   std::map<std::pair<uint32_t, uint64_t>, uint64_t> vpage_to_ppage_map;
   std::map<std::tuple<uint32_t, uint64_t, uint32_t>, uint64_t> page_table;
@@ -40,6 +44,12 @@ private:
   uint64_t next_ppage;
   uint64_t last_ppage;
 
+  // With interleaved placement, pages alternate between the near memory (below near_limit) and the far memory (from next_far_ppage)
+  uint64_t near_limit;
+  uint64_t next_far_ppage;
+  bool far_turn = false;
+
+  bool far_next() const;
   uint64_t ppage_front() const;
   void ppage_pop();
 
@@ -49,7 +59,8 @@ public:
   const uint64_t pte_page_size; // Size of a PTE page
 
   // capacity and pg_size are measured in bytes, and capacity must be a multiple of pg_size
-  VirtualMemory(uint64_t pg_size, std::size_t page_table_levels, uint64_t minor_penalty, MEMORY_CONTROLLER& dram);
+  VirtualMemory(uint64_t pg_size, std::size_t page_table_levels, uint64_t minor_penalty, MEMORY_CONTROLLER& dram,
+                placement_type placement = placement_type::first_touch);
   uint64_t shamt(std::size_t level) const;
   uint64_t get_offset(uint64_t vaddr, std::size_t level) const;
   std::size_t available_ppages() const;
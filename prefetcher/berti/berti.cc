@@ -4,765 +4,670 @@
 //
 // Paper #13: Berti: A Per-Page Best-Request-Time Delta Prefetcher
 
-#include "cache.h"
-#include "channel.h"
+#include <algorithm>
+#include <array>
 #include <cassert>
-#include <iostream>
-using namespace std;
-
-#define LLC_PAGE_BLOCKS_BITS (LOG2_PAGE_SIZE - LOG2_BLOCK_SIZE)
-#define LLC_PAGE_BLOCKS (1 << LLC_PAGE_BLOCKS_BITS)
-#define LLC_PAGE_OFFSET_MASK (LLC_PAGE_BLOCKS - 1)
-
-#define LLC_MAX_NUM_BURST_PREFETCHES 3
-
-#define LLC_BERTI_CTR_MED_HIGH_CONFIDENCE 2
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+#include <fmt/core.h>
 
-// TIME AND OVERFLOWS
-
-#define LLC_TIME_BITS 16
-#define LLC_TIME_OVERFLOW ((uint64_t)1 << LLC_TIME_BITS)
-#define LLC_TIME_MASK (LLC_TIME_OVERFLOW - 1)
+#include "cache.h"
+#include "msl/bits.h"
 
-uint64_t llc_get_latency(uint64_t cycle, uint64_t cycle_prev) {
-  return cycle - cycle_prev;
-  uint64_t cycle_masked = cycle & LLC_TIME_MASK;
-  uint64_t cycle_prev_masked = cycle_prev & LLC_TIME_MASK;
-  if (cycle_prev_masked > cycle_masked) {
-    return (cycle_masked + LLC_TIME_OVERFLOW) - cycle_prev_masked;
+namespace
+{
+constexpr unsigned PAGE_BLOCKS_BITS = LOG2_PAGE_SIZE - LOG2_BLOCK_SIZE;
+constexpr uint64_t PAGE_BLOCKS = 1ull << PAGE_BLOCKS_BITS;
+constexpr uint64_t PAGE_OFFSET_MASK = PAGE_BLOCKS - 1;
+
+constexpr int MAX_NUM_BURST_PREFETCHES = 3;
+constexpr unsigned BERTI_CTR_MED_HIGH_CONFIDENCE = 2;
+
+// Each cache has its own tables, so they are sized for one core. The defaults are overridden by the prefetcher parameters of the same names, in lower case.
+constexpr std::size_t CURRENT_PAGES_TABLE_ENTRIES = 1 << 6;
+constexpr std::size_t NUM_BERTI = 10;
+constexpr std::size_t NUM_BERTI_PER_ACCESS = 7;
+constexpr std::size_t PREV_REQUESTS_TABLE_ENTRIES = 1 << 10;
+constexpr std::size_t PREV_PREFETCHES_TABLE_ENTRIES = 1 << 9;
+constexpr std::size_t RECORD_PAGES_TABLE_ENTRIES = (1 << 8) + (1 << 7);
+constexpr std::size_t IP_TABLE_ENTRIES = 1 << 10;
+constexpr uint64_t TRUNCATED_PAGE_ADDR_MASK = champsim::msl::bitmask(32);
+
+int calculate_stride(uint64_t prev_offset, uint64_t current_offset) { return static_cast<int>(current_offset) - static_cast<int>(prev_offset); }
+
+uint64_t cycles_before(uint64_t cycle, uint64_t latency) { return cycle > latency ? cycle - latency : 0; }
+
+/**
+ * Maps a key to the position of its entry in one of the tables below, so that a lookup probes a few slots instead of scanning the table.
+ * The index uses open addressing with linear probing, and has at least twice as many slots as the table has entries.
+ */
+class probe_index
+{
+  struct slot_type {
+    uint64_t key;
+    std::size_t pos;
+  };
+
+  std::vector<std::optional<slot_type>> slots;
+  unsigned shamt;
+
+  std::size_t home(uint64_t key) const { return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ull) >> shamt); }
+  std::size_t next(std::size_t slot) const { return (slot + 1) & (std::size(slots) - 1); }
+
+  std::optional<std::size_t> find_slot(uint64_t key) const
+  {
+    for (auto slot = home(key); slots[slot].has_value(); slot = next(slot)) {
+      if (slots[slot]->key == key)
+        return slot;
+    }
+    return std::nullopt;
   }
-  return cycle_masked - cycle_prev_masked;
-}
 
-// STRIDE
-
-int llc_calculate_stride(uint64_t prev_offset, uint64_t current_offset) {
-  int stride;
-  if (current_offset > prev_offset) {
-    stride = current_offset - prev_offset;
-  } else {
-    stride = prev_offset - current_offset;
-    stride *= -1;
+public:
+  explicit probe_index(std::size_t entries)
+      : slots(std::size_t{1} << (champsim::msl::lg2(2 * entries - 1) + 1)), shamt(64 - champsim::msl::lg2(std::size(slots)))
+  {
   }
-  return stride;
-}
-
 
-// CURRENT PAGES TABLE
-
-#define LLC_CURRENT_PAGES_TABLE_INDEX_BITS 6
-#define LLC_CURRENT_PAGES_TABLE_ENTRIES (((1 << LLC_CURRENT_PAGES_TABLE_INDEX_BITS) * NUM_CPUS) - 1) // Null pointer for prev_request
-#define LLC_CURRENT_PAGES_TABLE_NUM_BERTI 10
-#define LLC_CURRENT_PAGES_TABLE_NUM_BERTI_PER_ACCESS 7
-
-typedef struct __llc_current_page_entry {
-  uint64_t page_addr; // 52 bits
-  uint64_t ip; // 10 bits
-  uint64_t u_vector; // 64 bits
-  uint64_t first_offset; // 6 bits
-  int berti[LLC_CURRENT_PAGES_TABLE_NUM_BERTI]; // 70 bits
-  unsigned berti_ctr[LLC_CURRENT_PAGES_TABLE_NUM_BERTI]; // 60 bits
-  uint64_t last_burst; // 6 bits
-  uint64_t lru; // 6 bits
-} llc_current_page_entry;
-
-llc_current_page_entry llc_current_pages_table[LLC_CURRENT_PAGES_TABLE_ENTRIES];
-
-void llc_init_current_pages_table() {
-  for (int i = 0; i < LLC_CURRENT_PAGES_TABLE_ENTRIES; i++) {
-    llc_current_pages_table[i].page_addr = 0;
-    llc_current_pages_table[i].ip = 0;
-    llc_current_pages_table[i].u_vector = 0; // not valid
-    llc_current_pages_table[i].last_burst = 0;
-    llc_current_pages_table[i].lru = i;
+  std::optional<std::size_t> find(uint64_t key) const
+  {
+    auto slot = find_slot(key);
+    if (!slot.has_value())
+      return std::nullopt;
+    return slots[*slot]->pos;
   }
-}
 
-uint64_t llc_get_current_pages_entry(uint64_t page_addr) {
-  for (int i = 0; i < LLC_CURRENT_PAGES_TABLE_ENTRIES; i++) {
-    if (llc_current_pages_table[i].page_addr == page_addr) return i;
+  void insert(uint64_t key, std::size_t pos)
+  {
+    auto slot = home(key);
+    while (slots[slot].has_value() && slots[slot]->key != key)
+      slot = next(slot);
+    slots[slot] = slot_type{key, pos};
   }
-  return LLC_CURRENT_PAGES_TABLE_ENTRIES;
-}
 
-void llc_update_lru_current_pages_table(uint64_t index) {
-  assert(index < LLC_CURRENT_PAGES_TABLE_ENTRIES);
-  for (int i = 0; i < LLC_CURRENT_PAGES_TABLE_ENTRIES; i++) {
-    if (llc_current_pages_table[i].lru < llc_current_pages_table[index].lru) { // Found
-      llc_current_pages_table[i].lru++;
+  // Remove the key only if it still refers to the entry at pos
+  void erase(uint64_t key, std::size_t pos)
+  {
+    auto found = find_slot(key);
+    if (!found.has_value() || slots[*found]->pos != pos)
+      return;
+
+    // Backward-shift deletion keeps every probe sequence unbroken without tombstones
+    auto hole = *found;
+    slots[hole].reset();
+    for (auto slot = next(hole); slots[slot].has_value(); slot = next(slot)) {
+      auto want = home(slots[slot]->key);
+      bool reachable = (hole <= slot) ? (hole < want && want <= slot) : (hole < want || want <= slot);
+      if (!reachable) {
+        slots[hole] = slots[slot];
+        slots[slot].reset();
+        hole = slot;
+      }
     }
   }
-  llc_current_pages_table[index].lru = 0;
-}
-
-uint64_t llc_get_lru_current_pages_entry() {
-  uint64_t lru = LLC_CURRENT_PAGES_TABLE_ENTRIES;
-  for (int i = 0; i < LLC_CURRENT_PAGES_TABLE_ENTRIES; i++) {
-    llc_current_pages_table[i].lru++;
-    if (llc_current_pages_table[i].lru == LLC_CURRENT_PAGES_TABLE_ENTRIES) {
-      llc_current_pages_table[i].lru = 0;
-      lru = i;
-    } 
-  }
-  assert(lru != LLC_CURRENT_PAGES_TABLE_ENTRIES);
-  return lru;
-}
+};
 
-int llc_get_berti_current_pages_table(uint64_t index, uint64_t &ctr) {
-  assert(index < LLC_CURRENT_PAGES_TABLE_ENTRIES);
-  uint64_t max_score = 0;
-  uint64_t berti = 0;
-  for (int i = 0; i < LLC_CURRENT_PAGES_TABLE_NUM_BERTI; i++) {
-    uint64_t score; 
-    score = llc_current_pages_table[index].berti_ctr[i];
-    if (score > max_score) {
-      berti = llc_current_pages_table[index].berti[i];
-      max_score = score;
-      ctr = llc_current_pages_table[index].berti_ctr[i];
+/**
+ * The recency order of a table's entries, kept as a doubly-linked list so that promoting an entry and finding the victim take constant time.
+ */
+class lru_order
+{
+  std::vector<std::size_t> prev, next;
+  std::size_t mru = 0, lru;
+
+public:
+  explicit lru_order(std::size_t entries) : prev(entries), next(entries), lru(entries - 1)
+  {
+    for (std::size_t i = 0; i < entries; ++i) {
+      prev[i] = i - 1;
+      next[i] = i + 1;
     }
   }
-  return berti;
-}
 
-void llc_add_current_pages_table(uint64_t index, uint64_t page_addr, uint64_t ip, uint64_t offset) {
-  assert(index < LLC_CURRENT_PAGES_TABLE_ENTRIES);
-  llc_current_pages_table[index].page_addr = page_addr;
-  llc_current_pages_table[index].ip = ip;
-  llc_current_pages_table[index].u_vector = (uint64_t)1 << offset;
-  llc_current_pages_table[index].first_offset = offset;
-  for (int i = 0; i < LLC_CURRENT_PAGES_TABLE_NUM_BERTI; i++) {
-    llc_current_pages_table[index].berti_ctr[i] = 0;
-  }
-  llc_current_pages_table[index].last_burst = 0;
-}
+  void touch(std::size_t pos)
+  {
+    if (pos == mru)
+      return;
 
-uint64_t llc_update_demand_current_pages_table(uint64_t index, uint64_t offset) {
-  assert(index < LLC_CURRENT_PAGES_TABLE_ENTRIES);
-  llc_current_pages_table[index].u_vector |= (uint64_t)1 << offset;
-  llc_update_lru_current_pages_table(index);
-  return llc_current_pages_table[index].ip;
-}
+    if (pos == lru)
+      lru = prev[pos];
+    else
+      prev[next[pos]] = prev[pos];
+    next[prev[pos]] = next[pos];
 
-void llc_add_berti_current_pages_table(uint64_t index, int berti) {
-  assert(berti != 0);
-  assert(index < LLC_CURRENT_PAGES_TABLE_ENTRIES);
-  for (int i = 0; i < LLC_CURRENT_PAGES_TABLE_NUM_BERTI; i++) {
-    if (llc_current_pages_table[index].berti_ctr[i] == 0) {
-      llc_current_pages_table[index].berti[i] = berti;
-      llc_current_pages_table[index].berti_ctr[i] = 1;
-      break;
-    } else if (llc_current_pages_table[index].berti[i] == berti) {
-      llc_current_pages_table[index].berti_ctr[i]++;
-      break;
-    }
+    next[pos] = mru;
+    prev[mru] = pos;
+    mru = pos;
   }
-  llc_update_lru_current_pages_table(index);
-}
 
-bool llc_requested_offset_current_pages_table(uint64_t index, uint64_t offset) {
-  assert(index < LLC_CURRENT_PAGES_TABLE_ENTRIES);
-  return llc_current_pages_table[index].u_vector & ((uint64_t)1 << offset);
-}
-
-void llc_remove_current_table_entry(uint64_t index) {
-  llc_current_pages_table[index].page_addr = 0;
-  llc_current_pages_table[index].u_vector = 0;
-  llc_current_pages_table[index].berti[0] = 0;
-}
+  // The least recently used entry, which becomes the most recently used
+  std::size_t evict()
+  {
+    auto victim = lru;
+    touch(victim);
+    return victim;
+  }
+};
 
+struct berti {
+  struct current_page_entry {
+    uint64_t id = 0; // distinguishes this page from earlier occupants of the entry
+    uint64_t page_addr = 0;
+    uint64_t ip = 0;
+    uint64_t u_vector = 0;
+    uint64_t first_offset = 0;
+    std::array<int, NUM_BERTI> berti{};
+    std::array<unsigned, NUM_BERTI> berti_ctr{};
+    uint64_t last_burst = 0;
+    uint64_t last_request = 0; // the sequence number of this page's latest entry in the previous requests table, or 0 if none
+
+    bool requested(uint64_t offset) const { return u_vector & (1ull << offset); }
+
+    int best_berti(uint64_t& ctr) const
+    {
+      auto best = std::max_element(std::begin(berti_ctr), std::end(berti_ctr));
+      if (*best == 0)
+        return 0;
+      ctr = *best;
+      return berti[static_cast<std::size_t>(std::distance(std::begin(berti_ctr), best))];
+    }
 
-// PREVIOUS REQUESTS TABLE
+    void add_berti(int delta)
+    {
+      assert(delta != 0);
+      for (std::size_t i = 0; i < NUM_BERTI; ++i) {
+        if (berti_ctr[i] == 0) {
+          berti[i] = delta;
+          berti_ctr[i] = 1;
+          break;
+        } else if (berti[i] == delta) {
+          ++berti_ctr[i];
+          break;
+        }
+      }
+    }
+  };
+
+  // The requests of each page are chained from newest to oldest, so that learning visits only that page's entries
+  struct prev_request_entry {
+    uint64_t page_id = 0;
+    uint64_t offset = 0;
+    uint64_t time = 0;
+    uint64_t seq = 0;      // the entry is at seq modulo the table size until it is overwritten
+    uint64_t prev_seq = 0; // the previous request to the same page, or 0 if none
+  };
+
+  // We do not see the MSHR when a prefetch is issued, so its completion is tracked here
+  struct prev_prefetch_entry {
+    uint64_t page_id = 0;
+    uint64_t offset = 0;
+    uint64_t time_lat = 0; // time if not completed, latency if completed
+    bool completed = false;
+  };
+
+  struct record_page_entry {
+    uint64_t page_addr = 0;
+    uint64_t u_vector = 0;
+    uint64_t first_offset = 0;
+    int berti = 0;
+  };
+
+  struct sizes_type {
+    std::size_t current_pages;
+    std::size_t prev_requests;
+    std::size_t prev_prefetches;
+    std::size_t record_pages;
+    std::size_t ip_table;
+  };
+
+  std::vector<current_page_entry> current_pages;
+  probe_index current_pages_index;
+  lru_order current_pages_lru;
+  uint64_t next_page_id = 1;
+
+  std::vector<prev_request_entry> prev_requests;
+  probe_index prev_requests_index;
+  uint64_t next_request_seq = 1;
+
+  std::vector<prev_prefetch_entry> prev_prefetches;
+  probe_index prev_prefetches_index;
+  std::size_t prev_prefetches_head = 0;
+
+  std::vector<record_page_entry> record_pages;
+  probe_index record_pages_index;      // by page and first offset
+  probe_index record_pages_page_index; // by page, to the latest record of it
+  lru_order record_pages_lru;
+
+  std::vector<std::optional<std::size_t>> ip_table;
+
+  int max_bursts = MAX_NUM_BURST_PREFETCHES; // scaled by the cache's prefetch aggressiveness, if it is controlled
+
+  static uint64_t request_key(uint64_t page_id, uint64_t offset) { return (page_id << PAGE_BLOCKS_BITS) | offset; }
+  static uint64_t record_key(uint64_t page_addr, uint64_t first_offset) { return ((page_addr & TRUNCATED_PAGE_ADDR_MASK) << PAGE_BLOCKS_BITS) | first_offset; }
+  std::optional<std::size_t>& ip_entry(uint64_t ip) { return ip_table[ip % std::size(ip_table)]; }
+
+  explicit berti(const sizes_type& sizes)
+      : current_pages(sizes.current_pages), current_pages_index(sizes.current_pages), current_pages_lru(sizes.current_pages),
+        prev_requests(sizes.prev_requests), prev_requests_index(sizes.prev_requests), prev_prefetches(sizes.prev_prefetches),
+        prev_prefetches_index(sizes.prev_prefetches), record_pages(sizes.record_pages), record_pages_index(sizes.record_pages),
+        record_pages_page_index(sizes.record_pages), record_pages_lru(sizes.record_pages), ip_table(sizes.ip_table)
+  {
+  }
 
-#define LLC_PREV_REQUESTS_TABLE_INDEX_BITS 10
-#define LLC_PREV_REQUESTS_TABLE_ENTRIES ((1 << LLC_PREV_REQUESTS_TABLE_INDEX_BITS) * NUM_CPUS)
-#define LLC_PREV_REQUESTS_TABLE_MASK (LLC_PREV_REQUESTS_TABLE_ENTRIES - 1)
-#define LLC_PREV_REQUESTS_TABLE_NULL_POINTER LLC_CURRENT_PAGES_TABLE_ENTRIES
+  // CURRENT PAGES TABLE
 
-typedef struct __llc_prev_request_entry {
-  uint64_t page_addr_pointer; // 6 bits
-  uint64_t offset; // 6 bits
-  uint64_t time; // 16 bits
-} llc_prev_request_entry;
+  std::optional<std::size_t> find_current_page(uint64_t page_addr) const { return current_pages_index.find(page_addr); }
 
-llc_prev_request_entry llc_prev_requests_table[LLC_PREV_REQUESTS_TABLE_ENTRIES];
-uint64_t llc_prev_requests_table_head;
+  std::size_t add_current_page(uint64_t page_addr, uint64_t ip, uint64_t offset)
+  {
+    auto index = current_pages_lru.evict();
+    auto& entry = current_pages[index];
+    if (entry.u_vector != 0) {
+      record_current_page(entry);
+      current_pages_index.erase(entry.page_addr, index);
+    }
 
-void llc_init_prev_requests_table() {
-  llc_prev_requests_table_head = 0;
-  for (int i = 0; i < LLC_PREV_REQUESTS_TABLE_ENTRIES; i++) {
-    llc_prev_requests_table[i].page_addr_pointer = LLC_PREV_REQUESTS_TABLE_NULL_POINTER;
+    entry = current_page_entry{};
+    entry.id = next_page_id++;
+    entry.page_addr = page_addr;
+    entry.ip = ip;
+    entry.u_vector = 1ull << offset;
+    entry.first_offset = offset;
+    current_pages_index.insert(page_addr, index);
+    return index;
   }
-}
 
-uint64_t llc_find_prev_request_entry(uint64_t pointer, uint64_t offset) {
-  for (int i = 0; i < LLC_PREV_REQUESTS_TABLE_ENTRIES; i++) {
-    if (llc_prev_requests_table[i].page_addr_pointer == pointer
-	&& llc_prev_requests_table[i].offset == offset) return i;
+  void remove_current_page(std::size_t index)
+  {
+    auto& entry = current_pages[index];
+    record_current_page(entry);
+    current_pages_index.erase(entry.page_addr, index);
+    entry.u_vector = 0;
   }
-  return LLC_PREV_REQUESTS_TABLE_ENTRIES;
-}
 
-void llc_add_prev_requests_table(uint64_t pointer, uint64_t offset, uint64_t cycle) {
-  // First find for coalescing
-  if (llc_find_prev_request_entry(pointer, offset) != LLC_PREV_REQUESTS_TABLE_ENTRIES) return;
+  // PREVIOUS REQUESTS TABLE
 
-  // Allocate a new entry (evict old one if necessary)
-  llc_prev_requests_table[llc_prev_requests_table_head].page_addr_pointer = pointer;
-  llc_prev_requests_table[llc_prev_requests_table_head].offset = offset;
-  llc_prev_requests_table[llc_prev_requests_table_head].time = cycle & LLC_TIME_MASK;
-  llc_prev_requests_table_head = (llc_prev_requests_table_head + 1) & LLC_PREV_REQUESTS_TABLE_MASK;
-}
+  void add_prev_request(current_page_entry& page, uint64_t offset, uint64_t cycle)
+  {
+    auto key = request_key(page.id, offset);
+    if (prev_requests_index.find(key).has_value())
+      return;
 
-void llc_reset_pointer_prev_requests(uint64_t pointer) {
-  for (int i = 0; i < LLC_PREV_REQUESTS_TABLE_ENTRIES; i++) {
-    if (llc_prev_requests_table[i].page_addr_pointer == pointer) {
-      llc_prev_requests_table[i].page_addr_pointer = LLC_PREV_REQUESTS_TABLE_NULL_POINTER;
-    }
+    auto head = next_request_seq % std::size(prev_requests);
+    auto& entry = prev_requests[head];
+    prev_requests_index.erase(request_key(entry.page_id, entry.offset), head);
+    entry = {page.id, offset, cycle, next_request_seq, page.last_request};
+    prev_requests_index.insert(key, head);
+    page.last_request = next_request_seq++;
   }
-}
 
-uint64_t llc_get_latency_prev_requests_table(uint64_t pointer, uint64_t offset, uint64_t cycle) {
-  uint64_t index = llc_find_prev_request_entry(pointer, offset); 
-  if (index == LLC_PREV_REQUESTS_TABLE_ENTRIES) return 0;
-  return llc_get_latency(cycle, llc_prev_requests_table[index].time);
-}
+  uint64_t prev_request_latency(const current_page_entry& page, uint64_t offset, uint64_t cycle) const
+  {
+    auto index = prev_requests_index.find(request_key(page.id, offset));
+    if (!index.has_value())
+      return 0;
+    return cycle - prev_requests[*index].time;
+  }
 
-void llc_get_berti_prev_requests_table(uint64_t pointer, uint64_t offset, uint64_t cycle, int *berti) {
-  int my_pos = 0;
-  uint64_t extra_time = 0;
-  uint64_t last_time = llc_prev_requests_table[(llc_prev_requests_table_head + LLC_PREV_REQUESTS_TABLE_MASK) & LLC_PREV_REQUESTS_TABLE_MASK].time;
-  for (uint64_t i = (llc_prev_requests_table_head + LLC_PREV_REQUESTS_TABLE_MASK) & LLC_PREV_REQUESTS_TABLE_MASK; i != llc_prev_requests_table_head; i = (i + LLC_PREV_REQUESTS_TABLE_MASK) & LLC_PREV_REQUESTS_TABLE_MASK) {
-    // Against the time overflow
-    if (last_time < llc_prev_requests_table[i].time) {
-      extra_time = LLC_TIME_OVERFLOW;
-    }
-    last_time = llc_prev_requests_table[i].time;  
-    if (llc_prev_requests_table[i].page_addr_pointer == pointer) {
-      if (llc_prev_requests_table[i].time <= (cycle & LLC_TIME_MASK) + extra_time) {
-	berti[my_pos] = llc_calculate_stride(llc_prev_requests_table[i].offset, offset);
-	my_pos++;
-	if (my_pos == LLC_CURRENT_PAGES_TABLE_NUM_BERTI_PER_ACCESS) return;
+  // The deltas from the most recent requests to this page made no later than the given cycle
+  void learn_berti(std::size_t index, uint64_t offset, uint64_t cycle)
+  {
+    auto& page = current_pages[index];
+    std::size_t found = 0;
+    for (auto seq = page.last_request; seq != 0 && found < NUM_BERTI_PER_ACCESS;) {
+      const auto& entry = prev_requests[seq % std::size(prev_requests)];
+      if (entry.seq != seq)
+        break; // overwritten, and so are all earlier requests
+
+      if (entry.time <= cycle) {
+        auto delta = calculate_stride(entry.offset, offset);
+        if (delta == 0)
+          break;
+        assert(static_cast<uint64_t>(std::abs(delta)) < PAGE_BLOCKS);
+        page.add_berti(delta);
+        ++found;
       }
+      seq = entry.prev_seq;
     }
-  }
-  berti[my_pos] = 0;
-}
 
+    // A page that is still learning is kept, as when it is accessed
+    if (found > 0)
+      current_pages_lru.touch(index);
+  }
 
-// PREVIOUS PREFETCHES TABLE
+  // PREVIOUS PREFETCHES TABLE
 
-#define LLC_PREV_PREFETCHES_TABLE_INDEX_BITS 9
-#define LLC_PREV_PREFETCHES_TABLE_ENTRIES ((1 << LLC_PREV_PREFETCHES_TABLE_INDEX_BITS) * NUM_CPUS)
-#define LLC_PREV_PREFETCHES_TABLE_MASK (LLC_PREV_PREFETCHES_TABLE_ENTRIES - 1)
-#define LLC_PREV_PREFETCHES_TABLE_NULL_POINTER LLC_CURRENT_PAGES_TABLE_ENTRIES
+  void add_prev_prefetch(const current_page_entry& page, uint64_t offset, uint64_t cycle)
+  {
+    auto key = request_key(page.id, offset);
+    if (prev_prefetches_index.find(key).has_value())
+      return;
 
-// We do not have access to the MSHR, so we aproximate it using this structure.
-typedef struct __llc_prev_prefetch_entry {
-  uint64_t page_addr_pointer; // 6 bits
-  uint64_t offset; // 6 bits
-  uint64_t time_lat; // 16 bits // time if not completed, latency if completed
-  bool completed;
-} llc_prev_prefetch_entry;
+    auto& entry = prev_prefetches[prev_prefetches_head];
+    prev_prefetches_index.erase(request_key(entry.page_id, entry.offset), prev_prefetches_head);
+    entry = {page.id, offset, cycle, false};
+    prev_prefetches_index.insert(key, prev_prefetches_head);
+    prev_prefetches_head = (prev_prefetches_head + 1) % std::size(prev_prefetches);
+  }
 
-llc_prev_prefetch_entry llc_prev_prefetches_table[LLC_PREV_PREFETCHES_TABLE_ENTRIES];
-uint64_t llc_prev_prefetches_table_head;
+  void reset_prev_prefetch(const current_page_entry& page, uint64_t offset)
+  {
+    auto key = request_key(page.id, offset);
+    if (auto index = prev_prefetches_index.find(key); index.has_value()) {
+      prev_prefetches_index.erase(key, *index);
+      prev_prefetches[*index].page_id = 0;
+    }
+  }
 
-void llc_init_prev_prefetches_table() {
-  llc_prev_prefetches_table_head = 0;
-  for (int i = 0; i < LLC_PREV_PREFETCHES_TABLE_ENTRIES; i++) {
-    llc_prev_prefetches_table[i].page_addr_pointer = LLC_PREV_PREFETCHES_TABLE_NULL_POINTER;
+  // Mark the prefetch complete. The latency is the one measured by the MSHR, if it was given.
+  uint64_t complete_prev_prefetch(const current_page_entry& page, uint64_t offset, uint64_t cycle, std::optional<uint64_t> fill_latency)
+  {
+    auto index = prev_prefetches_index.find(request_key(page.id, offset));
+    if (!index.has_value())
+      return 0;
+    auto& entry = prev_prefetches[*index];
+    if (!entry.completed) {
+      entry.time_lat = fill_latency.value_or(cycle - entry.time_lat);
+      entry.completed = true;
+    }
+    return entry.time_lat;
   }
-}
 
-uint64_t llc_find_prev_prefetch_entry(uint64_t pointer, uint64_t offset) {
-  for (int i = 0; i < LLC_PREV_PREFETCHES_TABLE_ENTRIES; i++) {
-    if (llc_prev_prefetches_table[i].page_addr_pointer == pointer
-	&& llc_prev_prefetches_table[i].offset == offset) return i;
+  uint64_t prev_prefetch_latency(const current_page_entry& page, uint64_t offset) const
+  {
+    auto index = prev_prefetches_index.find(request_key(page.id, offset));
+    if (!index.has_value() || !prev_prefetches[*index].completed)
+      return 0;
+    return prev_prefetches[*index].time_lat;
   }
-  return LLC_PREV_PREFETCHES_TABLE_ENTRIES;
-}
 
-void llc_add_prev_prefetches_table(uint64_t pointer, uint64_t offset, uint64_t cycle) {
-  // First find for coalescing
-  if (llc_find_prev_prefetch_entry(pointer, offset) != LLC_PREV_PREFETCHES_TABLE_ENTRIES) return;
+  // RECORD PAGES TABLE
 
-  // Allocate a new entry (evict old one if necessary)
-  llc_prev_prefetches_table[llc_prev_prefetches_table_head].page_addr_pointer = pointer;
-  llc_prev_prefetches_table[llc_prev_prefetches_table_head].offset = offset;
-  llc_prev_prefetches_table[llc_prev_prefetches_table_head].time_lat = cycle & LLC_TIME_MASK;
-  llc_prev_prefetches_table[llc_prev_prefetches_table_head].completed = false;
-  llc_prev_prefetches_table_head = (llc_prev_prefetches_table_head + 1) & LLC_PREV_PREFETCHES_TABLE_MASK;
-}
+  std::optional<std::size_t> find_record(uint64_t page_addr, uint64_t first_offset) const { return record_pages_index.find(record_key(page_addr, first_offset)); }
+  std::optional<std::size_t> find_record(uint64_t page_addr) const { return record_pages_page_index.find(page_addr & TRUNCATED_PAGE_ADDR_MASK); }
 
-void llc_reset_pointer_prev_prefetches(uint64_t pointer) {
-  for (int i = 0; i < LLC_PREV_PREFETCHES_TABLE_ENTRIES; i++) {
-    if (llc_prev_prefetches_table[i].page_addr_pointer == pointer) {
-      llc_prev_prefetches_table[i].page_addr_pointer = LLC_PREV_PREFETCHES_TABLE_NULL_POINTER;
-    }
+  void write_record(std::size_t index, const record_page_entry& record)
+  {
+    auto& entry = record_pages[index];
+    record_pages_index.erase(record_key(entry.page_addr, entry.first_offset), index);
+    record_pages_page_index.erase(entry.page_addr, index);
+
+    entry = record;
+    entry.page_addr &= TRUNCATED_PAGE_ADDR_MASK;
+    record_pages_index.insert(record_key(entry.page_addr, entry.first_offset), index);
+    record_pages_page_index.insert(entry.page_addr, index);
+    record_pages_lru.touch(index);
   }
-}
 
-void llc_reset_entry_prev_prefetches_table(uint64_t pointer, uint64_t offset) {
-  uint64_t index = llc_find_prev_prefetch_entry(pointer, offset);
-  if (index != LLC_PREV_PREFETCHES_TABLE_ENTRIES) {
-    llc_prev_prefetches_table[index].page_addr_pointer = LLC_PREV_PREFETCHES_TABLE_NULL_POINTER;
+  // Summarizes the content of the current page to be evicted. From all timely requests found, we record the best.
+  void record_current_page(const current_page_entry& page)
+  {
+    if (page.u_vector == 0)
+      return;
+    auto record_index = ip_entry(page.ip);
+    if (!record_index.has_value())
+      return;
+    uint64_t confidence = 0;
+    write_record(*record_index, {page.page_addr, page.u_vector, page.first_offset, page.best_berti(confidence)});
   }
-}
 
-uint64_t llc_get_and_set_latency_prev_prefetches_table(uint64_t pointer, uint64_t offset, uint64_t cycle) {
-  uint64_t index = llc_find_prev_prefetch_entry(pointer, offset); 
-  if (index == LLC_PREV_PREFETCHES_TABLE_ENTRIES) return 0;
-  if (!llc_prev_prefetches_table[index].completed) {
-    llc_prev_prefetches_table[index].time_lat = llc_get_latency(cycle, llc_prev_prefetches_table[index].time_lat);
-    llc_prev_prefetches_table[index].completed = true;
-  }    
-  return llc_prev_prefetches_table[index].time_lat;
-}
+  // INTERFACE
 
-uint64_t llc_get_latency_prev_prefetches_table(uint64_t pointer, uint64_t offset) {
-  uint64_t index = llc_find_prev_prefetch_entry(pointer, offset);
-  if (index == LLC_PREV_PREFETCHES_TABLE_ENTRIES) return 0;
-  if (!llc_prev_prefetches_table[index].completed) return 0;
-  return llc_prev_prefetches_table[index].time_lat;
-}
+  void operate(CACHE* cache, uint64_t addr, uint64_t ip, bool cache_hit);
+  void fill(CACHE* cache, uint64_t addr, uint64_t evicted_addr);
+};
 
+void berti::operate(CACHE* cache, uint64_t addr, uint64_t ip, bool cache_hit)
+{
+  uint64_t line_addr = addr >> LOG2_BLOCK_SIZE;
+  uint64_t page_addr = line_addr >> PAGE_BLOCKS_BITS;
+  uint64_t offset = line_addr & PAGE_OFFSET_MASK;
 
-// RECORD PAGES TABLE
+  auto index = find_current_page(page_addr);
 
-//#define LLC_RECORD_PAGES_TABLE_INDEX_BITS 8
-#define LLC_RECORD_PAGES_TABLE_ENTRIES ((((1 << 8) + (1 << 7)) * NUM_CPUS) - 1) // Null pointer for ip table
-#define LLC_TRUNCATED_PAGE_ADDR_BITS 32 // 4 bytes
-#define LLC_TRUNCATED_PAGE_ADDR_MASK (((uint64_t)1 << LLC_TRUNCATED_PAGE_ADDR_BITS) -1)
+  // If accessed recently, there is nothing to do
+  if (index.has_value() && current_pages[*index].requested(offset))
+    return;
 
-typedef struct __llc_record_page_entry {
-  uint64_t page_addr; // 4 bytes
-  uint64_t u_vector; // 8 bytes
-  uint64_t first_offset; // 6 bits
-  int berti; // 7 bits
-  uint64_t lru; // 9 bits
-} llc_record_page_entry;
+  if (index.has_value()) {
+    auto& page = current_pages[*index];
+    page.u_vector |= 1ull << offset;
+    current_pages_lru.touch(*index);
 
-llc_record_page_entry llc_record_pages_table[LLC_RECORD_PAGES_TABLE_ENTRIES];
+    // Update berti
+    if (cache_hit) {
+      uint64_t pref_latency = prev_prefetch_latency(page, offset);
+      if (pref_latency != 0) {
+        // Find berti distance from pref_latency cycles before
+        learn_berti(*index, offset, cycles_before(cache->current_cycle, pref_latency));
 
-void llc_init_record_pages_table() {
-  for (int i = 0; i < LLC_RECORD_PAGES_TABLE_ENTRIES; i++) {
-    llc_record_pages_table[i].page_addr = 0;
-    llc_record_pages_table[i].u_vector = 0;
-    llc_record_pages_table[i].lru = i;
-  }
-}
+        // Eliminate a prev prefetch since it has been used
+        reset_prev_prefetch(page, offset);
+      }
+    }
 
-uint64_t llc_get_lru_record_pages_entry() {
-  uint64_t lru = LLC_RECORD_PAGES_TABLE_ENTRIES;
-  for (int i = 0; i < LLC_RECORD_PAGES_TABLE_ENTRIES; i++) {
-    llc_record_pages_table[i].lru++;
-    if (llc_record_pages_table[i].lru == LLC_RECORD_PAGES_TABLE_ENTRIES) {
-      llc_record_pages_table[i].lru = 0;
-      lru = i;
-    } 
+    // Assign same pointer to group IPs
+    if (page.ip != ip)
+      ip_entry(ip) = ip_entry(page.ip);
+  } else {
+    index = add_current_page(page_addr, ip, offset);
+
+    // Set pointer in IP table
+    auto index_record = find_record(page_addr, offset);
+    auto& ip_pointer = ip_entry(ip);
+    if (!ip_pointer.has_value()) {
+      ip_pointer = index_record.has_value() ? *index_record : record_pages_lru.evict();
+    } else if (ip_pointer != index_record) {
+      // If the current IP is valid, but points to another address, we replicate it in another record entry (lru)
+      // such that the recorded page is not deleted when the current entry summarizes
+      auto new_pointer = record_pages_lru.evict();
+      write_record(new_pointer, record_pages[*ip_pointer]);
+      ip_pointer = new_pointer;
+    }
   }
-  assert(lru != LLC_RECORD_PAGES_TABLE_ENTRIES);
-  return lru;
-}
 
-void llc_update_lru_record_pages_table(uint64_t index) {
-  // assert(index < LLC_RECORD_PAGES_TABLE_ENTRIES);
-  for (int i = 0; i < LLC_RECORD_PAGES_TABLE_ENTRIES; i++) {
-    if (llc_record_pages_table[i].lru < llc_record_pages_table[index].lru) { // Found
-      llc_record_pages_table[i].lru++;
-    }
+  auto& page = current_pages[*index];
+  add_prev_request(page, offset, cache->current_cycle);
+
+  // PREDICT
+  uint64_t u_vector = 0;
+  uint64_t first_offset = page.first_offset;
+  int delta = 0;
+  bool recorded = false;
+
+  auto ip_pointer = ip_entry(ip);
+  auto pgo_pointer = find_record(page_addr, first_offset);
+  auto pg_pointer = find_record(page_addr);
+  uint64_t berti_confidence = 0;
+  int current_berti = page.best_berti(berti_confidence);
+  bool match_confidence = false;
+
+  auto covers_page = [&page](const record_page_entry& record) {
+    return (record.u_vector | page.u_vector) == record.u_vector;
+  };
+
+  if (pgo_pointer.has_value() && covers_page(record_pages[*pgo_pointer])) {
+    // If match with current page+first_offset, use record
+    u_vector = record_pages[*pgo_pointer].u_vector;
+    delta = record_pages[*pgo_pointer].berti;
+    match_confidence = true; // High confidence
+    recorded = true;
+  } else if (ip_pointer.has_value() && record_pages[*ip_pointer].first_offset == first_offset && covers_page(record_pages[*ip_pointer])) {
+    // If match with current ip+first_offset, use record
+    u_vector = record_pages[*ip_pointer].u_vector;
+    delta = record_pages[*ip_pointer].berti;
+    match_confidence = true; // High confidence
+    recorded = true;
+  } else if (current_berti != 0 && berti_confidence >= BERTI_CTR_MED_HIGH_CONFIDENCE) {
+    // If no exact match, trust current if it has already a berti (medium-high confidence)
+    u_vector = page.u_vector;
+    delta = current_berti;
+  } else if (pg_pointer.has_value()) {
+    // If match with current page, use record (medium confidence)
+    u_vector = record_pages[*pg_pointer].u_vector;
+    delta = record_pages[*pg_pointer].berti;
+    recorded = true;
+  } else if (ip_pointer.has_value() && record_pages[*ip_pointer].u_vector) {
+    // If match with current ip, use record (medium confidence)
+    u_vector = record_pages[*ip_pointer].u_vector;
+    delta = record_pages[*ip_pointer].berti;
+    recorded = true;
   }
-  llc_record_pages_table[index].lru = 0;
-}
 
-void llc_add_record_pages_table(uint64_t index, uint64_t page_addr, uint64_t vector, uint64_t first_offset, int berti) {
-  // assert(index < LLC_RECORD_PAGES_TABLE_ENTRIES);
-  llc_record_pages_table[index].page_addr = page_addr & LLC_TRUNCATED_PAGE_ADDR_MASK;
-  llc_record_pages_table[index].u_vector = vector;
-  llc_record_pages_table[index].first_offset = first_offset;
-  llc_record_pages_table[index].berti = berti;    
-  llc_update_lru_record_pages_table(index);
-}
+  // Lines predicted without a matching record are the likeliest to go unused, so they should not displace demanded lines
+  auto priority = match_confidence ? champsim::insertion_priority::normal : champsim::insertion_priority::low;
+  auto issue_prefetch = [&, cache](uint64_t pf_line_addr) {
+    bool prefetched = cache->prefetch_line(pf_line_addr << LOG2_BLOCK_SIZE, true, 0, priority);
+    if (prefetched)
+      add_prev_prefetch(page, pf_line_addr & PAGE_OFFSET_MASK, cache->current_cycle);
+    return prefetched;
+  };
+
+  // Burst for the first access of a page or if pending bursts
+  if (first_offset == offset || page.last_burst != 0) {
+    int64_t first_burst;
+    if (page.last_burst != 0) {
+      first_burst = static_cast<int64_t>(page.last_burst);
+      page.last_burst = 0;
+    } else if (delta >= 0) {
+      first_burst = static_cast<int64_t>(offset) + 1;
+    } else {
+      first_burst = static_cast<int64_t>(offset) - 1;
+    }
 
-uint64_t llc_get_entry_record_pages_table(uint64_t page_addr, uint64_t first_offset) {
-  uint64_t trunc_page_addr = page_addr & LLC_TRUNCATED_PAGE_ADDR_MASK;
-  for (int i = 0; i < LLC_RECORD_PAGES_TABLE_ENTRIES; i++) {
-    if (llc_record_pages_table[i].page_addr == trunc_page_addr
-	&& llc_record_pages_table[i].first_offset == first_offset) { // Found
-      return i;
+    if (recorded && match_confidence) {
+      int bursts = 0;
+
+      // Only if previously requested and not demanded. Returns false if the burst must stop here.
+      auto burst = [&, cache](int64_t i) {
+        auto pf_offset = static_cast<uint64_t>(i);
+        if (((1ull << pf_offset) & u_vector) && !page.requested(pf_offset)) {
+          if (cache->get_pq_occupancy().back() >= cache->get_pq_size().back() || bursts >= max_bursts)
+            return false;
+          if (issue_prefetch((page_addr << PAGE_BLOCKS_BITS) | pf_offset))
+            ++bursts;
+        }
+        return true;
+      };
+
+      if (delta > 0) {
+        for (auto i = first_burst; i < static_cast<int64_t>(offset) + delta && i < static_cast<int64_t>(PAGE_BLOCKS); ++i) {
+          if (!burst(i)) { // record last burst
+            page.last_burst = static_cast<uint64_t>(i);
+            break;
+          }
+        }
+      } else if (delta < 0) {
+        for (auto i = first_burst; i > static_cast<int64_t>(offset) + delta && i >= 0; --i) {
+          if (!burst(i)) { // record last burst
+            page.last_burst = static_cast<uint64_t>(i);
+            break;
+          }
+        }
+      } else { // delta == 0 (zig zag of all)
+        for (auto i = first_burst, j = 2 * static_cast<int64_t>(first_offset) - i; i < static_cast<int64_t>(PAGE_BLOCKS) || j >= 0;
+             ++i, j = 2 * static_cast<int64_t>(first_offset) - i) {
+          // Dir ++
+          if (i < static_cast<int64_t>(PAGE_BLOCKS) && !burst(i)) { // record last burst
+            page.last_burst = static_cast<uint64_t>(i);
+            break;
+          }
+          // Dir --, record only positive burst
+          if (j >= 0 && j < static_cast<int64_t>(PAGE_BLOCKS))
+            burst(j);
+        }
+      }
     }
   }
-  return LLC_RECORD_PAGES_TABLE_ENTRIES;
-}
 
-uint64_t llc_get_entry_record_pages_table(uint64_t page_addr) {
-  uint64_t trunc_page_addr = page_addr & LLC_TRUNCATED_PAGE_ADDR_MASK;  
-  for (int i = 0; i < LLC_RECORD_PAGES_TABLE_ENTRIES; i++) {
-    if (llc_record_pages_table[i].page_addr == trunc_page_addr) { // Found
-      return i;
+  if (delta != 0) {
+    uint64_t pf_line_addr = static_cast<uint64_t>(static_cast<int64_t>(line_addr) + delta);
+    uint64_t pf_offset = pf_line_addr & PAGE_OFFSET_MASK;
+    if (!page.requested(pf_offset)                                  // Only prefetch if not demanded
+        && (!match_confidence || ((1ull << pf_offset) & u_vector))) { // And prev. accessed
+      issue_prefetch(pf_line_addr);
     }
   }
-  return LLC_RECORD_PAGES_TABLE_ENTRIES;
-}
-
-void llc_copy_entries_record_pages_table(uint64_t index_from, uint64_t index_to) {
-  assert(index_from < LLC_RECORD_PAGES_TABLE_ENTRIES);
-  assert(index_to < LLC_RECORD_PAGES_TABLE_ENTRIES);
-  llc_record_pages_table[index_to].page_addr = llc_record_pages_table[index_from].page_addr;
-  llc_record_pages_table[index_to].u_vector = llc_record_pages_table[index_from].u_vector;
-  llc_record_pages_table[index_to].first_offset = llc_record_pages_table[index_from].first_offset;
-  llc_record_pages_table[index_to].berti = llc_record_pages_table[index_from].berti;    
-  llc_update_lru_record_pages_table(index_to);
 }
 
+void berti::fill(CACHE* cache, uint64_t addr, uint64_t evicted_addr)
+{
+  uint64_t line_addr = addr >> LOG2_BLOCK_SIZE;
+  uint64_t page_addr = line_addr >> PAGE_BLOCKS_BITS;
+  uint64_t offset = line_addr & PAGE_OFFSET_MASK;
 
-// IP TABLE
+  if (auto index = find_current_page(page_addr); index.has_value()) {
+    auto& page = current_pages[*index];
 
-#define LLC_IP_TABLE_INDEX_BITS 10
-#define LLC_IP_TABLE_ENTRIES ((1 << LLC_IP_TABLE_INDEX_BITS) * NUM_CPUS)
-#define LLC_IP_TABLE_INDEX_MASK (LLC_IP_TABLE_ENTRIES - 1)
-#define LLC_IP_TABLE_NULL_POINTER LLC_RECORD_PAGES_TABLE_ENTRIES
+    // The miss that brings this block is still in the MSHR, which knows when it started
+    std::optional<uint64_t> fill_latency;
+    auto mshr_entry = std::find_if(std::cbegin(cache->MSHR), std::cend(cache->MSHR), [cache, line_addr](const auto& entry) {
+      return ((cache->virtual_prefetch ? entry.v_address : entry.address) >> LOG2_BLOCK_SIZE) == line_addr;
+    });
+    if (mshr_entry != std::cend(cache->MSHR))
+      fill_latency = cache->current_cycle - mshr_entry->cycle_enqueued;
 
-uint64_t llc_ip_table[LLC_IP_TABLE_ENTRIES]; // 9 bits
+    // First look in prefetcher, since if there is a hit, it is the time the miss started
+    // If no prefetch, then its latency is the demand one
+    uint64_t pref_latency = complete_prev_prefetch(page, offset, cache->current_cycle, fill_latency);
+    uint64_t demand_latency = prev_request_latency(page, offset, cache->current_cycle);
+    if (pref_latency == 0)
+      pref_latency = demand_latency;
 
-void llc_init_ip_table() {
-  for (int i = 0; i < LLC_IP_TABLE_ENTRIES; i++) {
-    llc_ip_table[i] = LLC_IP_TABLE_NULL_POINTER;
+    // Find berti (distance from pref_latency + demand_latency cycles before)
+    if (demand_latency != 0)
+      learn_berti(*index, offset, cycles_before(cache->current_cycle, pref_latency + demand_latency));
   }
+
+  if (auto victim = find_current_page(evicted_addr >> LOG2_PAGE_SIZE); victim.has_value())
+    remove_current_page(*victim);
 }
 
+std::map<CACHE*, berti> prefetchers;
 
-// TABLE MOVEMENTS
-
-// Sumarizes the content to the current page to be evicted
-// From all timely requests found, we record the best 
-void llc_record_current_page(uint64_t index_current) {
-  if (llc_current_pages_table[index_current].u_vector) { // Valid entry
-    uint64_t record_index = llc_ip_table[llc_current_pages_table[index_current].ip & LLC_IP_TABLE_INDEX_MASK];
-    // assert(record_index < LLC_RECORD_PAGES_TABLE_ENTRIES);
-    uint64_t confidence;
-    llc_add_record_pages_table(record_index,
-			       llc_current_pages_table[index_current].page_addr,
-			       llc_current_pages_table[index_current].u_vector,
-			       llc_current_pages_table[index_current].first_offset,
-			       llc_get_berti_current_pages_table(index_current, confidence));
-  }
+std::size_t get_size_parameter(const CACHE& cache, const std::string& name, std::size_t default_value)
+{
+  auto value = cache.get_prefetcher_parameter(name, default_value);
+  if (value == 0)
+    throw std::invalid_argument{cache.NAME + ": the Berti parameter " + name + " must be at least 1"};
+  return value;
 }
+} // namespace
 
-// INTERFACE
 void CACHE::prefetcher_cycle_operate() {}
 
-void CACHE::prefetcher_initialize() 
+void CACHE::prefetcher_initialize()
 {
-  cout << "CPU " << cpu << " LLC Berti prefetcher" << endl;
-  
-  llc_init_current_pages_table();
-  llc_init_prev_requests_table();
-  llc_init_prev_prefetches_table();
-  llc_init_record_pages_table();
-  llc_init_ip_table();
+  fmt::print("CPU {} {} Berti prefetcher\n", cpu, NAME);
+  ::berti::sizes_type sizes{::get_size_parameter(*this, "current_pages_table_entries", CURRENT_PAGES_TABLE_ENTRIES),
+                            ::get_size_parameter(*this, "prev_requests_table_entries", PREV_REQUESTS_TABLE_ENTRIES),
+                            ::get_size_parameter(*this, "prev_prefetches_table_entries", PREV_PREFETCHES_TABLE_ENTRIES),
+                            ::get_size_parameter(*this, "record_pages_table_entries", RECORD_PAGES_TABLE_ENTRIES),
+                            ::get_size_parameter(*this, "ip_table_entries", IP_TABLE_ENTRIES)};
+  ::prefetchers.insert_or_assign(this, ::berti{sizes});
 }
 
-uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit,bool useful_prefetch, uint8_t type, uint32_t metadata_in)
+uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, bool useful_prefetch, uint8_t type, uint32_t metadata_in)
 {
-  uint64_t line_addr = addr >> LOG2_BLOCK_SIZE;
-  uint64_t page_addr = line_addr >> LLC_PAGE_BLOCKS_BITS;
-  uint64_t offset = line_addr & LLC_PAGE_OFFSET_MASK;
-
-  // Update current pages table
-  // Find the entry
-  uint64_t index = llc_get_current_pages_entry(page_addr);
-
-  // If not accessed recently
-  if (index == LLC_CURRENT_PAGES_TABLE_ENTRIES
-      || !llc_requested_offset_current_pages_table(index, offset)) {
-        
-    if (index < LLC_CURRENT_PAGES_TABLE_ENTRIES) { // Found
-    
-      // If offset found, already requested, so return;
-      if (llc_requested_offset_current_pages_table(index, offset)) return metadata_in;
-
-      uint64_t first_ip = llc_update_demand_current_pages_table(index, offset);
-      // assert(llc_ip_table[first_ip & LLC_IP_TABLE_INDEX_MASK] != LLC_IP_TABLE_NULL_POINTER);
-
-      // Update berti
-      if (cache_hit) {
-	uint64_t pref_latency = llc_get_latency_prev_prefetches_table(index, offset);
-	if (pref_latency != 0) {
-	  // Find berti distance from pref_latency cycles before
-	  int berti[LLC_CURRENT_PAGES_TABLE_NUM_BERTI_PER_ACCESS]; 
-	  llc_get_berti_prev_requests_table(index, offset, current_core_cycle[cpu] - pref_latency, berti);
-	  for (int i = 0; i < LLC_CURRENT_PAGES_TABLE_NUM_BERTI_PER_ACCESS; i++) {
-	    if (berti[i] == 0) break; 
-	    assert(abs(berti[i]) < LLC_PAGE_BLOCKS);
-	    llc_add_berti_current_pages_table(index, berti[i]);
-	  }
-
-	  // Eliminate a prev prefetch since it has been usedis
-	  llc_reset_entry_prev_prefetches_table(index, offset);
-      	}
-      }
-      
-      if (first_ip != ip) {
-	// Assign same pointer to group IPs
-	llc_ip_table[ip & LLC_IP_TABLE_INDEX_MASK] = llc_ip_table[first_ip & LLC_IP_TABLE_INDEX_MASK]; 
-      }
-    } else { // Not found: Add entry
-     
-      // Find victim and clear pointers to it
-      uint64_t victim_index = llc_get_lru_current_pages_entry(); // already updates lru
-      assert(victim_index < LLC_CURRENT_PAGES_TABLE_ENTRIES);
-      llc_reset_pointer_prev_requests(victim_index); // Not valid anymore
-      llc_reset_pointer_prev_prefetches(victim_index); // Not valid anymore
-
-      // Copy victim to record table
-      llc_record_current_page(victim_index);
-
-      // Add new current page
-      index = victim_index;
-      llc_add_current_pages_table(index, page_addr, ip & LLC_IP_TABLE_INDEX_MASK, offset);
-
-      // Set pointer in IP table
-      uint64_t index_record = llc_get_entry_record_pages_table(page_addr, offset);
-      // The ip pointer is null
-      if (llc_ip_table[ip & LLC_IP_TABLE_INDEX_MASK] == LLC_IP_TABLE_NULL_POINTER) { 
-	if (index_record == LLC_RECORD_PAGES_TABLE_ENTRIES) { // Page not recorded
-	  // Get free record page pointer.
-	  uint64_t new_pointer = llc_get_lru_record_pages_entry();
-	  llc_ip_table[ip & LLC_IP_TABLE_INDEX_MASK] = new_pointer;
-	} else {
-	  llc_ip_table[ip & LLC_IP_TABLE_INDEX_MASK] = index_record;
-	}
-      } else if (llc_ip_table[ip & LLC_IP_TABLE_INDEX_MASK] != index_record) {
-	// If the current IP is valid, but points to another address
-	// we replicate it in another record entry (lru)
-	// such that the recorded page is not deleted when the current entry summarizes
-	uint64_t new_pointer = llc_get_lru_record_pages_entry();
-	llc_copy_entries_record_pages_table(llc_ip_table[ip & LLC_IP_TABLE_INDEX_MASK], new_pointer);
-	llc_ip_table[ip & LLC_IP_TABLE_INDEX_MASK] = new_pointer;
-      }
-    }
-
-    llc_add_prev_requests_table(index, offset, current_core_cycle[cpu]);
-       
-    // PREDICT
-    uint64_t u_vector = 0;
-    uint64_t first_offset = llc_current_pages_table[index].first_offset;
-    int berti = 0;
-    bool recorded = false;
-    
-    uint64_t ip_pointer = llc_ip_table[ip & LLC_IP_TABLE_INDEX_MASK];
-    uint64_t pgo_pointer = llc_get_entry_record_pages_table(page_addr, first_offset);
-    uint64_t pg_pointer = llc_get_entry_record_pages_table(page_addr);
-    uint64_t berti_confidence = 0;
-    int current_berti = llc_get_berti_current_pages_table(index, berti_confidence);
-    uint64_t match_confidence = 0;
-    
-    // If match with current page+first_offset, use record
-    if (pgo_pointer != LLC_RECORD_PAGES_TABLE_ENTRIES
-    	&& (llc_record_pages_table[pgo_pointer].u_vector | llc_current_pages_table[index].u_vector) == llc_record_pages_table[pgo_pointer].u_vector) {
-      u_vector =  llc_record_pages_table[pgo_pointer].u_vector;
-      berti =  llc_record_pages_table[pgo_pointer].berti;
-      match_confidence = 1; // High confidence
-      recorded = true;
-    } else
-    // If match with current ip+first_offset, use record
-    if (llc_record_pages_table[ip_pointer].first_offset == first_offset
-    	&& (llc_record_pages_table[ip_pointer].u_vector | llc_current_pages_table[index].u_vector) == llc_record_pages_table[ip_pointer].u_vector) {
-      u_vector =  llc_record_pages_table[ip_pointer].u_vector;
-      berti =  llc_record_pages_table[ip_pointer].berti;
-      match_confidence = 1; // High confidence
-      recorded = true;
-    } else
-    // If no exact match, trust current if it has already a berti
-    if (current_berti != 0 && berti_confidence >= LLC_BERTI_CTR_MED_HIGH_CONFIDENCE) { // Medium-High confidence
-      u_vector =  llc_current_pages_table[index].u_vector;
-      berti = current_berti;
-    } else
-    // If match with current page, use record
-    if (pg_pointer != LLC_RECORD_PAGES_TABLE_ENTRIES) { // Medium confidence
-      u_vector =  llc_record_pages_table[pg_pointer].u_vector;
-      berti =  llc_record_pages_table[pg_pointer].berti;
-      recorded = true;
-    } else
-    // If match with current ip, use record
-    if (llc_record_pages_table[ip_pointer].u_vector) { // Medium confidence
-      u_vector =  llc_record_pages_table[ip_pointer].u_vector;
-      berti =  llc_record_pages_table[ip_pointer].berti;
-      recorded = true;
-    }
-    
-    // Burst for the first access of a page or if pending bursts
-    if (first_offset == offset || llc_current_pages_table[index].last_burst != 0) {
-      uint64_t first_burst;
-      if (llc_current_pages_table[index].last_burst != 0) {
-	first_burst = llc_current_pages_table[index].last_burst;
-	llc_current_pages_table[index].last_burst = 0;
-      } else if (berti >= 0) {
-	first_burst = offset + 1;
-      }	else {
-	first_burst = offset - 1;
-      }
-      if (recorded && match_confidence) {
-	int bursts = 0;
-	if (berti > 0) {
-	  for (uint64_t i = first_burst; i < offset+berti; i++) {
-	    if (i >= LLC_PAGE_BLOCKS) break; // Stay in the page
-	    // Only if previously requested and not demanded
-	    uint64_t pf_line_addr = (page_addr << LLC_PAGE_BLOCKS_BITS) | i;
-	    uint64_t pf_addr = pf_line_addr << LOG2_BLOCK_SIZE;
-	    uint64_t pf_page_addr = pf_line_addr >> LLC_PAGE_BLOCKS_BITS;
-	    uint64_t pf_offset = pf_line_addr & LLC_PAGE_OFFSET_MASK;
-	    if ((((uint64_t)1 << i) & u_vector)
-		&& !llc_requested_offset_current_pages_table(index, pf_offset)) {
-	      // if (PQ.occupancy < PQ.SIZE && bursts < LLC_MAX_NUM_BURST_PREFETCHES) {
-        if (internal_PQ.size() < PQ_SIZE && bursts < LLC_MAX_NUM_BURST_PREFETCHES){
-		bool prefetched = prefetch_line(ip, addr, pf_addr, FILL_LLC, 0);
-		if (prefetched) {
-		  // assert(pf_page_addr == page_addr);
-		  llc_add_prev_prefetches_table(index, pf_offset, current_core_cycle[cpu]);
-		  bursts++;
-		}
-	      } else { // record last burst
-		llc_current_pages_table[index].last_burst = i;
-		break;
-	      }
-	    }
-	  }
-	} else if (berti < 0) {
-	  for (int i = first_burst; i > ((int)offset)+berti; i--) {
-	    if (i < 0) break; // Stay in the page
-	    // Only if previously requested and not demanded
-	    uint64_t pf_line_addr = (page_addr << LLC_PAGE_BLOCKS_BITS) | i;
-	    uint64_t pf_addr = pf_line_addr << LOG2_BLOCK_SIZE;
-	    uint64_t pf_page_addr = pf_line_addr >> LLC_PAGE_BLOCKS_BITS;
-	    uint64_t pf_offset = pf_line_addr & LLC_PAGE_OFFSET_MASK;
-	    if ((((uint64_t)1 << i) & u_vector)
-		&& !llc_requested_offset_current_pages_table(index, pf_offset)) {
-	      // if (PQ.occupancy < PQ.SIZE && bursts < LLC_MAX_NUM_BURST_PREFETCHES) {
-        if (internal_PQ.size() < PQ_SIZE && bursts < LLC_MAX_NUM_BURST_PREFETCHES){
-		bool prefetched = prefetch_line(ip, addr, pf_addr, FILL_LLC, 0);
-		if (prefetched) {
-		  // assert(pf_page_addr == page_addr);
-		  llc_add_prev_prefetches_table(index, pf_offset, current_core_cycle[cpu]);
-		  bursts++;
-		}
-	      } else { // record last burst
-		llc_current_pages_table[index].last_burst = i;
-		break;
-	      }
-	    }
-	  }
-	} else { // berti == 0 (zig zag of all)
-	  for (int i = first_burst, j = (first_offset << 1) - i;
-	       i < LLC_PAGE_BLOCKS || j >= 0; i++, j = (first_offset << 1) - i) {
-	    // Only if previously requested and not demanded
-	    // Dir ++
-	    uint64_t pf_line_addr = (page_addr << LLC_PAGE_BLOCKS_BITS) | i;
-	    uint64_t pf_addr = pf_line_addr << LOG2_BLOCK_SIZE;
-	    uint64_t pf_page_addr = pf_line_addr >> LLC_PAGE_BLOCKS_BITS;
-	    uint64_t pf_offset = pf_line_addr & LLC_PAGE_OFFSET_MASK;
-	    if ((((uint64_t)1 << i) & u_vector)
-		&& !llc_requested_offset_current_pages_table(index, pf_offset)) {
-	      // if (PQ.occupancy < PQ.SIZE && bursts < LLC_MAX_NUM_BURST_PREFETCHES) {
-        if (internal_PQ.size() < PQ_SIZE && bursts < LLC_MAX_NUM_BURST_PREFETCHES){
-		bool prefetched = prefetch_line(ip, addr, pf_addr, FILL_LLC, 0);
-		if (prefetched) {
-		  // assert(pf_page_addr == page_addr);
-		  llc_add_prev_prefetches_table(index, pf_offset, current_core_cycle[cpu]);
-		  bursts++;
-		}
-	      } else { // record last burst
-		llc_current_pages_table[index].last_burst = i;
-		break;
-	      }
-	    }
-	    // Dir --
-	    pf_line_addr = (page_addr << LLC_PAGE_BLOCKS_BITS) | j;
-	    pf_addr = pf_line_addr << LOG2_BLOCK_SIZE;
-	    pf_page_addr = pf_line_addr >> LLC_PAGE_BLOCKS_BITS;
-	    pf_offset = pf_line_addr & LLC_PAGE_OFFSET_MASK;
-	    if ((((uint64_t)1 << j) & u_vector)
-		&& !llc_requested_offset_current_pages_table(index, pf_offset)) {
-	      // if (PQ.occupancy < PQ.SIZE && bursts < LLC_MAX_NUM_BURST_PREFETCHES) {
-        if (internal_PQ.size() < PQ_SIZE && bursts < LLC_MAX_NUM_BURST_PREFETCHES){
-		bool prefetched = prefetch_line(ip, addr, pf_addr, FILL_LLC, 0);
-		if (prefetched) {
-		  // assert(pf_page_addr == page_addr);
-		  llc_add_prev_prefetches_table(index, pf_offset, current_core_cycle[cpu]);
-		  bursts++;
-		}
-	      } else {
-		// record only positive burst
-	      }
-	    }
-	  }
-	}  
-      } else { // not recorded
-      }	
-    }
-      
-    if (berti != 0) {
-      uint64_t pf_line_addr = line_addr + berti;
-      uint64_t pf_addr = pf_line_addr << LOG2_BLOCK_SIZE;
-      uint64_t pf_page_addr = pf_line_addr >> LLC_PAGE_BLOCKS_BITS;
-      uint64_t pf_offset = pf_line_addr & LLC_PAGE_OFFSET_MASK;
-      if (!llc_requested_offset_current_pages_table(index, pf_offset) // Only prefetch if not demanded
-	  && (!match_confidence || (((uint64_t)1 << pf_offset) & u_vector))) { // And prev. accessed
-	bool prefetched = prefetch_line(ip, addr, pf_addr, FILL_LLC, 0);
-	if (prefetched) {
-	  // assert(pf_page_addr == page_addr);
-	  llc_add_prev_prefetches_table(index, pf_offset, current_core_cycle[cpu]);
-	}
-      }
-    }
-  }
-  
+  ::prefetchers.at(this).operate(this, addr, ip, cache_hit);
   return metadata_in;
 }
 
 uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr, uint32_t metadata_in)
 {
-  uint64_t line_addr = (addr >> LOG2_BLOCK_SIZE);
-  uint64_t page_addr = line_addr >> LLC_PAGE_BLOCKS_BITS;
-  uint64_t offset = line_addr & LLC_PAGE_OFFSET_MASK;
-
-  uint64_t pointer_prev = llc_get_current_pages_entry(page_addr);
-
-  if (pointer_prev < LLC_CURRENT_PAGES_TABLE_ENTRIES) { // Not found, not entry in prev requests
-    uint64_t pref_latency = llc_get_and_set_latency_prev_prefetches_table(pointer_prev, offset, current_core_cycle[cpu]);
-    uint64_t demand_latency = llc_get_latency_prev_requests_table(pointer_prev, offset, current_core_cycle[cpu]);
-    
-    // First look in prefetcher, since if there is a hit, it is the time the miss started
-    // If no prefetch, then its latency is the demand one
-    if (pref_latency == 0) {
-      pref_latency = demand_latency;
-    }     
-    
-    if (demand_latency != 0) { // Not found, berti will not be found neither
-      
-      // Find berti (distance from pref_latency + demand_latency cycles before
-      int berti[LLC_CURRENT_PAGES_TABLE_NUM_BERTI_PER_ACCESS]; 
-      llc_get_berti_prev_requests_table(pointer_prev, offset, current_core_cycle[cpu] - (pref_latency + demand_latency), berti);
-      for (int i = 0; i < LLC_CURRENT_PAGES_TABLE_NUM_BERTI_PER_ACCESS; i++) {
-	if (berti[i] == 0) break;
-	assert(abs(berti[i]) < LLC_PAGE_BLOCKS);
-	llc_add_berti_current_pages_table(pointer_prev, berti[i]);
-      }
-    }
-  }
-
-  uint64_t victim_index = llc_get_current_pages_entry(evicted_addr >> LOG2_PAGE_SIZE);
-  if (victim_index < LLC_CURRENT_PAGES_TABLE_ENTRIES) {
-    // Copy victim to record table
-    llc_record_current_page(victim_index);
-    llc_remove_current_table_entry(victim_index);
-  }
-  
+  ::prefetchers.at(this).fill(this, addr, evicted_addr);
   return metadata_in;
 }
 
-void CACHE::prefetcher_final_stats()
+void CACHE::prefetcher_final_stats() { fmt::print("CPU {} {} Berti prefetcher final stats\n", cpu, NAME); }
+
+void CACHE::prefetcher_aggressiveness_update(unsigned level)
 {
-    cout << "CPU " << cpu << " LLC berti prefetcher final stats" << endl;
-}
\ No newline at end of file
+  ::prefetchers.at(this).max_bursts = champsim::prefetch_feedback::scaled_degree(MAX_NUM_BURST_PREFETCHES, level);
+}
+
+// Berti chooses its deltas by their timeliness, so only the degree is taken
+void CACHE::prefetcher_configuration_update(unsigned degree, unsigned distance) { ::prefetchers.at(this).max_bursts = static_cast<int>(degree); }
@@ -22,12 +22,15 @@ struct tracker {
     uint64_t address = 0;
     int64_t stride = 0;
     int degree = 0; // degree remaining
+    int skip = 0;   // strides to pass over before the next prefetch
   };
 
   constexpr static std::size_t TRACKER_SETS = 256;
   constexpr static std::size_t TRACKER_WAYS = 4;
   constexpr static int PREFETCH_DEGREE = 3;
 
+  int degree = PREFETCH_DEGREE; // scaled by the cache's prefetch aggressiveness, if it is throttled
+  int distance = 1;             // in strides, chosen with the degree by the cache's bandit, if it has one
   std::optional<lookahead_entry> active_lookahead;
 
   champsim::msl::lru_table<tracker_entry> table{TRACKER_SETS, TRACKER_WAYS};
@@ -48,7 +51,7 @@ public:
       // Initialize prefetch state unless we somehow saw the same address twice in
       // a row or if this is the first time we've seen this stride
       if (stride != 0 && stride == found->last_stride)
-        active_lookahead = {cl_addr << LOG2_BLOCK_SIZE, stride, PREFETCH_DEGREE};
+        active_lookahead = {cl_addr << LOG2_BLOCK_SIZE, stride, degree, distance - 1};
     }
 
     // update tracking set
@@ -59,10 +62,10 @@ public:
   {
     // If a lookahead is active
     if (active_lookahead.has_value()) {
-      auto [old_pf_address, stride, degree] = active_lookahead.value();
-      assert(degree > 0);
+      auto [old_pf_address, stride, degree_remaining, skip] = active_lookahead.value();
+      assert(degree_remaining > 0);
 
-      auto addr_delta = stride * BLOCK_SIZE;
+      auto addr_delta = stride * (skip + 1) * BLOCK_SIZE;
       auto pf_address = static_cast<uint64_t>(static_cast<int64_t>(old_pf_address) + addr_delta); // cast to signed to allow negative strides
 
       // If the next step would exceed the degree or run off the page, stop
@@ -70,7 +73,7 @@ public:
         // check the MSHR occupancy to decide if we're going to prefetch to this level or not
         bool success = cache->prefetch_line(pf_address, (cache->get_mshr_occupancy_ratio() < 0.5), 0);
         if (success)
-          active_lookahead = {pf_address, stride, degree - 1};
+          active_lookahead = {pf_address, stride, degree_remaining - 1, 0};
         // If we fail, try again next cycle
 
         if (active_lookahead->degree == 0) {
@@ -102,3 +105,14 @@ uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way,
 }
 
 void CACHE::prefetcher_final_stats() {}
+
+void CACHE::prefetcher_aggressiveness_update(unsigned level)
+{
+  ::trackers[this].degree = champsim::prefetch_feedback::scaled_degree(tracker::PREFETCH_DEGREE, level);
+}
+
+void CACHE::prefetcher_configuration_update(unsigned degree, unsigned distance)
+{
+  ::trackers[this].degree = static_cast<int>(degree);
+  ::trackers[this].distance = static_cast<int>(distance);
+}
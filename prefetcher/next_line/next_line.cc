@@ -1,11 +1,26 @@
+#include <map>
+
 #include "cache.h"
 
-void CACHE::prefetcher_initialize() {}
+namespace
+{
+struct configuration {
+  int degree = 1;   // scaled by the cache's prefetch aggressiveness, if it is controlled
+  int distance = 1; // in lines, chosen with the degree by the cache's bandit, if it has one
+};
+
+std::map<CACHE*, configuration> configurations;
+} // namespace
+
+void CACHE::prefetcher_initialize() { ::configurations.insert_or_assign(this, configuration{}); }
 
 uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, bool useful_prefetch, uint8_t type, uint32_t metadata_in)
 {
-  uint64_t pf_addr = addr + (1 << LOG2_BLOCK_SIZE);
-  prefetch_line(pf_addr, true, metadata_in);
+  auto [degree, distance] = ::configurations.at(this);
+  for (int i = distance; i < distance + degree; ++i) {
+    uint64_t pf_addr = addr + (static_cast<uint64_t>(i) << LOG2_BLOCK_SIZE);
+    prefetch_line(pf_addr, true, metadata_in);
+  }
   return metadata_in;
 }
 
@@ -17,3 +32,13 @@ uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way,
 void CACHE::prefetcher_cycle_operate() {}
 
 void CACHE::prefetcher_final_stats() {}
+
+void CACHE::prefetcher_aggressiveness_update(unsigned level)
+{
+  ::configurations.at(this).degree = champsim::prefetch_feedback::scaled_degree(1, level);
+}
+
+void CACHE::prefetcher_configuration_update(unsigned degree, unsigned distance)
+{
+  ::configurations.at(this) = {static_cast<int>(degree), static_cast<int>(distance)};
+}
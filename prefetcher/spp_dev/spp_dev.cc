@@ -1,54 +1,83 @@
 #include "spp_dev.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <map>
+#include <stdexcept>
 
 #include "cache.h"
 
 namespace
 {
-spp::SIGNATURE_TABLE ST;
-spp::PATTERN_TABLE PT;
-spp::PREFETCH_FILTER FILTER;
-spp::GLOBAL_REGISTER GHR;
+struct spp_dev {
+  spp::GLOBAL_REGISTER GHR;
+  spp::SIGNATURE_TABLE ST;
+  spp::PATTERN_TABLE PT;
+  spp::PREFETCH_FILTER FILTER;
+
+  // Lookahead buffers, reused by every access. The lookahead stops once it holds as many candidates as the cache has MSHRs,
+  // and the buffers have room for the pattern table read that crosses that limit.
+  std::size_t lookahead_limit;
+  std::vector<uint32_t> confidence_q = std::vector<uint32_t>(lookahead_limit + PT.ways + 1);
+  std::vector<int32_t> delta_q = std::vector<int32_t>(lookahead_limit + PT.ways + 1);
+};
+
+std::map<CACHE*, spp_dev> prefetchers;
+
+// Every table needs at least one entry, or the lookups divide by zero and the replacements find no victim
+std::size_t get_size_parameter(const CACHE& cache, const std::string& name, std::size_t default_value)
+{
+  auto value = cache.get_prefetcher_parameter(name, default_value);
+  if (value == 0)
+    throw std::invalid_argument{cache.NAME + ": the SPP parameter " + name + " must be at least 1"};
+  return value;
+}
 } // namespace
 
 void CACHE::prefetcher_initialize()
 {
+  auto st_set = ::get_size_parameter(*this, "st_sets", spp::ST_SET);
+  auto st_way = ::get_size_parameter(*this, "st_ways", spp::ST_WAY);
+  auto pt_set = ::get_size_parameter(*this, "pt_sets", spp::PT_SET);
+  auto pt_way = ::get_size_parameter(*this, "pt_ways", spp::PT_WAY);
+  auto filter_set = ::get_size_parameter(*this, "filter_sets", spp::FILTER_SET);
+  auto ghr_size = ::get_size_parameter(*this, "ghr_size", spp::MAX_GHR_ENTRY);
+
+  ::prefetchers.insert_or_assign(this, spp_dev{spp::GLOBAL_REGISTER{ghr_size}, spp::SIGNATURE_TABLE{st_set, st_way}, spp::PATTERN_TABLE{pt_set, pt_way},
+                                               spp::PREFETCH_FILTER{filter_set}, MSHR_SIZE});
+
   std::cout << "Initialize SIGNATURE TABLE" << std::endl;
-  std::cout << "ST_SET: " << spp::ST_SET << std::endl;
-  std::cout << "ST_WAY: " << spp::ST_WAY << std::endl;
+  std::cout << "ST_SET: " << st_set << std::endl;
+  std::cout << "ST_WAY: " << st_way << std::endl;
   std::cout << "ST_TAG_BIT: " << spp::ST_TAG_BIT << std::endl;
   std::cout << "ST_TAG_MASK: " << std::hex << spp::ST_TAG_MASK << std::dec << std::endl;
 
   std::cout << std::endl << "Initialize PATTERN TABLE" << std::endl;
-  std::cout << "PT_SET: " << spp::PT_SET << std::endl;
-  std::cout << "PT_WAY: " << spp::PT_WAY << std::endl;
+  std::cout << "PT_SET: " << pt_set << std::endl;
+  std::cout << "PT_WAY: " << pt_way << std::endl;
   std::cout << "SIG_DELTA_BIT: " << spp::SIG_DELTA_BIT << std::endl;
   std::cout << "C_SIG_BIT: " << spp::C_SIG_BIT << std::endl;
   std::cout << "C_DELTA_BIT: " << spp::C_DELTA_BIT << std::endl;
 
   std::cout << std::endl << "Initialize PREFETCH FILTER" << std::endl;
-  std::cout << "FILTER_SET: " << spp::FILTER_SET << std::endl;
+  std::cout << "FILTER_SET: " << filter_set << std::endl;
 }
 
 void CACHE::prefetcher_cycle_operate() {}
 
 uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, bool useful_prefetch, uint8_t type, uint32_t metadata_in)
 {
+  auto& [GHR, ST, PT, FILTER, lookahead_limit, confidence_q, delta_q] = ::prefetchers.at(this);
+
   uint64_t page = addr >> LOG2_PAGE_SIZE;
   uint32_t page_offset = (addr >> LOG2_BLOCK_SIZE) & (PAGE_SIZE / BLOCK_SIZE - 1), last_sig = 0, curr_sig = 0, depth = 0;
-  std::vector<uint32_t> confidence_q(MSHR_SIZE);
-
   int32_t delta = 0;
-  std::vector<int32_t> delta_q(MSHR_SIZE);
 
-  for (uint32_t i = 0; i < MSHR_SIZE; i++) {
-    confidence_q[i] = 0;
-    delta_q[i] = 0;
-  }
+  std::fill(std::begin(confidence_q), std::end(confidence_q), 0);
+  std::fill(std::begin(delta_q), std::end(delta_q), 0);
   confidence_q[0] = 100;
-  ::GHR.global_accuracy = ::GHR.pf_issued ? ((100 * ::GHR.pf_useful) / ::GHR.pf_issued) : 0;
+  GHR.global_accuracy = GHR.pf_issued ? ((100 * GHR.pf_useful) / GHR.pf_issued) : 0;
 
   if constexpr (spp::SPP_DEBUG_PRINT) {
     std::cout << std::endl << "[ChampSim] " << __func__ << " addr: " << std::hex << addr << " cache_line: " << (addr >> LOG2_BLOCK_SIZE);
@@ -58,14 +87,14 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
   // Stage 1: Read and update a sig stored in ST
   // last_sig and delta are used to update (sig, delta) correlation in PT
   // curr_sig is used to read prefetch candidates in PT
-  ::ST.read_and_update_sig(page, page_offset, last_sig, curr_sig, delta);
+  ST.read_and_update_sig(page, page_offset, last_sig, curr_sig, delta, GHR);
 
   // Also check the prefetch filter in parallel to update global accuracy counters
-  ::FILTER.check(addr, spp::L2C_DEMAND);
+  FILTER.check(addr, spp::L2C_DEMAND, GHR);
 
   // Stage 2: Update delta patterns stored in PT
   if (last_sig)
-    ::PT.update_pattern(last_sig, delta);
+    PT.update_pattern(last_sig, delta);
 
   // Stage 3: Start prefetching
   uint64_t base_addr = addr;
@@ -73,8 +102,8 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
   uint8_t do_lookahead = 0;
 
   do {
-    uint32_t lookahead_way = spp::PT_WAY;
-    ::PT.read_pattern(curr_sig, delta_q, confidence_q, lookahead_way, lookahead_conf, pf_q_tail, depth);
+    std::size_t lookahead_way = PT.ways;
+    PT.read_pattern(curr_sig, delta_q, confidence_q, lookahead_way, lookahead_conf, pf_q_tail, depth, GHR.global_accuracy);
 
     do_lookahead = 0;
     for (uint32_t i = pf_q_head; i < pf_q_tail; i++) {
@@ -82,17 +111,17 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
         uint64_t pf_addr = (base_addr & ~(BLOCK_SIZE - 1)) + (delta_q[i] << LOG2_BLOCK_SIZE);
 
         if ((addr & ~(PAGE_SIZE - 1)) == (pf_addr & ~(PAGE_SIZE - 1))) { // Prefetch request is in the same physical page
-          if (::FILTER.check(pf_addr, ((confidence_q[i] >= spp::FILL_THRESHOLD) ? spp::SPP_L2C_PREFETCH : spp::SPP_LLC_PREFETCH))) {
+          if (FILTER.check(pf_addr, ((confidence_q[i] >= spp::FILL_THRESHOLD) ? spp::SPP_L2C_PREFETCH : spp::SPP_LLC_PREFETCH), GHR)) {
             prefetch_line(pf_addr, (confidence_q[i] >= spp::FILL_THRESHOLD), 0); // Use addr (not base_addr) to obey the same physical page boundary
 
             if (confidence_q[i] >= spp::FILL_THRESHOLD) {
-              ::GHR.pf_issued++;
-              if (::GHR.pf_issued > spp::GLOBAL_COUNTER_MAX) {
-                ::GHR.pf_issued >>= 1;
-                ::GHR.pf_useful >>= 1;
+              GHR.pf_issued++;
+              if (GHR.pf_issued > spp::GLOBAL_COUNTER_MAX) {
+                GHR.pf_issued >>= 1;
+                GHR.pf_useful >>= 1;
               }
               if constexpr (spp::SPP_DEBUG_PRINT) {
-                std::cout << "[ChampSim] SPP L2 prefetch issued GHR.pf_issued: " << ::GHR.pf_issued << " GHR.pf_useful: " << ::GHR.pf_useful << std::endl;
+                std::cout << "[ChampSim] SPP L2 prefetch issued GHR.pf_issued: " << GHR.pf_issued << " GHR.pf_useful: " << GHR.pf_useful << std::endl;
               }
             }
 
@@ -107,7 +136,7 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
           if constexpr (spp::GHR_ON) {
             // Store this prefetch request in GHR to bootstrap SPP learning when
             // we see a ST miss (i.e., accessing a new page)
-            ::GHR.update_entry(curr_sig, confidence_q[i], (pf_addr >> LOG2_BLOCK_SIZE) & 0x3F, delta_q[i]);
+            GHR.update_entry(curr_sig, confidence_q[i], (pf_addr >> LOG2_BLOCK_SIZE) & 0x3F, delta_q[i]);
           }
         }
 
@@ -117,17 +146,16 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
     }
 
     // Update base_addr and curr_sig
-    if (lookahead_way < spp::PT_WAY) {
-      uint32_t set = spp::get_hash(curr_sig) % spp::PT_SET;
-      base_addr += (::PT.delta[set][lookahead_way] << LOG2_BLOCK_SIZE);
+    if (lookahead_way < PT.ways) {
+      auto lookahead_delta = PT.at(PT.set_of(curr_sig), lookahead_way).delta;
+      base_addr += (lookahead_delta << LOG2_BLOCK_SIZE);
 
       // PT.delta uses a 7-bit sign magnitude representation to generate
       // sig_delta
       // int sig_delta = (PT.delta[set][lookahead_way] < 0) ? ((((-1) *
       // PT.delta[set][lookahead_way]) & 0x3F) + 0x40) :
       // PT.delta[set][lookahead_way];
-      int sig_delta =
-          (::PT.delta[set][lookahead_way] < 0) ? (((-1) * ::PT.delta[set][lookahead_way]) + (1 << (spp::SIG_DELTA_BIT - 1))) : ::PT.delta[set][lookahead_way];
+      int sig_delta = (lookahead_delta < 0) ? (((-1) * lookahead_delta) + (1 << (spp::SIG_DELTA_BIT - 1))) : lookahead_delta;
       curr_sig = ((curr_sig << spp::SIG_SHIFT) ^ sig_delta) & spp::SIG_MASK;
     }
 
@@ -135,7 +163,7 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
       std::cout << "Looping curr_sig: " << std::hex << curr_sig << " base_addr: " << base_addr << std::dec;
       std::cout << " pf_q_head: " << pf_q_head << " pf_q_tail: " << pf_q_tail << " depth: " << depth << std::endl;
     }
-  } while (spp::LOOKAHEAD_ON && do_lookahead);
+  } while (spp::LOOKAHEAD_ON && do_lookahead && pf_q_tail < lookahead_limit);
 
   return metadata_in;
 }
@@ -146,7 +174,8 @@ uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t matc
     if constexpr (spp::SPP_DEBUG_PRINT) {
       std::cout << std::endl;
     }
-    ::FILTER.check(evicted_addr, spp::L2C_EVICT);
+    auto& state = ::prefetchers.at(this);
+    state.FILTER.check(evicted_addr, spp::L2C_EVICT, state.GHR);
   }
 
   return metadata_in;
@@ -176,9 +205,12 @@ uint64_t get_hash(uint64_t key)
 }
 } // namespace spp
 
-void spp::SIGNATURE_TABLE::read_and_update_sig(uint64_t page, uint32_t page_offset, uint32_t& last_sig, uint32_t& curr_sig, int32_t& delta)
+void spp::SIGNATURE_TABLE::read_and_update_sig(uint64_t page, uint32_t page_offset, uint32_t& last_sig, uint32_t& curr_sig, int32_t& delta,
+                                               const GLOBAL_REGISTER& ghr)
 {
-  uint32_t set = get_hash(page) % ST_SET, match = ST_WAY, partial_page = page & ST_TAG_MASK;
+  std::size_t set = get_hash(page) % sets, match = ways;
+  uint32_t partial_page = page & ST_TAG_MASK;
+  auto* row = &entries[set * ways];
   uint8_t ST_hit = 0;
   int sig_delta = 0;
 
@@ -187,23 +219,23 @@ void spp::SIGNATURE_TABLE::read_and_update_sig(uint64_t page, uint32_t page_offs
   }
 
   // Case 2: Invalid
-  if (match == ST_WAY) {
-    for (match = 0; match < ST_WAY; match++) {
-      if (valid[set][match] && (tag[set][match] == partial_page)) {
-        last_sig = sig[set][match];
-        delta = page_offset - last_offset[set][match];
+  if (match == ways) {
+    for (match = 0; match < ways; match++) {
+      if (row[match].valid && (row[match].tag == partial_page)) {
+        last_sig = row[match].sig;
+        delta = page_offset - row[match].last_offset;
 
         if (delta) {
           // Build a new sig based on 7-bit sign magnitude representation of delta
           // sig_delta = (delta < 0) ? ((((-1) * delta) & 0x3F) + 0x40) : delta;
           sig_delta = (delta < 0) ? (((-1) * delta) + (1 << (spp::SIG_DELTA_BIT - 1))) : delta;
-          sig[set][match] = ((last_sig << spp::SIG_SHIFT) ^ sig_delta) & spp::SIG_MASK;
-          curr_sig = sig[set][match];
-          last_offset[set][match] = page_offset;
+          row[match].sig = ((last_sig << spp::SIG_SHIFT) ^ sig_delta) & spp::SIG_MASK;
+          curr_sig = row[match].sig;
+          row[match].last_offset = page_offset;
 
           if constexpr (spp::SPP_DEBUG_PRINT) {
             std::cout << "[ST] " << __func__ << " hit set: " << set << " way: " << match;
-            std::cout << " valid: " << valid[set][match] << " tag: " << std::hex << tag[set][match];
+            std::cout << " valid: " << row[match].valid << " tag: " << std::hex << row[match].tag;
             std::cout << " last_sig: " << last_sig << " curr_sig: " << curr_sig;
             std::cout << " delta: " << std::dec << delta << " last_offset: " << page_offset << std::endl;
           }
@@ -217,19 +249,19 @@ void spp::SIGNATURE_TABLE::read_and_update_sig(uint64_t page, uint32_t page_offs
   }
 
   // Case 2: Invalid
-  if (match == ST_WAY) {
-    for (match = 0; match < ST_WAY; match++) {
-      if (valid[set][match] == 0) {
-        valid[set][match] = 1;
-        tag[set][match] = partial_page;
-        sig[set][match] = 0;
-        curr_sig = sig[set][match];
-        last_offset[set][match] = page_offset;
+  if (match == ways) {
+    for (match = 0; match < ways; match++) {
+      if (row[match].valid == 0) {
+        row[match].valid = 1;
+        row[match].tag = partial_page;
+        row[match].sig = 0;
+        curr_sig = row[match].sig;
+        row[match].last_offset = page_offset;
 
         if constexpr (spp::SPP_DEBUG_PRINT) {
           std::cout << "[ST] " << __func__ << " invalid set: " << set << " way: " << match;
-          std::cout << " valid: " << valid[set][match] << " tag: " << std::hex << partial_page;
-          std::cout << " sig: " << sig[set][match] << " last_offset: " << std::dec << page_offset << std::endl;
+          std::cout << " valid: " << row[match].valid << " tag: " << std::hex << partial_page;
+          std::cout << " sig: " << row[match].sig << " last_offset: " << std::dec << page_offset << std::endl;
         }
 
         break;
@@ -239,18 +271,18 @@ void spp::SIGNATURE_TABLE::read_and_update_sig(uint64_t page, uint32_t page_offs
 
   if constexpr (SPP_SANITY_CHECK) {
     // Assertion
-    if (match == ST_WAY) {
-      for (match = 0; match < ST_WAY; match++) {
-        if (lru[set][match] == ST_WAY - 1) { // Find replacement victim
-          tag[set][match] = partial_page;
-          sig[set][match] = 0;
-          curr_sig = sig[set][match];
-          last_offset[set][match] = page_offset;
+    if (match == ways) {
+      for (match = 0; match < ways; match++) {
+        if (row[match].lru == ways - 1) { // Find replacement victim
+          row[match].tag = partial_page;
+          row[match].sig = 0;
+          curr_sig = row[match].sig;
+          row[match].last_offset = page_offset;
 
           if constexpr (spp::SPP_DEBUG_PRINT) {
             std::cout << "[ST] " << __func__ << " miss set: " << set << " way: " << match;
-            std::cout << " valid: " << valid[set][match] << " victim tag: " << std::hex << tag[set][match] << " new tag: " << partial_page;
-            std::cout << " sig: " << sig[set][match] << " last_offset: " << std::dec << page_offset << std::endl;
+            std::cout << " valid: " << row[match].valid << " victim tag: " << std::hex << row[match].tag << " new tag: " << partial_page;
+            std::cout << " sig: " << row[match].sig << " last_offset: " << std::dec << page_offset << std::endl;
           }
 
           break;
@@ -258,7 +290,7 @@ void spp::SIGNATURE_TABLE::read_and_update_sig(uint64_t page, uint32_t page_offs
       }
 
       // Assertion
-      if (match == ST_WAY) {
+      if (match == ways) {
         std::cout << "[ST] Cannot find a replacement victim!" << std::endl;
         assert(0);
       }
@@ -267,52 +299,54 @@ void spp::SIGNATURE_TABLE::read_and_update_sig(uint64_t page, uint32_t page_offs
 
   if constexpr (spp::GHR_ON) {
     if (ST_hit == 0) {
-      uint32_t GHR_found = ::GHR.check_entry(page_offset);
-      if (GHR_found < MAX_GHR_ENTRY) {
-        sig_delta = (::GHR.delta[GHR_found] < 0) ? (((-1) * ::GHR.delta[GHR_found]) + (1 << (spp::SIG_DELTA_BIT - 1))) : ::GHR.delta[GHR_found];
-        sig[set][match] = ((::GHR.sig[GHR_found] << spp::SIG_SHIFT) ^ sig_delta) & spp::SIG_MASK;
-        curr_sig = sig[set][match];
+      auto GHR_found = ghr.check_entry(page_offset);
+      if (GHR_found < std::size(ghr.entries)) {
+        auto& found = ghr.entries[GHR_found];
+        sig_delta = (found.delta < 0) ? (((-1) * found.delta) + (1 << (spp::SIG_DELTA_BIT - 1))) : found.delta;
+        row[match].sig = ((found.sig << spp::SIG_SHIFT) ^ sig_delta) & spp::SIG_MASK;
+        curr_sig = row[match].sig;
       }
     }
   }
 
   // Update LRU
-  for (uint32_t way = 0; way < ST_WAY; way++) {
-    if (lru[set][way] < lru[set][match]) {
-      lru[set][way]++;
+  for (std::size_t way = 0; way < ways; way++) {
+    if (row[way].lru < row[match].lru) {
+      row[way].lru++;
 
       if constexpr (SPP_SANITY_CHECK) {
         // Assertion
-        if (lru[set][way] >= ST_WAY) {
-          std::cout << "[ST] LRU value is wrong! set: " << set << " way: " << way << " lru: " << lru[set][way] << std::endl;
+        if (row[way].lru >= ways) {
+          std::cout << "[ST] LRU value is wrong! set: " << set << " way: " << way << " lru: " << row[way].lru << std::endl;
           assert(0);
         }
       }
     }
   }
 
-  lru[set][match] = 0; // Promote to the MRU position
+  row[match].lru = 0; // Promote to the MRU position
 }
 
 void spp::PATTERN_TABLE::update_pattern(uint32_t last_sig, int curr_delta)
 {
   // Update (sig, delta) correlation
-  uint32_t set = get_hash(last_sig) % spp::PT_SET, match = 0;
+  std::size_t set = set_of(last_sig), match = 0;
+  auto* row = &entries[set * ways];
 
   // Case 1: Hit
-  for (match = 0; match < spp::PT_WAY; match++) {
-    if (delta[set][match] == curr_delta) {
-      c_delta[set][match]++;
+  for (match = 0; match < ways; match++) {
+    if (row[match].delta == curr_delta) {
+      row[match].c_delta++;
       c_sig[set]++;
       if (c_sig[set] > C_SIG_MAX) {
-        for (uint32_t way = 0; way < spp::PT_WAY; way++)
-          c_delta[set][way] >>= 1;
+        for (std::size_t way = 0; way < ways; way++)
+          row[way].c_delta >>= 1;
         c_sig[set] >>= 1;
       }
 
       if constexpr (spp::SPP_DEBUG_PRINT) {
         std::cout << "[PT] " << __func__ << " hit sig: " << std::hex << last_sig << std::dec << " set: " << set << " way: " << match;
-        std::cout << " delta: " << delta[set][match] << " c_delta: " << c_delta[set][match] << " c_sig: " << c_sig[set] << std::endl;
+        std::cout << " delta: " << row[match].delta << " c_delta: " << row[match].c_delta << " c_sig: " << c_sig[set] << std::endl;
       }
 
       break;
@@ -320,33 +354,34 @@ void spp::PATTERN_TABLE::update_pattern(uint32_t last_sig, int curr_delta)
   }
 
   // Case 2: Miss
-  if (match == spp::PT_WAY) {
-    uint32_t victim_way = spp::PT_WAY, min_counter = C_SIG_MAX;
+  if (match == ways) {
+    std::size_t victim_way = ways;
+    uint32_t min_counter = C_SIG_MAX;
 
-    for (match = 0; match < spp::PT_WAY; match++) {
-      if (c_delta[set][match] < min_counter) { // Select an entry with the minimum c_delta
+    for (match = 0; match < ways; match++) {
+      if (row[match].c_delta < min_counter) { // Select an entry with the minimum c_delta
         victim_way = match;
-        min_counter = c_delta[set][match];
+        min_counter = row[match].c_delta;
       }
     }
 
-    delta[set][victim_way] = curr_delta;
-    c_delta[set][victim_way] = 0;
+    row[victim_way].delta = curr_delta;
+    row[victim_way].c_delta = 0;
     c_sig[set]++;
     if (c_sig[set] > C_SIG_MAX) {
-      for (uint32_t way = 0; way < spp::PT_WAY; way++)
-        c_delta[set][way] >>= 1;
+      for (std::size_t way = 0; way < ways; way++)
+        row[way].c_delta >>= 1;
       c_sig[set] >>= 1;
     }
 
     if constexpr (spp::SPP_DEBUG_PRINT) {
       std::cout << "[PT] " << __func__ << " miss sig: " << std::hex << last_sig << std::dec << " set: " << set << " way: " << victim_way;
-      std::cout << " delta: " << delta[set][victim_way] << " c_delta: " << c_delta[set][victim_way] << " c_sig: " << c_sig[set] << std::endl;
+      std::cout << " delta: " << row[victim_way].delta << " c_delta: " << row[victim_way].c_delta << " c_sig: " << c_sig[set] << std::endl;
     }
 
     if constexpr (SPP_SANITY_CHECK) {
       // Assertion
-      if (victim_way == spp::PT_WAY) {
+      if (victim_way == ways) {
         std::cout << "[PT] Cannot find a replacement victim!" << std::endl;
         assert(0);
       }
@@ -354,20 +389,22 @@ void spp::PATTERN_TABLE::update_pattern(uint32_t last_sig, int curr_delta)
   }
 }
 
-void spp::PATTERN_TABLE::read_pattern(uint32_t curr_sig, std::vector<int>& delta_q, std::vector<uint32_t>& confidence_q, uint32_t& lookahead_way,
-                                      uint32_t& lookahead_conf, uint32_t& pf_q_tail, uint32_t& depth)
+void spp::PATTERN_TABLE::read_pattern(uint32_t curr_sig, std::vector<int>& delta_q, std::vector<uint32_t>& confidence_q, std::size_t& lookahead_way,
+                                      uint32_t& lookahead_conf, uint32_t& pf_q_tail, uint32_t& depth, uint32_t global_accuracy)
 {
   // Update (sig, delta) correlation
-  uint32_t set = get_hash(curr_sig) % spp::PT_SET, local_conf = 0, pf_conf = 0, max_conf = 0;
+  std::size_t set = set_of(curr_sig);
+  auto* row = &entries[set * ways];
+  uint32_t local_conf = 0, pf_conf = 0, max_conf = 0;
 
   if (c_sig[set]) {
-    for (uint32_t way = 0; way < spp::PT_WAY; way++) {
-      local_conf = (100 * c_delta[set][way]) / c_sig[set];
-      pf_conf = depth ? (::GHR.global_accuracy * c_delta[set][way] / c_sig[set] * lookahead_conf / 100) : local_conf;
+    for (std::size_t way = 0; way < ways; way++) {
+      local_conf = (100 * row[way].c_delta) / c_sig[set];
+      pf_conf = depth ? (global_accuracy * row[way].c_delta / c_sig[set] * lookahead_conf / 100) : local_conf;
 
       if (pf_conf >= PF_THRESHOLD) {
         confidence_q[pf_q_tail] = pf_conf;
-        delta_q[pf_q_tail] = delta[set][way];
+        delta_q[pf_q_tail] = row[way].delta;
 
         // Lookahead path follows the most confident entry
         if (pf_conf > max_conf) {
@@ -378,13 +415,13 @@ void spp::PATTERN_TABLE::read_pattern(uint32_t curr_sig, std::vector<int>& delta
 
         if constexpr (spp::SPP_DEBUG_PRINT) {
           std::cout << "[PT] " << __func__ << " HIGH CONF: " << pf_conf << " sig: " << std::hex << curr_sig << std::dec << " set: " << set << " way: " << way;
-          std::cout << " delta: " << delta[set][way] << " c_delta: " << c_delta[set][way] << " c_sig: " << c_sig[set];
+          std::cout << " delta: " << row[way].delta << " c_delta: " << row[way].c_delta << " c_sig: " << c_sig[set];
           std::cout << " conf: " << local_conf << " depth: " << depth << std::endl;
         }
       } else {
         if constexpr (spp::SPP_DEBUG_PRINT) {
           std::cout << "[PT] " << __func__ << "  LOW CONF: " << pf_conf << " sig: " << std::hex << curr_sig << std::dec << " set: " << set << " way: " << way;
-          std::cout << " delta: " << delta[set][way] << " c_delta: " << c_delta[set][way] << " c_sig: " << c_sig[set];
+          std::cout << " delta: " << row[way].delta << " c_delta: " << row[way].c_delta << " c_sig: " << c_sig[set];
           std::cout << " conf: " << local_conf << " depth: " << depth << std::endl;
         }
       }
@@ -396,17 +433,18 @@ void spp::PATTERN_TABLE::read_pattern(uint32_t curr_sig, std::vector<int>& delta
       depth++;
 
     if constexpr (spp::SPP_DEBUG_PRINT) {
-      std::cout << "global_accuracy: " << ::GHR.global_accuracy << " lookahead_conf: " << lookahead_conf << std::endl;
+      std::cout << "global_accuracy: " << global_accuracy << " lookahead_conf: " << lookahead_conf << std::endl;
     }
   } else {
     confidence_q[pf_q_tail] = 0;
   }
 }
 
-bool spp::PREFETCH_FILTER::check(uint64_t check_addr, FILTER_REQUEST filter_request)
+bool spp::PREFETCH_FILTER::check(uint64_t check_addr, FILTER_REQUEST filter_request, GLOBAL_REGISTER& ghr)
 {
-  uint64_t cache_line = check_addr >> LOG2_BLOCK_SIZE, hash = get_hash(cache_line), quotient = (hash >> REMAINDER_BIT) & ((1 << QUOTIENT_BIT) - 1),
+  uint64_t cache_line = check_addr >> LOG2_BLOCK_SIZE, hash = get_hash(cache_line), quotient = (hash >> REMAINDER_BIT) % std::size(entries),
            remainder = hash % (1 << REMAINDER_BIT);
+  auto& slot = entries[quotient];
 
   if constexpr (spp::SPP_DEBUG_PRINT) {
     std::cout << "[FILTER] check_addr: " << std::hex << check_addr << " check_cache_line: " << (check_addr >> LOG2_BLOCK_SIZE);
@@ -415,33 +453,33 @@ bool spp::PREFETCH_FILTER::check(uint64_t check_addr, FILTER_REQUEST filter_requ
 
   switch (filter_request) {
   case spp::SPP_L2C_PREFETCH:
-    if ((valid[quotient] || useful[quotient]) && remainder_tag[quotient] == remainder) {
+    if ((slot.valid || slot.useful) && slot.remainder_tag == remainder) {
       if constexpr (spp::SPP_DEBUG_PRINT) {
         std::cout << "[FILTER] " << __func__ << " line is already in the filter check_addr: " << std::hex << check_addr << " cache_line: " << cache_line
                   << std::dec;
-        std::cout << " quotient: " << quotient << " valid: " << valid[quotient] << " useful: " << useful[quotient] << std::endl;
+        std::cout << " quotient: " << quotient << " valid: " << slot.valid << " useful: " << slot.useful << std::endl;
       }
 
       return false; // False return indicates "Do not prefetch"
     } else {
-      valid[quotient] = 1;  // Mark as prefetched
-      useful[quotient] = 0; // Reset useful bit
-      remainder_tag[quotient] = remainder;
+      slot.valid = 1;  // Mark as prefetched
+      slot.useful = 0; // Reset useful bit
+      slot.remainder_tag = remainder;
 
       if constexpr (spp::SPP_DEBUG_PRINT) {
         std::cout << "[FILTER] " << __func__ << " set valid for check_addr: " << std::hex << check_addr << " cache_line: " << cache_line << std::dec;
-        std::cout << " quotient: " << quotient << " remainder_tag: " << remainder_tag[quotient] << " valid: " << valid[quotient]
-                  << " useful: " << useful[quotient] << std::endl;
+        std::cout << " quotient: " << quotient << " remainder_tag: " << slot.remainder_tag << " valid: " << slot.valid
+                  << " useful: " << slot.useful << std::endl;
       }
     }
     break;
 
   case spp::SPP_LLC_PREFETCH:
-    if ((valid[quotient] || useful[quotient]) && remainder_tag[quotient] == remainder) {
+    if ((slot.valid || slot.useful) && slot.remainder_tag == remainder) {
       if constexpr (spp::SPP_DEBUG_PRINT) {
         std::cout << "[FILTER] " << __func__ << " line is already in the filter check_addr: " << std::hex << check_addr << " cache_line: " << cache_line
                   << std::dec;
-        std::cout << " quotient: " << quotient << " valid: " << valid[quotient] << " useful: " << useful[quotient] << std::endl;
+        std::cout << " quotient: " << quotient << " valid: " << slot.valid << " useful: " << slot.useful << std::endl;
       }
 
       return false; // False return indicates "Do not prefetch"
@@ -452,39 +490,39 @@ bool spp::PREFETCH_FILTER::check(uint64_t check_addr, FILTER_REQUEST filter_requ
       // we can get this cache line immediately from the LLC (not from DRAM)
       // To allow this fast prefetch from LLC, SPP does not set the valid bit for SPP_LLC_PREFETCH
 
-      // valid[quotient] = 1;
-      // useful[quotient] = 0;
+      // slot.valid = 1;
+      // slot.useful = 0;
 
       if constexpr (spp::SPP_DEBUG_PRINT) {
         std::cout << "[FILTER] " << __func__ << " don't set valid for check_addr: " << std::hex << check_addr << " cache_line: " << cache_line << std::dec;
-        std::cout << " quotient: " << quotient << " valid: " << valid[quotient] << " useful: " << useful[quotient] << std::endl;
+        std::cout << " quotient: " << quotient << " valid: " << slot.valid << " useful: " << slot.useful << std::endl;
       }
     }
     break;
 
   case spp::L2C_DEMAND:
-    if ((remainder_tag[quotient] == remainder) && (useful[quotient] == 0)) {
-      useful[quotient] = 1;
-      if (valid[quotient])
-        ::GHR.pf_useful++; // This cache line was prefetched by SPP and actually used in the program
+    if ((slot.remainder_tag == remainder) && (slot.useful == 0)) {
+      slot.useful = 1;
+      if (slot.valid)
+        ghr.pf_useful++; // This cache line was prefetched by SPP and actually used in the program
 
       if constexpr (spp::SPP_DEBUG_PRINT) {
         std::cout << "[FILTER] " << __func__ << " set useful for check_addr: " << std::hex << check_addr << " cache_line: " << cache_line << std::dec;
-        std::cout << " quotient: " << quotient << " valid: " << valid[quotient] << " useful: " << useful[quotient];
-        std::cout << " GHR.pf_issued: " << ::GHR.pf_issued << " GHR.pf_useful: " << ::GHR.pf_useful << std::endl;
+        std::cout << " quotient: " << quotient << " valid: " << slot.valid << " useful: " << slot.useful;
+        std::cout << " GHR.pf_issued: " << ghr.pf_issued << " GHR.pf_useful: " << ghr.pf_useful << std::endl;
       }
     }
     break;
 
   case spp::L2C_EVICT:
     // Decrease global pf_useful counter when there is a useless prefetch (prefetched but not used)
-    if (valid[quotient] && !useful[quotient] && ::GHR.pf_useful)
-      ::GHR.pf_useful--;
+    if (slot.valid && !slot.useful && ghr.pf_useful)
+      ghr.pf_useful--;
 
     // Reset filter entry
-    valid[quotient] = 0;
-    useful[quotient] = 0;
-    remainder_tag[quotient] = 0;
+    slot.valid = 0;
+    slot.useful = 0;
+    slot.remainder_tag = 0;
     break;
 
   default:
@@ -500,22 +538,23 @@ void spp::GLOBAL_REGISTER::update_entry(uint32_t pf_sig, uint32_t pf_confidence,
 {
   // NOTE: GHR implementation is slightly different from the original paper
   // Instead of matching (last_offset + delta), GHR simply stores and matches the pf_offset
-  uint32_t min_conf = 100, victim_way = MAX_GHR_ENTRY;
+  uint32_t min_conf = 100;
+  std::size_t victim_way = std::size(entries);
 
   if constexpr (spp::SPP_DEBUG_PRINT) {
     std::cout << "[GHR] Crossing the page boundary pf_sig: " << std::hex << pf_sig << std::dec;
     std::cout << " confidence: " << pf_confidence << " pf_offset: " << pf_offset << " pf_delta: " << pf_delta << std::endl;
   }
 
-  for (uint32_t i = 0; i < MAX_GHR_ENTRY; i++) {
-    // if (sig[i] == pf_sig) { // TODO: Which one is better and consistent?
+  for (std::size_t i = 0; i < std::size(entries); i++) {
+    // if (entries[i].sig == pf_sig) { // TODO: Which one is better and consistent?
     //  If GHR already holds the same pf_sig, update the GHR entry with the latest info
-    if (valid[i] && (offset[i] == pf_offset)) {
+    if (entries[i].valid && (entries[i].offset == pf_offset)) {
       // If GHR already holds the same pf_offset, update the GHR entry with the latest info
-      sig[i] = pf_sig;
-      confidence[i] = pf_confidence;
-      // offset[i] = pf_offset;
-      delta[i] = pf_delta;
+      entries[i].sig = pf_sig;
+      entries[i].confidence = pf_confidence;
+      // entries[i].offset = pf_offset;
+      entries[i].delta = pf_delta;
 
       if constexpr (spp::SPP_DEBUG_PRINT) {
         std::cout << "[GHR] Found a matching index: " << i << std::endl;
@@ -526,37 +565,39 @@ void spp::GLOBAL_REGISTER::update_entry(uint32_t pf_sig, uint32_t pf_confidence,
 
     // GHR replacement policy is based on the stored confidence value
     // An entry with the lowest confidence is selected as a victim
-    if (confidence[i] < min_conf) {
-      min_conf = confidence[i];
+    if (entries[i].confidence < min_conf) {
+      min_conf = entries[i].confidence;
       victim_way = i;
     }
   }
 
   // Assertion
-  if (victim_way >= MAX_GHR_ENTRY) {
+  if (victim_way >= std::size(entries)) {
     std::cout << "[GHR] Cannot find a replacement victim!" << std::endl;
     assert(0);
   }
 
   if constexpr (spp::SPP_DEBUG_PRINT) {
-    std::cout << "[GHR] Replace index: " << victim_way << " pf_sig: " << std::hex << sig[victim_way] << std::dec;
-    std::cout << " confidence: " << confidence[victim_way] << " pf_offset: " << offset[victim_way] << " pf_delta: " << delta[victim_way] << std::endl;
+    std::cout << "[GHR] Replace index: " << victim_way << " pf_sig: " << std::hex << entries[victim_way].sig << std::dec;
+    std::cout << " confidence: " << entries[victim_way].confidence << " pf_offset: " << entries[victim_way].offset;
+    std::cout << " pf_delta: " << entries[victim_way].delta << std::endl;
   }
 
-  valid[victim_way] = 1;
-  sig[victim_way] = pf_sig;
-  confidence[victim_way] = pf_confidence;
-  offset[victim_way] = pf_offset;
-  delta[victim_way] = pf_delta;
+  entries[victim_way].valid = 1;
+  entries[victim_way].sig = pf_sig;
+  entries[victim_way].confidence = pf_confidence;
+  entries[victim_way].offset = pf_offset;
+  entries[victim_way].delta = pf_delta;
 }
 
-uint32_t spp::GLOBAL_REGISTER::check_entry(uint32_t page_offset)
+std::size_t spp::GLOBAL_REGISTER::check_entry(uint32_t page_offset) const
 {
-  uint32_t max_conf = 0, max_conf_way = MAX_GHR_ENTRY;
+  uint32_t max_conf = 0;
+  std::size_t max_conf_way = std::size(entries);
 
-  for (uint32_t i = 0; i < MAX_GHR_ENTRY; i++) {
-    if ((offset[i] == page_offset) && (max_conf < confidence[i])) {
-      max_conf = confidence[i];
+  for (std::size_t i = 0; i < std::size(entries); i++) {
+    if ((entries[i].offset == page_offset) && (max_conf < entries[i].confidence)) {
+      max_conf = entries[i].confidence;
       max_conf_way = i;
     }
   }
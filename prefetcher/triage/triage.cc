@@ -0,0 +1,153 @@
+// A temporal prefetcher in the style of Triage (Wu et al., MICRO 2019), for irregular streams such as embedding-table gathers,
+// where consecutive misses of one instruction follow a recurring but non-spatial sequence of lines.
+//
+// A training unit remembers the last line each IP missed on. When the IP misses again, the pair (previous line, this line) is recorded in a
+// metadata store held in a dedicated on-chip budget. On each access, the prefetcher follows the chain of recorded successors up to the
+// lookahead depth.
+
+#include <map>
+#include <stdexcept>
+#include <fmt/core.h>
+
+#include "cache.h"
+#include "msl/lru_table.h"
+#include "msl/bits.h"
+
+namespace
+{
+// Storage knobs
+constexpr std::size_t METADATA_BUDGET = 512 * 1024; // bytes of dedicated on-chip metadata storage, overridden by the "metadata_budget" prefetcher parameter
+constexpr std::size_t METADATA_ENTRY_BYTES = 4;     // compressed tag, successor, and confidence, as in Triage
+constexpr std::size_t METADATA_WAYS = 16;           // default, overridden by the "metadata_ways" prefetcher parameter
+constexpr std::size_t TRAINING_SETS = 64;
+constexpr std::size_t TRAINING_WAYS = 4;
+
+// Prefetch knobs
+constexpr std::size_t LOOKAHEAD = 2; // successors followed from each trigger, overridden by the "lookahead" prefetcher parameter
+
+struct triage {
+  struct training_entry {
+    uint64_t ip = 0;
+    uint64_t last_cl_addr = 0; // the last line this IP missed on
+
+    auto index() const { return ip; }
+    auto tag() const { return ip; }
+  };
+
+  struct metadata_entry {
+    uint64_t cl_addr = 0;
+    uint64_t successor = 0;
+    bool confident = false; // whether the successor has been seen twice in a row
+
+    auto index() const { return cl_addr; }
+    auto tag() const { return cl_addr; }
+  };
+
+  struct stats_type {
+    uint64_t triggers = 0;
+    uint64_t metadata_hits = 0;
+    uint64_t issued = 0;
+    uint64_t useful = 0;
+    uint64_t misses = 0;
+  };
+
+  std::size_t metadata_sets;
+  std::size_t metadata_ways;
+  std::size_t lookahead;
+  champsim::msl::lru_table<training_entry> training_unit{TRAINING_SETS, TRAINING_WAYS};
+  champsim::msl::lru_table<metadata_entry> metadata{metadata_sets, metadata_ways};
+  stats_type stats{};
+
+  void train(uint64_t ip, uint64_t cl_addr)
+  {
+    auto previous = training_unit.check_hit({ip, cl_addr});
+    training_unit.fill({ip, cl_addr});
+    if (!previous.has_value() || previous->last_cl_addr == cl_addr)
+      return;
+
+    // A successor that disagrees once only loses confidence, so a single stray miss does not break a recurring sequence
+    auto found = metadata.check_hit({previous->last_cl_addr, cl_addr, false});
+    if (!found.has_value())
+      metadata.fill({previous->last_cl_addr, cl_addr, false});
+    else if (found->successor == cl_addr)
+      metadata.fill({previous->last_cl_addr, cl_addr, true});
+    else if (found->confident)
+      metadata.fill({previous->last_cl_addr, found->successor, false});
+    else
+      metadata.fill({previous->last_cl_addr, cl_addr, false});
+  }
+
+  void predict(CACHE* cache, uint64_t cl_addr)
+  {
+    if (!cache->warmup)
+      ++stats.triggers;
+    for (std::size_t depth = 0; depth < lookahead; ++depth) {
+      auto found = metadata.check_hit({cl_addr, 0, false});
+      if (!found.has_value())
+        break;
+
+      if (depth == 0 && !cache->warmup)
+        ++stats.metadata_hits;
+      cl_addr = found->successor;
+      if (cache->prefetch_line(cl_addr << LOG2_BLOCK_SIZE, true, 0) && !cache->warmup)
+        ++stats.issued;
+    }
+  }
+};
+
+std::map<CACHE*, triage> prefetchers;
+} // namespace
+
+void CACHE::prefetcher_initialize()
+{
+  auto budget = get_prefetcher_parameter("metadata_budget", METADATA_BUDGET);
+  auto ways = get_prefetcher_parameter("metadata_ways", METADATA_WAYS);
+  auto sets = ways > 0 ? budget / METADATA_ENTRY_BYTES / ways : 0;
+
+  // The metadata store is indexed by the low bits of the line address
+  if (sets == 0 || sets != (1ull << champsim::msl::lg2(sets)))
+    throw std::invalid_argument{fmt::format("{}: the Triage metadata budget of {} bytes in {} ways does not make a power-of-two number of sets", NAME, budget,
+                                            ways)};
+
+  ::prefetchers.insert_or_assign(this, ::triage{sets, ways, get_prefetcher_parameter("lookahead", LOOKAHEAD)});
+}
+
+void CACHE::prefetcher_cycle_operate() {}
+
+uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, bool useful_prefetch, uint8_t type, uint32_t metadata_in)
+{
+  auto& pref = ::prefetchers.at(this);
+  auto cl_addr = addr >> LOG2_BLOCK_SIZE;
+
+  if (type != champsim::to_underlying(access_type::PREFETCH)) {
+    if (!warmup && useful_prefetch)
+      ++pref.stats.useful;
+    else if (!warmup && !cache_hit)
+      ++pref.stats.misses;
+
+    // Like Triage, train on the demand misses that a perfect prefetcher would have removed
+    if (!cache_hit || useful_prefetch)
+      pref.train(ip, cl_addr);
+  }
+
+  pref.predict(this, cl_addr);
+  return metadata_in;
+}
+
+uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr, uint32_t metadata_in)
+{
+  return metadata_in;
+}
+
+void CACHE::prefetcher_final_stats()
+{
+  const auto& pref = ::prefetchers.at(this);
+  const auto& stats = pref.stats;
+  auto ratio = [](uint64_t num, uint64_t denom) { return denom > 0 ? static_cast<double>(num) / static_cast<double>(denom) : 0.0; };
+
+  fmt::print("{} Triage metadata: {} KiB in {} sets of {} ways\n", NAME, pref.metadata_sets * pref.metadata_ways * METADATA_ENTRY_BYTES / 1024,
+             pref.metadata_sets, pref.metadata_ways);
+  fmt::print("{} Triage triggers: {} metadata hits: {} prefetches issued: {} useful: {}\n", NAME, stats.triggers, stats.metadata_hits, stats.issued,
+             stats.useful);
+  fmt::print("{} Triage coverage: {:.4g} accuracy: {:.4g}\n", NAME, ratio(stats.useful, stats.useful + stats.misses), ratio(stats.useful, stats.issued));
+}
@@ -1,29 +1,73 @@
+#include <algorithm>
+#include <array>
 #include <bitset>
 #include <map>
+#include <stdexcept>
 #include <vector>
 
 #include "cache.h"
 
 namespace
 {
-constexpr std::size_t REGION_COUNT = 128;
+constexpr std::size_t REGION_SETS = 16; // default, overridden by the "region_sets" prefetcher parameter
+constexpr std::size_t REGION_WAYS = 8;  // default, overridden by the "region_ways" prefetcher parameter
 constexpr int MAX_DISTANCE = 256;
 constexpr int PREFETCH_DEGREE = 2;
 
+constexpr uint64_t BLOCKS_PER_PAGE = PAGE_SIZE / BLOCK_SIZE;
+
+// The pattern search looks up to twice the maximum distance on either side of the demand
+constexpr std::size_t WINDOW_PAGES = (4 * MAX_DISTANCE + BLOCKS_PER_PAGE - 1) / BLOCKS_PER_PAGE + 1;
+
 struct region_type {
-  uint64_t vpn;
-  std::bitset<PAGE_SIZE / BLOCK_SIZE> access_map{};
-  std::bitset<PAGE_SIZE / BLOCK_SIZE> prefetch_map{};
-  uint64_t lru;
+  uint64_t vpn = 0;
+  std::bitset<BLOCKS_PER_PAGE> access_map{};
+  std::bitset<BLOCKS_PER_PAGE> prefetch_map{};
+  uint64_t lru = 0;
+};
 
-  static uint64_t region_lru;
+class region_table
+{
+  std::size_t num_sets;
+  std::size_t num_ways;
+  std::vector<region_type> regions = std::vector<region_type>(num_sets * num_ways); // the ways of each set are adjacent
+  uint64_t next_lru = 0;
+
+  auto set_begin(uint64_t vpn)
+  {
+    // Fibonacci hashing spreads neighbouring pages across the sets
+    auto set = ((vpn * 0x9e3779b97f4a7c15ull) >> 32) % num_sets;
+    return std::next(std::begin(regions), static_cast<long>(set * num_ways));
+  }
 
-  region_type() : region_type(0) {}
-  explicit region_type(uint64_t allocate_vpn) : vpn(allocate_vpn), lru(region_lru++) {}
+public:
+  region_table(std::size_t sets, std::size_t ways) : num_sets(sets), num_ways(ways)
+  {
+    // Distinct timestamps make the initial victims deterministic, as allocations would
+    for (auto& region : regions)
+      region.lru = next_lru++;
+  }
+
+  region_type* find(uint64_t vpn)
+  {
+    auto begin = set_begin(vpn);
+    auto end = std::next(begin, static_cast<long>(num_ways));
+    auto found = std::find_if(begin, end, [vpn](const auto& x) { return x.vpn == vpn; });
+    return found != end ? &*found : nullptr;
+  }
+
+  // Replace the least recently allocated region of the set
+  region_type& allocate(uint64_t vpn)
+  {
+    auto begin = set_begin(vpn);
+    auto end = std::next(begin, static_cast<long>(num_ways));
+    auto victim = std::min_element(begin, end, [](const auto& x, const auto& y) { return x.lru < y.lru; });
+    *victim = region_type{vpn, {}, {}, next_lru++};
+    return *victim;
+  }
 };
-uint64_t region_type::region_lru = 0;
 
-std::map<CACHE*, std::array<region_type, REGION_COUNT>> regions;
+std::map<CACHE*, region_table> regions;
 
 auto page_and_offset(uint64_t addr)
 {
@@ -32,41 +76,64 @@ auto page_and_offset(uint64_t addr)
   return std::pair{page_number, page_offset};
 }
 
-bool check_cl_access(CACHE* cache, uint64_t v_addr)
+// The maps of the pages around a demand, read from the region table once for the whole pattern search
+class region_window
 {
-  auto [vpn, page_offset] = page_and_offset(v_addr);
-  auto region = std::find_if(std::begin(regions.at(cache)), std::end(regions.at(cache)), [vpn = vpn](auto x) { return x.vpn == vpn; });
+  uint64_t first_vpn;
+  std::array<std::bitset<BLOCKS_PER_PAGE>, WINDOW_PAGES> access_maps{};
+  std::array<std::bitset<BLOCKS_PER_PAGE>, WINDOW_PAGES> prefetch_maps{};
+
+  // The window starts at page 0 for demands near the bottom of the address space, so the search may step outside it
+  bool test(const std::array<std::bitset<BLOCKS_PER_PAGE>, WINDOW_PAGES>& maps, uint64_t v_addr) const
+  {
+    auto [vpn, page_offset] = page_and_offset(v_addr);
+    return vpn >= first_vpn && vpn - first_vpn < WINDOW_PAGES && maps[vpn - first_vpn].test(page_offset);
+  }
 
-  return (region != std::end(regions.at(cache))) && region->access_map.test(page_offset);
-}
+public:
+  region_window(region_table& table, uint64_t addr)
+      : first_vpn(page_and_offset(addr - std::min<uint64_t>(addr, 2 * MAX_DISTANCE * BLOCK_SIZE)).first)
+  {
+    for (std::size_t i = 0; i < WINDOW_PAGES; ++i) {
+      if (auto region = table.find(first_vpn + i); region != nullptr) {
+        access_maps[i] = region->access_map;
+        prefetch_maps[i] = region->prefetch_map;
+      }
+    }
+  }
 
-bool check_cl_prefetch(CACHE* cache, uint64_t v_addr)
+  bool accessed(uint64_t v_addr) const { return test(access_maps, v_addr); }
+  bool prefetched(uint64_t v_addr) const { return test(prefetch_maps, v_addr); }
+};
+} // anonymous namespace
+
+void CACHE::prefetcher_initialize()
 {
-  auto [vpn, page_offset] = page_and_offset(v_addr);
-  auto region = std::find_if(std::begin(regions.at(cache)), std::end(regions.at(cache)), [vpn = vpn](auto x) { return x.vpn == vpn; });
+  auto sets = get_prefetcher_parameter("region_sets", REGION_SETS);
+  auto ways = get_prefetcher_parameter("region_ways", REGION_WAYS);
+  if (sets == 0 || ways == 0)
+    throw std::invalid_argument{NAME + ": the va_ampm_lite parameters region_sets and region_ways must be at least 1"};
 
-  return (region != std::end(regions.at(cache))) && region->prefetch_map.test(page_offset);
+  ::regions.insert_or_assign(this, region_table{sets, ways});
 }
 
-} // anonymous namespace
-
-void CACHE::prefetcher_initialize() { regions.insert_or_assign(this, decltype(regions)::mapped_type{}); }
-
 uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, bool useful_prefetch, uint8_t type, uint32_t metadata_in)
 {
+  auto& table = ::regions.at(this);
   auto [current_vpn, page_offset] = ::page_and_offset(addr);
-  auto demand_region = std::find_if(std::begin(::regions.at(this)), std::end(::regions.at(this)), [vpn = current_vpn](auto x) { return x.vpn == vpn; });
+  auto demand_region = table.find(current_vpn);
 
-  if (demand_region == std::end(::regions.at(this))) {
+  if (demand_region == nullptr) {
     // not tracking this region yet, so replace the LRU region
-    demand_region = std::min_element(std::begin(::regions.at(this)), std::end(::regions.at(this)), [](auto x, auto y) { return x.lru < y.lru; });
-    *demand_region = region_type{current_vpn};
+    table.allocate(current_vpn);
     return metadata_in;
   }
 
   // mark this demand access
   demand_region->access_map.set(page_offset);
 
+  ::region_window window{table, addr};
+
   // attempt to prefetch in the positive, then negative direction
   for (auto direction : {1, -1}) {
     for (int i = 1, prefetches_issued = 0; i <= MAX_DISTANCE && prefetches_issued < PREFETCH_DEGREE; i++) {
@@ -74,19 +141,17 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
       const auto neg_step_addr = addr - direction * (i * (signed)BLOCK_SIZE);
       const auto neg_2step_addr = addr - direction * (2 * i * (signed)BLOCK_SIZE);
 
-      if (::check_cl_access(this, neg_step_addr) && ::check_cl_access(this, neg_2step_addr) && !::check_cl_access(this, pos_step_addr)
-          && !::check_cl_prefetch(this, pos_step_addr)) {
+      if (window.accessed(neg_step_addr) && window.accessed(neg_2step_addr) && !window.accessed(pos_step_addr) && !window.prefetched(pos_step_addr)) {
         // found something that we should prefetch
         if ((addr >> LOG2_BLOCK_SIZE) != (pos_step_addr >> LOG2_BLOCK_SIZE)) {
           bool prefetch_success = prefetch_line(pos_step_addr, (get_mshr_occupancy_ratio() < 0.5), metadata_in);
           if (prefetch_success) {
             auto [pf_vpn, pf_page_offset] = ::page_and_offset(pos_step_addr);
-            auto pf_region = std::find_if(std::begin(::regions.at(this)), std::end(::regions.at(this)), [vpn = pf_vpn](auto x) { return x.vpn == vpn; });
+            auto pf_region = table.find(pf_vpn);
 
-            if (pf_region == std::end(::regions.at(this))) {
+            if (pf_region == nullptr) {
               // we're not currently tracking this region, so allocate a new region so we can mark it
-              pf_region = std::min_element(std::begin(::regions.at(this)), std::end(::regions.at(this)), [](auto x, auto y) { return x.lru < y.lru; });
-              *pf_region = region_type{pf_vpn};
+              pf_region = &table.allocate(pf_vpn);
             }
 
             pf_region->prefetch_map.set(pf_page_offset);
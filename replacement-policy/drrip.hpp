@@ -80,6 +80,13 @@ class DRRIP : public ReplacementPolicy {
             PSEL[std::make_pair(cache_block, triggering_cpu)]++;
             rrpv[cache_block][set * cache_block->NUM_WAY + way] = ::maxRRPV - 1;
         }
+
+        // a prefetcher's hint overrides the insertion of either policy, but the leader sets still count the miss
+        if (auto priority = cache_block->get_insertion_priority(set, way); priority == champsim::insertion_priority::low) {
+            rrpv[cache_block][set * cache_block->NUM_WAY + way] = ::maxRRPV;
+        } else if (priority == champsim::insertion_priority::high) {
+            rrpv[cache_block][set * cache_block->NUM_WAY + way] = 0;
+        }
     }
 
     virtual std::uint32_t findVictim(CACHE* cache_block, std::uint64_t current_cycle, std::uint32_t triggering_cpu,
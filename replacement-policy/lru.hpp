@@ -23,6 +23,11 @@ class LRU : public ReplacementPolicy {
             // Skip this for writeback hits
             last_used_cycles[cache_block].at(set * cache_block->NUM_WAY + way) = current_cycle;
         }
+
+        // Insert low-priority prefetches at the LRU position
+        if (!hit && cache_block->get_insertion_priority(set, way) == champsim::insertion_priority::low) {
+            last_used_cycles[cache_block].at(set * cache_block->NUM_WAY + way) = 0;
+        }
     }
 
     virtual std::uint32_t findVictim(CACHE* cache_block, std::uint64_t current_cycle, std::uint32_t triggering_cpu,
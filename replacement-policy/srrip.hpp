@@ -18,6 +18,10 @@ class SRRIP : public ReplacementPolicy {
                              std::uint64_t victim_addr, std::uint32_t type, std::uint8_t hit) override {
         if (hit)
             rrpv_values[cache_block][set * cache_block->NUM_WAY + way] = 0;
+        else if (auto priority = cache_block->get_insertion_priority(set, way); priority == champsim::insertion_priority::low)
+            rrpv_values[cache_block][set * cache_block->NUM_WAY + way] = ::maxRRPV;  // a distant re-reference
+        else if (priority == champsim::insertion_priority::high)
+            rrpv_values[cache_block][set * cache_block->NUM_WAY + way] = 0;  // a near-immediate re-reference
         else
             rrpv_values[cache_block][set * cache_block->NUM_WAY + way] = ::maxRRPV - 1;
     }
@@ -88,6 +88,12 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
     ::PSEL[std::make_pair(this, triggering_cpu)]++;
     ::rrpv[this][set * NUM_WAY + way] = ::maxRRPV - 1;
   }
+
+  // a prefetcher's hint overrides the insertion of either policy, but the leader sets still count the miss
+  if (auto priority = get_insertion_priority(set, way); priority == champsim::insertion_priority::low)
+    ::rrpv[this][set * NUM_WAY + way] = ::maxRRPV;
+  else if (priority == champsim::insertion_priority::high)
+    ::rrpv[this][set * NUM_WAY + way] = 0;
 }
 
 // find replacement victim
@@ -30,6 +30,10 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
   // Mark the way as being used on the current cycle
   if (!hit || access_type{type} != access_type::WRITE) // Skip this for writeback hits
     ::last_used_cycles[this].at(set * NUM_WAY + way) = current_cycle;
+
+  // Insert low-priority prefetches at the LRU position
+  if (!hit && get_insertion_priority(set, way) == champsim::insertion_priority::low)
+    ::last_used_cycles[this].at(set * NUM_WAY + way) = 0;
 }
 
 void CACHE::replacement_final_stats() {}
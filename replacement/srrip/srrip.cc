@@ -37,6 +37,10 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
 {
   if (hit)
     ::rrpv_values[this][set * NUM_WAY + way] = 0;
+  else if (auto priority = get_insertion_priority(set, way); priority == champsim::insertion_priority::low)
+    ::rrpv_values[this][set * NUM_WAY + way] = ::maxRRPV; // a distant re-reference
+  else if (priority == champsim::insertion_priority::high)
+    ::rrpv_values[this][set * NUM_WAY + way] = 0; // a near-immediate re-reference
   else
     ::rrpv_values[this][set * NUM_WAY + way] = ::maxRRPV - 1;
 }
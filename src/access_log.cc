@@ -0,0 +1,59 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "access_log.h"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include "util/bits.h"
+
+champsim::access_log_writer::access_log_writer(const std::string& file_name) : stream(file_name, std::ios::binary)
+{
+  if (!stream)
+    throw std::runtime_error{"Could not open access log " + file_name};
+}
+
+void champsim::access_log_writer::write(const access_record& record)
+{
+  std::array<char, ACCESS_RECORD_SIZE> buffer{};
+  std::memcpy(buffer.data(), &record.address, sizeof(uint64_t));
+  std::memcpy(buffer.data() + sizeof(uint64_t), &record.ip, sizeof(uint64_t));
+  buffer[2 * sizeof(uint64_t)] = record.hit ? 1 : 0;
+  buffer[2 * sizeof(uint64_t) + 1] = static_cast<char>(champsim::to_underlying(record.type));
+  stream.write(buffer.data(), std::size(buffer));
+}
+
+champsim::access_log_reader::access_log_reader(const std::string& file_name) : stream(file_name, std::ios::binary)
+{
+  if (!stream)
+    throw std::runtime_error{"Could not open access log " + file_name};
+}
+
+std::optional<champsim::access_record> champsim::access_log_reader::read()
+{
+  std::array<char, ACCESS_RECORD_SIZE> buffer{};
+  if (!stream.read(buffer.data(), std::size(buffer)))
+    return std::nullopt;
+
+  access_record record;
+  std::memcpy(&record.address, buffer.data(), sizeof(uint64_t));
+  std::memcpy(&record.ip, buffer.data() + sizeof(uint64_t), sizeof(uint64_t));
+  record.hit = buffer[2 * sizeof(uint64_t)] != 0;
+  record.type = access_type{static_cast<unsigned char>(buffer[2 * sizeof(uint64_t) + 1])};
+  return record;
+}
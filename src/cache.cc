@@ -24,6 +24,7 @@
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 
+#include "access_log.h"
 #include "champsim.h"
 #include "champsim_constants.h"
 #include "deadlock.h"
@@ -32,6 +33,20 @@
 #include "util/span.h"
 #include <fmt/core.h>
 
+namespace
+{
+// The block that a queued prefetch would fetch, for finding duplicates among composed prefetchers
+template <typename T>
+uint64_t prefetch_block(const T& entry)
+{
+  return (entry.v_address != 0 ? entry.v_address : entry.address) >> LOG2_BLOCK_SIZE;
+}
+} // namespace
+
+void CACHE::access_log_deleter::operator()(champsim::access_log_writer* log) const { delete log; }
+
+void CACHE::open_access_log(const std::string& file_name) { access_log.reset(new champsim::access_log_writer{file_name}); }
+
 CACHE::tag_lookup_type::tag_lookup_type(request_type req, bool local_pref, bool skip)
     : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), instr_id(req.instr_id), pf_metadata(req.pf_metadata), cpu(req.cpu),
       type(req.type), prefetch_from_this(local_pref), skip_fill(skip), is_translated(req.is_translated), instr_depend_on_me(req.instr_depend_on_me)
@@ -40,24 +55,22 @@ CACHE::tag_lookup_type::tag_lookup_type(request_type req, bool local_pref, bool
 
 CACHE::mshr_type::mshr_type(tag_lookup_type req, uint64_t cycle)
     : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), instr_id(req.instr_id), pf_metadata(req.pf_metadata), cpu(req.cpu),
-      type(req.type), prefetch_from_this(req.prefetch_from_this), cycle_enqueued(cycle), instr_depend_on_me(req.instr_depend_on_me), to_return(req.to_return)
+      pf_source(req.pf_source), priority(req.priority), type(req.type), prefetch_from_this(req.prefetch_from_this), cycle_enqueued(cycle), instr_depend_on_me(req.instr_depend_on_me), to_return(req.to_return)
 {
 }
 
 CACHE::mshr_type CACHE::mshr_type::merge(mshr_type predecessor, mshr_type successor)
 {
-  std::vector<std::reference_wrapper<ooo_model_instr>> merged_instr{};
-  std::vector<std::deque<response_type>*> merged_return{};
-
-  std::set_union(std::begin(predecessor.instr_depend_on_me), std::end(predecessor.instr_depend_on_me), std::begin(successor.instr_depend_on_me),
-                 std::end(successor.instr_depend_on_me), std::back_inserter(merged_instr), ooo_model_instr::program_order);
-  std::set_union(std::begin(predecessor.to_return), std::end(predecessor.to_return), std::begin(successor.to_return), std::end(successor.to_return),
-                 std::back_inserter(merged_return));
+  auto merged_instr = predecessor.instr_depend_on_me;
+  auto merged_return = predecessor.to_return;
+  champsim::set_union_into(merged_instr, successor.instr_depend_on_me, ooo_model_instr::program_order);
+  champsim::set_union_into(merged_return, successor.to_return);
 
   mshr_type retval{(successor.type == access_type::PREFETCH) ? predecessor : successor};
   retval.instr_depend_on_me = merged_instr;
   retval.to_return = merged_return;
   retval.data = predecessor.data;
+  retval.cycle_demanded = std::min(predecessor.cycle_demanded, successor.cycle_demanded);
 
   if (predecessor.event_cycle < std::numeric_limits<uint64_t>::max()) {
     retval.event_cycle = predecessor.event_cycle;
@@ -74,8 +87,15 @@ CACHE::mshr_type CACHE::mshr_type::merge(mshr_type predecessor, mshr_type succes
   return retval;
 }
 
+void cycle_histogram::record(uint64_t cycles)
+{
+  auto bucket = (cycles == 0) ? 0 : champsim::lg2(cycles) + 1;
+  ++buckets.at(std::min<std::size_t>(bucket, NUM_BUCKETS - 1));
+}
+
 CACHE::BLOCK::BLOCK(mshr_type mshr)
-    : valid(true), prefetch(mshr.prefetch_from_this), dirty(mshr.type == access_type::WRITE), address(mshr.address), v_address(mshr.v_address), data(mshr.data)
+    : valid(true), prefetch(mshr.prefetch_from_this), dirty(mshr.type == access_type::WRITE), address(mshr.address), v_address(mshr.v_address), data(mshr.data),
+      pf_source(mshr.pf_source), priority(mshr.priority)
 {
 }
 
@@ -127,13 +147,22 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
     if (success) {
       auto evicting_address = (ever_seen_data ? way->address : way->v_address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
 
-      if (way->prefetch)
+      if (way->prefetch) {
         ++sim_stats.pf_useless;
+        ++sim_stats.pf_sources.at(way->pf_source).useless;
+        sim_stats.pf_unused_lifetime.record(current_cycle - way->cycle_filled);
+      }
 
       if (fill_mshr.type == access_type::PREFETCH)
         ++sim_stats.pf_fill;
 
+      if (fill_mshr.type == access_type::PREFETCH && way->valid)
+        pf_feedback.record_prefetch_eviction(way->address >> OFFSET_BITS);
+      else if (fill_mshr.type != access_type::PREFETCH)
+        pf_feedback.record_demand_fill(fill_mshr.address >> OFFSET_BITS);
+
       *way = BLOCK{fill_mshr};
+      way->cycle_filled = current_cycle;
 
       metadata_thru = impl_prefetcher_cache_fill(pkt_address, get_set_index(fill_mshr.address), way_idx, fill_mshr.type == access_type::PREFETCH,
                                                  evicting_address, metadata_thru);
@@ -155,8 +184,17 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
   if (success) {
     // COLLECT STATS
     sim_stats.total_miss_latency += current_cycle - (fill_mshr.cycle_enqueued + 1);
+    if (fill_mshr.cycle_demanded != std::numeric_limits<uint64_t>::max())
+      sim_stats.pf_late_by.record(current_cycle - fill_mshr.cycle_demanded);
+
+    if (pf_feedback.record_fill() && prefetch_throttle && !pf_orchestrator.has_value())
+      impl_prefetcher_aggressiveness_update(pf_feedback.level());
+    if (pf_arbiter.has_value())
+      pf_arbiter->record_fill();
 
     response_type response{fill_mshr.address, fill_mshr.v_address, fill_mshr.data, metadata_thru, fill_mshr.instr_depend_on_me};
+    response.miss_depth = fill_mshr.miss_depth;
+    response.served_by_memory = fill_mshr.served_by_memory;
     for (auto ret : fill_mshr.to_return)
       ret->push_back(response);
   }
@@ -186,10 +224,14 @@ bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
   if (should_activate_prefetcher(handle_pkt)) {
     uint64_t pf_base_addr = (virtual_prefetch ? handle_pkt.v_address : handle_pkt.address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
     metadata_thru = impl_prefetcher_cache_operate(pf_base_addr, handle_pkt.ip, hit, useful_prefetch, champsim::to_underlying(handle_pkt.type), metadata_thru);
+
+    if (access_log != nullptr)
+      access_log->write({pf_base_addr, handle_pkt.ip, hit, handle_pkt.type});
   }
 
   if (hit) {
     ++sim_stats.hits[champsim::to_underlying(handle_pkt.type)][handle_pkt.cpu];
+    record_demand_access(handle_pkt, true);
 
     // update replacement policy
     const auto way_idx = static_cast<std::size_t>(std::distance(set_begin, way)); // cast protected by earlier assertion
@@ -205,6 +247,11 @@ bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
     // update prefetch stats and reset prefetch bit
     if (useful_prefetch) {
       ++sim_stats.pf_useful;
+      ++sim_stats.pf_sources.at(way->pf_source).useful;
+      sim_stats.pf_lead_time.record(current_cycle - way->cycle_filled);
+      pf_feedback.record_used();
+      if (pf_arbiter.has_value())
+        pf_arbiter->record_useful(way->pf_source);
       way->prefetch = false;
     }
   }
@@ -233,9 +280,17 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
   if (mshr_entry != MSHR.end()) // miss already inflight
   {
     if (mshr_entry->type == access_type::PREFETCH && handle_pkt.type != access_type::PREFETCH) {
-      // Mark the prefetch as useful
-      if (mshr_entry->prefetch_from_this)
+      // Mark the prefetch as useful, but late
+      if (mshr_entry->prefetch_from_this) {
         ++sim_stats.pf_useful;
+        ++sim_stats.pf_late;
+        ++sim_stats.pf_sources.at(mshr_entry->pf_source).useful;
+        pf_feedback.record_used();
+        pf_feedback.record_late();
+        if (pf_arbiter.has_value())
+          pf_arbiter->record_useful(mshr_entry->pf_source);
+        to_allocate.cycle_demanded = current_cycle;
+      }
     }
 
     *mshr_entry = mshr_type::merge(*mshr_entry, to_allocate);
@@ -284,13 +339,30 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
       MSHR.push_back(to_allocate);
       MSHR.back().pf_metadata = fwd_pkt.pf_metadata;
     }
+
+    if (handle_pkt.prefetch_from_this)
+      pf_feedback.record_sent();
+    else if (handle_pkt.type != access_type::PREFETCH && pf_feedback.record_demand_miss(handle_pkt.address >> OFFSET_BITS))
+      ++sim_stats.pf_pollution;
   }
 
   ++sim_stats.misses[champsim::to_underlying(handle_pkt.type)][handle_pkt.cpu];
+  record_demand_access(handle_pkt, false);
 
   return true;
 }
 
+void CACHE::record_demand_access(const tag_lookup_type& handle_pkt, bool hit)
+{
+  if (!pf_orchestrator.has_value() || handle_pkt.type == access_type::PREFETCH || handle_pkt.type == access_type::WRITE)
+    return;
+
+  if (pf_orchestrator->record_access(hit) && pf_orchestrator->prefetch_enabled()) {
+    auto [degree, distance] = pf_orchestrator->chosen_configuration();
+    impl_prefetcher_configuration_update(degree, distance);
+  }
+}
+
 bool CACHE::handle_write(const tag_lookup_type& handle_pkt)
 {
   if constexpr (champsim::debug_print) {
@@ -376,7 +448,11 @@ long CACHE::operate()
       progress += bandwidth_consumed;
     }
   }
+  arbitrate_prefetches();
   auto pq_bandwidth_consumed = champsim::transform_while_n(internal_PQ, std::back_inserter(inflight_tag_check), tag_bw, can_translate, initiate_tag_check<false>());
+  if (pf_arbiter.has_value())
+    std::for_each(std::prev(std::end(inflight_tag_check), pq_bandwidth_consumed), std::end(inflight_tag_check),
+                  [this](const auto& entry) { pending_prefetch_blocks.erase(::prefetch_block(entry)); });
   tag_bw -= pq_bandwidth_consumed;
   progress += pq_bandwidth_consumed;
 
@@ -467,13 +543,35 @@ uint64_t CACHE::invalidate_entry(uint64_t inval_addr)
   return std::distance(begin, inv_way);
 }
 
-int CACHE::prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata)
+int CACHE::prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata, champsim::insertion_priority priority)
 {
+  auto source = prefetch_source_index();
   ++sim_stats.pf_requested;
+  ++sim_stats.pf_sources.at(source).requested;
 
-  if (std::size(internal_PQ) >= PQ_SIZE)
+  // Composed prefetchers each have their own queue of candidates
+  auto& queue = pf_arbiter.has_value() ? prefetch_candidates.at(source) : internal_PQ;
+  if (std::size(queue) >= PQ_SIZE)
     return false;
 
+  // The bandit may turn prefetching off
+  if (pf_orchestrator.has_value() && !pf_orchestrator->prefetch_enabled()) {
+    ++sim_stats.pf_throttled;
+    return false;
+  }
+
+  // Drop the prefetch if the resources it would take are busier than the current aggressiveness allows
+  if (prefetch_throttle) {
+    auto lower_occupancy = prefetch_as_load ? lower_level->rq_occupancy() : lower_level->pq_occupancy();
+    auto lower_size = prefetch_as_load ? lower_level->rq_size() : lower_level->pq_size();
+    auto lower_ratio = std::ceil(lower_occupancy) / std::ceil(lower_size);
+    auto ceiling = champsim::prefetch_feedback::occupancy_ceiling(get_prefetch_aggressiveness(), fill_this_level);
+    if (std::max(get_mshr_occupancy_ratio(), lower_ratio) > ceiling) {
+      ++sim_stats.pf_throttled;
+      return false;
+    }
+  }
+
   request_type pf_packet;
   pf_packet.type = access_type::PREFETCH;
   pf_packet.pf_metadata = prefetch_metadata;
@@ -482,12 +580,72 @@ int CACHE::prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefet
   pf_packet.v_address = virtual_prefetch ? pf_addr : 0;
   pf_packet.is_translated = !virtual_prefetch;
 
-  internal_PQ.emplace_back(pf_packet, true, !fill_this_level);
+  tag_lookup_type candidate{pf_packet, true, !fill_this_level};
+  candidate.pf_source = source;
+  candidate.priority = priority;
+
+  if (pf_arbiter.has_value()) {
+    // If another prefetcher has already asked for this line, this request is satisfied
+    if (pending_prefetch_blocks.insert(::prefetch_block(candidate)).second)
+      queue.push_back(candidate);
+    else
+      ++sim_stats.pf_sources.at(source).duplicate;
+    return true;
+  }
+
+  internal_PQ.push_back(candidate);
   ++sim_stats.pf_issued;
+  ++sim_stats.pf_sources.at(source).issued;
 
   return true;
 }
 
+std::size_t CACHE::prefetch_source_index() const
+{
+  // Sources are numbered in the order of their module constants
+  return std::bitset<std::numeric_limits<unsigned long long>::digits>{prefetcher_flags & (active_prefetcher - 1)}.count();
+}
+
+void CACHE::arbitrate_prefetches()
+{
+  if (!pf_arbiter.has_value())
+    return;
+
+  auto order = pf_arbiter->order();
+  for (auto source : order) {
+    auto& candidates = prefetch_candidates.at(source);
+    while (!std::empty(candidates) && std::size(internal_PQ) < PQ_SIZE) {
+      internal_PQ.push_back(candidates.front());
+      candidates.pop_front();
+      ++sim_stats.pf_issued;
+      ++sim_stats.pf_sources.at(source).issued;
+      pf_arbiter->record_issued(source);
+    }
+  }
+
+  // Prefetchers that the arbiter did not choose lose their candidates
+  for (std::size_t source = 0; source < std::size(prefetch_candidates); ++source) {
+    if (std::find(std::begin(order), std::end(order), source) == std::end(order)) {
+      auto& candidates = prefetch_candidates.at(source);
+      sim_stats.pf_sources.at(source).dropped += std::size(candidates);
+      for (const auto& entry : candidates)
+        pending_prefetch_blocks.erase(::prefetch_block(entry));
+      candidates.clear();
+    }
+  }
+}
+
+std::vector<prefetch_source_stats> CACHE::new_source_stats() const
+{
+  std::vector<prefetch_source_stats> retval;
+  std::transform(std::begin(prefetch_source_names), std::end(prefetch_source_names), std::back_inserter(retval), [](auto name) {
+    prefetch_source_stats stats;
+    stats.name = name;
+    return stats;
+  });
+  return retval;
+}
+
 // LCOV_EXCL_START exclude deprecated function
 int CACHE::prefetch_line(uint64_t, uint64_t, uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata)
 {
@@ -511,6 +669,8 @@ void CACHE::finish_packet(const response_type& packet)
   // MSHR holds the most updated information about this request
   mshr_entry->data = packet.data;
   mshr_entry->pf_metadata = packet.pf_metadata;
+  mshr_entry->miss_depth = static_cast<uint8_t>(packet.miss_depth + 1);
+  mshr_entry->served_by_memory = packet.served_by_memory;
   mshr_entry->event_cycle = current_cycle + (warmup ? 0 : FILL_LATENCY);
 
   if constexpr (champsim::debug_print) {
@@ -662,6 +822,40 @@ std::vector<double> occupancy_ratio_vec(std::vector<std::size_t> occ, std::vecto
 }
 } // namespace
 
+unsigned CACHE::get_prefetch_aggressiveness() const { return pf_feedback.level(); }
+
+uint64_t CACHE::get_prefetcher_parameter(const std::string& name, uint64_t default_value) const
+{
+  if (auto found = prefetcher_parameters.find(name); found != std::end(prefetcher_parameters))
+    return found->second;
+  return default_value;
+}
+
+std::vector<uint64_t> CACHE::take_queued_prefetches()
+{
+  std::vector<uint64_t> retval;
+  auto take = [&retval](auto& queue) {
+    std::transform(std::begin(queue), std::end(queue), std::back_inserter(retval), [](const auto& entry) { return entry.address; });
+    queue.clear();
+  };
+
+  take(internal_PQ);
+
+  // Composed prefetchers' candidates are taken without arbitration
+  for (auto& candidates : prefetch_candidates)
+    take(candidates);
+  pending_prefetch_blocks.clear();
+  return retval;
+}
+
+champsim::insertion_priority CACHE::get_insertion_priority(uint32_t set, uint32_t way) const
+{
+  // A bypassed fill has no block
+  if (way >= NUM_WAY)
+    return champsim::insertion_priority::normal;
+  return block.at(set * NUM_WAY + way).priority;
+}
+
 double CACHE::get_mshr_occupancy_ratio() const { return ::occupancy_ratio(get_mshr_occupancy(), get_mshr_size()); }
 
 std::vector<double> CACHE::get_rq_occupancy_ratio() const { return ::occupancy_ratio_vec(get_rq_occupancy(), get_rq_size()); }
@@ -673,6 +867,12 @@ std::vector<double> CACHE::get_pq_occupancy_ratio() const { return ::occupancy_r
 void CACHE::initialize()
 {
   impl_prefetcher_initialize();
+  if (prefetch_throttle && !prefetch_bandit)
+    impl_prefetcher_aggressiveness_update(get_prefetch_aggressiveness());
+  if (prefetch_bandit && pf_orchestrator->prefetch_enabled()) {
+    auto [degree, distance] = pf_orchestrator->chosen_configuration();
+    impl_prefetcher_configuration_update(degree, distance);
+  }
   impl_initialize_replacement();
 }
 
@@ -682,6 +882,8 @@ void CACHE::begin_phase()
 
   new_roi_stats.name = NAME;
   new_sim_stats.name = NAME;
+  new_roi_stats.pf_sources = new_source_stats();
+  new_sim_stats.pf_sources = new_source_stats();
 
   roi_stats = new_roi_stats;
   sim_stats = new_sim_stats;
@@ -715,6 +917,13 @@ void CACHE::end_phase(unsigned finished_cpu)
   roi_stats.pf_useful = sim_stats.pf_useful;
   roi_stats.pf_useless = sim_stats.pf_useless;
   roi_stats.pf_fill = sim_stats.pf_fill;
+  roi_stats.pf_late = sim_stats.pf_late;
+  roi_stats.pf_pollution = sim_stats.pf_pollution;
+  roi_stats.pf_throttled = sim_stats.pf_throttled;
+  roi_stats.pf_lead_time = sim_stats.pf_lead_time;
+  roi_stats.pf_late_by = sim_stats.pf_late_by;
+  roi_stats.pf_unused_lifetime = sim_stats.pf_unused_lifetime;
+  roi_stats.pf_sources = sim_stats.pf_sources;
 
   for (auto ul : upper_levels) {
     ul->roi_stats.RQ_ACCESS = ul->sim_stats.RQ_ACCESS;
@@ -74,21 +74,24 @@ phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader
     std::sort(std::begin(operables), std::end(operables),
               [](const champsim::operable& lhs, const champsim::operable& rhs) { return lhs.leap_operation < rhs.leap_operation; });
 
-    // Read from trace
+    // Read from trace. Each hardware thread reads its own trace, in order of the cores and then of their threads.
+    std::size_t context = 0;
     for (O3_CPU& cpu : env.cpu_view()) {
-      auto& trace = traces.at(trace_index.at(cpu.cpu));
-      for (auto pkt_count = cpu.IN_QUEUE_SIZE - static_cast<long>(std::size(cpu.input_queue)); !trace.eof() && pkt_count > 0; --pkt_count)
-        cpu.input_queue.push_back(trace());
-
-      // If any trace reaches EOF, terminate all phases
-      if (trace.eof())
-        std::fill(std::begin(next_phase_complete), std::end(next_phase_complete), true);
+      for (auto& thread : cpu.threads) {
+        auto& trace = traces.at(trace_index.at(context++));
+        for (auto pkt_count = cpu.IN_QUEUE_SIZE - static_cast<long>(std::size(thread.input_queue)); !trace.eof() && pkt_count > 0; --pkt_count)
+          thread.input_queue.push_back(trace());
+
+        // If any trace reaches EOF, terminate all phases
+        if (trace.eof())
+          std::fill(std::begin(next_phase_complete), std::end(next_phase_complete), true);
+      }
     }
 
     // Check for phase finish
     for (O3_CPU& cpu : env.cpu_view()) {
-      // Phase complete
-      next_phase_complete[cpu.cpu] = next_phase_complete[cpu.cpu] || (cpu.sim_instr() >= length);
+      // Phase complete once every thread has retired the phase length
+      next_phase_complete[cpu.cpu] = next_phase_complete[cpu.cpu] || (cpu.sim_thread_instr() >= length);
     }
 
     for (O3_CPU& cpu : env.cpu_view()) {
@@ -123,11 +126,21 @@ phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader
   std::transform(std::begin(caches), std::end(caches), std::back_inserter(stats.sim_cache_stats), [](const CACHE& cache) { return cache.sim_stats; });
   std::transform(std::begin(caches), std::end(caches), std::back_inserter(stats.roi_cache_stats), [](const CACHE& cache) { return cache.roi_stats; });
 
+  auto dram_caches = env.dram_cache_view();
+  std::transform(std::begin(dram_caches), std::end(dram_caches), std::back_inserter(stats.sim_dram_cache_stats),
+                 [](const DRAM_CACHE& drc) { return drc.sim_stats; });
+  std::transform(std::begin(dram_caches), std::end(dram_caches), std::back_inserter(stats.roi_dram_cache_stats),
+                 [](const DRAM_CACHE& drc) { return drc.roi_stats; });
+
   auto dram = env.dram_view();
   std::transform(std::begin(dram.channels), std::end(dram.channels), std::back_inserter(stats.sim_dram_stats),
                  [](const DRAM_CHANNEL& chan) { return chan.sim_stats; });
   std::transform(std::begin(dram.channels), std::end(dram.channels), std::back_inserter(stats.roi_dram_stats),
                  [](const DRAM_CHANNEL& chan) { return chan.roi_stats; });
+  if (dram.far_memory.enabled()) {
+    stats.sim_far_memory_stats.push_back(dram.far_memory.sim_stats);
+    stats.roi_far_memory_stats.push_back(dram.far_memory.roi_stats);
+  }
 
   return stats;
 }
@@ -24,19 +24,25 @@
 #include <fmt/core.h>
 
 champsim::channel::channel(std::size_t rq_size, std::size_t pq_size, std::size_t wq_size, unsigned offset_bits, bool match_offset)
-    : RQ_SIZE(rq_size), PQ_SIZE(pq_size), WQ_SIZE(wq_size), OFFSET_BITS(offset_bits), match_offset_bits(match_offset)
+    : RQ_SIZE(rq_size), PQ_SIZE(pq_size), WQ_SIZE(wq_size), OFFSET_BITS(offset_bits), match_offset_bits(match_offset), RQ{offset_bits}, PQ{offset_bits},
+      WQ{match_offset ? 0 : offset_bits}
 {
+  // Preallocate the slots of bounded queues so that they are recycled rather than reallocated
+  for (auto [queue, size] : {std::pair{&RQ, rq_size}, std::pair{&PQ, pq_size}, std::pair{&WQ, wq_size}}) {
+    if (size < std::numeric_limits<std::size_t>::max())
+      queue->reserve(size);
+  }
 }
 
-template <typename Iter, typename F>
-bool do_collision_for(Iter begin, Iter end, champsim::channel::request_type& packet, unsigned shamt, F&& func)
+template <typename F>
+bool do_collision_for(champsim::channel::queue_type& queue, champsim::channel::queue_type::iterator limit, champsim::channel::request_type& packet, F&& func)
 {
   // We make sure that both merge packet address have been translated. If
   // not this can happen: package with address virtual and physical X
   // (not translated) is inserted, package with physical address
   // (already translated) X.
-  if (auto found = std::find_if(begin, end, [addr = packet.address, shamt](const auto& x) { return (x.address >> shamt) == (addr >> shamt); });
-      found != end && packet.is_translated == found->is_translated) {
+  // The queue's block index yields the oldest matching entry, which must precede the limit.
+  if (auto found = queue.find(packet.address); found < limit && packet.is_translated == found->is_translated) {
     func(packet, *found);
     return true;
   }
@@ -44,23 +50,17 @@ bool do_collision_for(Iter begin, Iter end, champsim::channel::request_type& pac
   return false;
 }
 
-template <typename Iter>
-bool do_collision_for_merge(Iter begin, Iter end, champsim::channel::request_type& packet, unsigned shamt)
+bool do_collision_for_merge(champsim::channel::queue_type& queue, champsim::channel::queue_type::iterator limit, champsim::channel::request_type& packet)
 {
-  return do_collision_for(begin, end, packet, shamt, [](champsim::channel::request_type& source, champsim::channel::request_type& destination) {
+  return do_collision_for(queue, limit, packet, [](champsim::channel::request_type& source, champsim::channel::request_type& destination) {
     destination.response_requested |= source.response_requested;
-    auto instr_copy = std::move(destination.instr_depend_on_me);
-
-    std::set_union(std::begin(instr_copy), std::end(instr_copy), std::begin(source.instr_depend_on_me), std::end(source.instr_depend_on_me),
-                   std::back_inserter(destination.instr_depend_on_me), ooo_model_instr::program_order);
+    champsim::set_union_into(destination.instr_depend_on_me, source.instr_depend_on_me, ooo_model_instr::program_order);
   });
 }
 
-template <typename Iter>
-bool do_collision_for_return(Iter begin, Iter end, champsim::channel::request_type& packet, unsigned shamt,
-                             std::deque<champsim::channel::response_type>& returned)
+bool do_collision_for_return(champsim::channel::queue_type& queue, champsim::channel::request_type& packet, champsim::channel::response_queue_type& returned)
 {
-  return do_collision_for(begin, end, packet, shamt, [&](champsim::channel::request_type& source, champsim::channel::request_type& destination) {
+  return do_collision_for(queue, std::end(queue), packet, [&](champsim::channel::request_type& source, champsim::channel::request_type& destination) {
     if (source.response_requested)
       returned.emplace_back(source.address, source.v_address, destination.data, destination.pf_metadata, source.instr_depend_on_me);
   });
@@ -68,12 +68,9 @@ bool do_collision_for_return(Iter begin, Iter end, champsim::channel::request_ty
 
 void champsim::channel::check_collision()
 {
-  auto write_shamt = match_offset_bits ? 0 : OFFSET_BITS;
-  auto read_shamt = OFFSET_BITS;
-
   // Check WQ for duplicates, merging if they are found
   for (auto wq_it = std::find_if(std::begin(WQ), std::end(WQ), std::not_fn(&request_type::forward_checked)); wq_it != std::end(WQ);) {
-    if (do_collision_for_merge(std::begin(WQ), wq_it, *wq_it, write_shamt)) {
+    if (do_collision_for_merge(WQ, wq_it, *wq_it)) {
       sim_stats.WQ_MERGED++;
       wq_it = WQ.erase(wq_it);
     } else {
@@ -84,10 +81,10 @@ void champsim::channel::check_collision()
 
   // Check RQ for forwarding from WQ (return if found), then for duplicates (merge if found)
   for (auto rq_it = std::find_if(std::begin(RQ), std::end(RQ), std::not_fn(&request_type::forward_checked)); rq_it != std::end(RQ);) {
-    if (do_collision_for_return(std::begin(WQ), std::end(WQ), *rq_it, write_shamt, returned)) {
+    if (do_collision_for_return(WQ, *rq_it, returned)) {
       sim_stats.WQ_FORWARD++;
       rq_it = RQ.erase(rq_it);
-    } else if (do_collision_for_merge(std::begin(RQ), rq_it, *rq_it, read_shamt)) {
+    } else if (do_collision_for_merge(RQ, rq_it, *rq_it)) {
       sim_stats.RQ_MERGED++;
       rq_it = RQ.erase(rq_it);
     } else {
@@ -98,10 +95,10 @@ void champsim::channel::check_collision()
 
   // Check PQ for forwarding from WQ (return if found), then for duplicates (merge if found)
   for (auto pq_it = std::find_if(std::begin(PQ), std::end(PQ), std::not_fn(&request_type::forward_checked)); pq_it != std::end(PQ);) {
-    if (do_collision_for_return(std::begin(WQ), std::end(WQ), *pq_it, write_shamt, returned)) {
+    if (do_collision_for_return(WQ, *pq_it, returned)) {
       sim_stats.WQ_FORWARD++;
       pq_it = PQ.erase(pq_it);
-    } else if (do_collision_for_merge(std::begin(PQ), pq_it, *pq_it, read_shamt)) {
+    } else if (do_collision_for_merge(PQ, pq_it, *pq_it)) {
       sim_stats.PQ_MERGED++;
       pq_it = PQ.erase(pq_it);
     } else {
@@ -131,9 +128,8 @@ bool champsim::channel::do_add_queue(R& queue, std::size_t queue_size, const typ
   }
 
   // Insert the packet ahead of the translation misses
-  auto fwd_pkt = packet;
-  fwd_pkt.forward_checked = false;
-  queue.push_back(fwd_pkt);
+  queue.push_back(packet);
+  queue.back().forward_checked = false;
 
   return true;
 }
@@ -170,8 +166,7 @@ bool champsim::channel::add_pq(const request_type& packet)
 {
   sim_stats.PQ_ACCESS++;
 
-  auto fwd_pkt = packet;
-  auto result = do_add_queue(PQ, PQ_SIZE, fwd_pkt);
+  auto result = do_add_queue(PQ, PQ_SIZE, packet);
   if (result)
     sim_stats.PQ_TO_CACHE++;
   else
@@ -0,0 +1,343 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dram_cache.h"
+
+#include <algorithm>
+
+#include "champsim.h"
+#include "champsim_constants.h"
+#include "deadlock.h"
+#include "dram_controller.h"
+#include "instruction.h"
+#include "util/span.h"
+#include <fmt/core.h>
+
+DRAM_CACHE::mshr_type::mshr_type(const request_type& req, uint64_t cycle)
+    : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), pf_metadata(req.pf_metadata), cpu(req.cpu), type(req.type),
+      cycle_enqueued(cycle), instr_depend_on_me(req.instr_depend_on_me)
+{
+}
+
+DRAM_CACHE::DRAM_CACHE(Builder b)
+    : champsim::operable(b.m_freq_scale), block(b.m_sets), banks(b.m_channels * b.m_banks), bus_ready_cycle(b.m_channels), miss_predictor(b.m_predictor_size),
+      upper_levels(std::move(b.m_uls)), lower_level(b.m_ll), NAME(b.m_name), NUM_SET(b.m_sets), MSHR_SIZE(b.m_mshr_size), MAX_TAG(b.m_max_tag_check),
+      MAX_FILL(b.m_max_fill), CHANNELS(b.m_channels), BANKS(b.m_banks), TADS_PER_ROW(std::max<std::size_t>(1, b.m_row_size / TAD_SIZE)),
+      tRP(cycles(b.m_t_rp / 1000, b.m_io_freq)), tRCD(cycles(b.m_t_rcd / 1000, b.m_io_freq)), tCAS(cycles(b.m_t_cas / 1000, b.m_io_freq)),
+      BURST_CYCLES((TAD_SIZE + b.m_channel_width - 1) / b.m_channel_width)
+{
+}
+
+std::size_t DRAM_CACHE::get_set_index(uint64_t address) const { return (address >> LOG2_BLOCK_SIZE) & champsim::bitmask(champsim::lg2(NUM_SET)); }
+
+std::size_t DRAM_CACHE::predictor_index(uint64_t ip, uint32_t cpu) const { return ((ip >> 2) ^ (uint64_t{cpu} << 7)) % std::size(miss_predictor); }
+
+bool DRAM_CACHE::predict_miss(uint64_t ip, uint32_t cpu) const
+{
+  return !std::empty(miss_predictor) && miss_predictor[predictor_index(ip, cpu)] >= PREDICTOR_THRESHOLD;
+}
+
+// Reserve the bank and the data bus for one TAD transfer, and return the cycle at which it completes
+uint64_t DRAM_CACHE::schedule_access(std::size_t set)
+{
+  auto chan = set % CHANNELS;
+  auto& bank = banks[chan * BANKS + (set / CHANNELS) % BANKS];
+  auto row = set / (CHANNELS * BANKS * TADS_PER_ROW);
+
+  auto start = std::max(current_cycle, bank.ready_cycle);
+  auto latency = tCAS;
+  if (bank.open_row == row) {
+    ++sim_stats.ROW_BUFFER_HIT;
+  } else {
+    latency += tRCD + (bank.open_row != std::numeric_limits<uint64_t>::max() ? tRP : 0);
+    bank.open_row = row;
+    ++sim_stats.ROW_BUFFER_MISS;
+  }
+
+  bank.ready_cycle = start + latency;
+  bus_ready_cycle[chan] = std::max(bank.ready_cycle, bus_ready_cycle[chan]) + BURST_CYCLES;
+  return bus_ready_cycle[chan];
+}
+
+long DRAM_CACHE::operate()
+{
+  long progress{0};
+
+  std::for_each(std::cbegin(lower_level->returned), std::cend(lower_level->returned), [this](const auto& pkt) { this->finish_packet(pkt); });
+  progress += std::distance(std::cbegin(lower_level->returned), std::cend(lower_level->returned));
+  lower_level->returned.clear();
+
+  // Send dirty victims to memory
+  auto wb_end = std::find_if_not(std::begin(writebacks), std::end(writebacks), [this](const auto& pkt) { return this->lower_level->add_wq(pkt); });
+  progress += std::distance(std::begin(writebacks), wb_end);
+  writebacks.erase(std::begin(writebacks), wb_end);
+
+  auto fill_bw = MAX_FILL;
+  for (auto& mshr_entry : MSHR) {
+    if (fill_bw > 0 && !mshr_entry.lookup_done && mshr_entry.event_cycle <= current_cycle) {
+      finish_lookup(mshr_entry);
+      --fill_bw;
+      ++progress;
+    }
+
+    // Misses that were predicted to hit go to memory once the lookup finds them
+    if (mshr_entry.lookup_done && !mshr_entry.hit && !mshr_entry.memory_issued && issue_read(mshr_entry))
+      ++progress;
+  }
+
+  auto is_done = [](const mshr_type& x) { return x.lookup_done && (x.hit ? (x.memory_returned || !x.memory_issued) : x.memory_returned); };
+  MSHR.erase(std::remove_if(std::begin(MSHR), std::end(MSHR), is_done), std::end(MSHR));
+
+  auto tag_bw = MAX_TAG;
+  for (auto ul : upper_levels) {
+    auto [rq_begin, rq_end] =
+        champsim::get_span_p(std::cbegin(ul->RQ), std::cend(ul->RQ), tag_bw, [ul, this](const auto& pkt) { return this->handle_read(pkt, ul); });
+    tag_bw -= std::distance(rq_begin, rq_end);
+    progress += std::distance(rq_begin, rq_end);
+    ul->RQ.erase(rq_begin, rq_end);
+
+    auto [wq_begin, wq_end] = champsim::get_span_p(std::cbegin(ul->WQ), std::cend(ul->WQ), tag_bw, [this](const auto& pkt) { return this->handle_write(pkt); });
+    tag_bw -= std::distance(wq_begin, wq_end);
+    progress += std::distance(wq_begin, wq_end);
+    ul->WQ.erase(wq_begin, wq_end);
+
+    auto [pq_begin, pq_end] =
+        champsim::get_span_p(std::cbegin(ul->PQ), std::cend(ul->PQ), tag_bw, [ul, this](const auto& pkt) { return this->handle_read(pkt, ul); });
+    tag_bw -= std::distance(pq_begin, pq_end);
+    progress += std::distance(pq_begin, pq_end);
+    ul->PQ.erase(pq_begin, pq_end);
+  }
+
+  return progress;
+}
+
+bool DRAM_CACHE::handle_read(const request_type& handle_pkt, channel_type* ul)
+{
+  // Merge with a request for the same block that has not yet responded
+  auto found = std::find_if(std::begin(MSHR), std::end(MSHR), [addr = handle_pkt.address](const auto& entry) {
+    return (entry.address >> LOG2_BLOCK_SIZE) == (addr >> LOG2_BLOCK_SIZE) && !(entry.lookup_done && entry.hit);
+  });
+  if (found != std::end(MSHR)) {
+    champsim::set_union_into(found->instr_depend_on_me, handle_pkt.instr_depend_on_me, ooo_model_instr::program_order);
+    if (handle_pkt.response_requested)
+      champsim::set_union_into(found->to_return, channel_type::return_list_type{&ul->returned});
+    return true;
+  }
+
+  if (std::size(MSHR) >= MSHR_SIZE)
+    return false;
+
+  mshr_type to_allocate{handle_pkt, current_cycle};
+  if (handle_pkt.response_requested)
+    to_allocate.to_return = {&ul->returned};
+
+  to_allocate.event_cycle = warmup ? current_cycle : schedule_access(get_set_index(handle_pkt.address));
+  to_allocate.predicted_miss = predict_miss(handle_pkt.ip, handle_pkt.cpu);
+  if (to_allocate.predicted_miss)
+    issue_read(to_allocate);
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} address: {:#x} type: {} predicted_miss: {} event: {} current: {}\n", NAME, __func__, to_allocate.address,
+               access_type_names.at(champsim::to_underlying(to_allocate.type)), to_allocate.predicted_miss, to_allocate.event_cycle, current_cycle);
+  }
+
+  MSHR.push_back(std::move(to_allocate));
+  return true;
+}
+
+bool DRAM_CACHE::handle_write(const request_type& handle_pkt)
+{
+  if (std::size(writebacks) >= MSHR_SIZE)
+    return false;
+
+  // Writing a TAD requires reading it first, to find whether the victim is dirty
+  auto set = get_set_index(handle_pkt.address);
+  if (!warmup)
+    schedule_access(set);
+
+  auto& blk = block[set];
+  bool hit = blk.valid && (blk.address >> LOG2_BLOCK_SIZE) == (handle_pkt.address >> LOG2_BLOCK_SIZE);
+  if (hit) {
+    ++sim_stats.hits.at(champsim::to_underlying(handle_pkt.type));
+  } else {
+    ++sim_stats.misses.at(champsim::to_underlying(handle_pkt.type));
+    evict(set);
+  }
+
+  blk = {true, true, handle_pkt.address};
+  return true;
+}
+
+void DRAM_CACHE::finish_lookup(mshr_type& mshr_entry)
+{
+  const auto& blk = block[get_set_index(mshr_entry.address)];
+  mshr_entry.lookup_done = true;
+  mshr_entry.hit = blk.valid && (blk.address >> LOG2_BLOCK_SIZE) == (mshr_entry.address >> LOG2_BLOCK_SIZE);
+
+  if (mshr_entry.hit)
+    ++sim_stats.hits.at(champsim::to_underlying(mshr_entry.type));
+  else
+    ++sim_stats.misses.at(champsim::to_underlying(mshr_entry.type));
+
+  if (!std::empty(miss_predictor)) {
+    auto& counter = miss_predictor[predictor_index(mshr_entry.ip, mshr_entry.cpu)];
+    if (mshr_entry.hit && counter > 0)
+      --counter;
+    else if (!mshr_entry.hit && counter < PREDICTOR_MAX)
+      ++counter;
+
+    if (mshr_entry.predicted_miss != mshr_entry.hit)
+      ++sim_stats.predictor_correct;
+    else if (mshr_entry.hit)
+      ++sim_stats.predictor_wasted_fetch;
+    else
+      ++sim_stats.predictor_late_miss;
+  }
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} address: {:#x} hit: {} memory_returned: {} current: {}\n", NAME, __func__, mshr_entry.address, mshr_entry.hit,
+               mshr_entry.memory_returned, current_cycle);
+  }
+
+  if (mshr_entry.hit) {
+    respond(mshr_entry);
+  } else if (mshr_entry.memory_returned) {
+    fill(mshr_entry);
+    respond(mshr_entry);
+  }
+}
+
+void DRAM_CACHE::finish_packet(const response_type& packet)
+{
+  // A request that already responded from a hit is not merged with, so several entries may be waiting on the same block. The lower level may have merged
+  // their reads, so the response completes all of them.
+  for (auto& mshr_entry : MSHR) {
+    if (!mshr_entry.memory_issued || mshr_entry.memory_returned || (mshr_entry.address >> LOG2_BLOCK_SIZE) != (packet.address >> LOG2_BLOCK_SIZE))
+      continue;
+
+    mshr_entry.memory_returned = true;
+    mshr_entry.data = packet.data;
+
+    if constexpr (champsim::debug_print) {
+      fmt::print("[{}] {} address: {:#x} lookup_done: {} hit: {} current: {}\n", NAME, __func__, mshr_entry.address, mshr_entry.lookup_done, mshr_entry.hit,
+                 current_cycle);
+    }
+
+    // A block that hit in the cache was already returned, so the memory's copy is discarded
+    if (mshr_entry.lookup_done && !mshr_entry.hit) {
+      fill(mshr_entry);
+      respond(mshr_entry);
+    }
+  }
+}
+
+bool DRAM_CACHE::issue_read(mshr_type& mshr_entry)
+{
+  request_type fwd_pkt;
+  fwd_pkt.address = mshr_entry.address;
+  fwd_pkt.v_address = mshr_entry.v_address;
+  fwd_pkt.data = mshr_entry.data;
+  fwd_pkt.ip = mshr_entry.ip;
+  fwd_pkt.pf_metadata = mshr_entry.pf_metadata;
+  fwd_pkt.cpu = mshr_entry.cpu;
+  fwd_pkt.type = mshr_entry.type;
+  fwd_pkt.response_requested = true;
+
+  if (mshr_entry.type == access_type::PREFETCH)
+    mshr_entry.memory_issued = lower_level->add_pq(fwd_pkt);
+  else
+    mshr_entry.memory_issued = lower_level->add_rq(fwd_pkt);
+
+  return mshr_entry.memory_issued;
+}
+
+void DRAM_CACHE::fill(const mshr_type& mshr_entry)
+{
+  auto set = get_set_index(mshr_entry.address);
+  auto& blk = block[set];
+
+  // A write may have installed the block while it was being fetched
+  if (!blk.valid || (blk.address >> LOG2_BLOCK_SIZE) != (mshr_entry.address >> LOG2_BLOCK_SIZE)) {
+    evict(set);
+    blk = {true, false, mshr_entry.address};
+  }
+
+  if (!warmup)
+    schedule_access(set);
+
+  sim_stats.total_miss_latency += current_cycle - mshr_entry.cycle_enqueued;
+}
+
+void DRAM_CACHE::evict(std::size_t set)
+{
+  const auto& blk = block[set];
+  if (blk.valid && blk.dirty) {
+    request_type writeback_packet;
+    writeback_packet.address = blk.address;
+    writeback_packet.v_address = blk.address;
+    writeback_packet.type = access_type::WRITE;
+    writeback_packet.response_requested = false;
+
+    writebacks.push_back(writeback_packet);
+    ++sim_stats.writebacks;
+  }
+}
+
+void DRAM_CACHE::respond(const mshr_type& mshr_entry)
+{
+  response_type response{mshr_entry.address, mshr_entry.v_address, mshr_entry.data, mshr_entry.pf_metadata, mshr_entry.instr_depend_on_me};
+  response.miss_depth = mshr_entry.hit ? 0 : 1;
+  response.served_by_memory = !mshr_entry.hit;
+  for (auto ret : mshr_entry.to_return)
+    ret->push_back(response);
+}
+
+void DRAM_CACHE::initialize()
+{
+  fmt::print("{} DRAM cache Size: {} MiB Channels: {} Banks: {} Miss predictor entries: {}\n", NAME, (std::size(block) * BLOCK_SIZE) >> 20, CHANNELS, BANKS,
+             std::size(miss_predictor));
+}
+
+void DRAM_CACHE::begin_phase()
+{
+  stats_type new_roi_stats, new_sim_stats;
+
+  new_roi_stats.name = NAME;
+  new_sim_stats.name = NAME;
+
+  roi_stats = new_roi_stats;
+  sim_stats = new_sim_stats;
+
+  for (auto ul : upper_levels) {
+    channel_type::stats_type ul_new_roi_stats, ul_new_sim_stats;
+    ul->roi_stats = ul_new_roi_stats;
+    ul->sim_stats = ul_new_sim_stats;
+  }
+}
+
+void DRAM_CACHE::end_phase(unsigned) { roi_stats = sim_stats; }
+
+// LCOV_EXCL_START Exclude the following function from LCOV
+void DRAM_CACHE::print_deadlock()
+{
+  champsim::range_print_deadlock(MSHR, NAME + "_MSHR", "address: {:#x} type: {} lookup_done: {} hit: {} memory_issued: {} memory_returned: {} event_cycle: {}",
+                                 [](const auto& entry) {
+                                   return std::tuple{entry.address, access_type_names.at(champsim::to_underlying(entry.type)), entry.lookup_done, entry.hit,
+                                                     entry.memory_issued, entry.memory_returned, entry.event_cycle};
+                                 });
+  champsim::range_print_deadlock(writebacks, NAME + "_writebacks", "address: {:#x}", [](const auto& entry) { return std::tuple{entry.address}; });
+}
+// LCOV_EXCL_STOP
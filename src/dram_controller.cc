@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <cfenv>
 #include <cmath>
+#include <functional>
 
 #include "champsim_constants.h"
 #include "deadlock.h"
@@ -34,10 +35,17 @@ uint64_t cycles(double time, int io_freq)
 }
 
 MEMORY_CONTROLLER::MEMORY_CONTROLLER(double freq_scale, int io_freq, double t_rp, double t_rcd, double t_cas, double turnaround,
-                                     std::vector<channel_type*>&& ul)
+                                     std::vector<channel_type*>&& ul, FAR_MEMORY far)
     : champsim::operable(freq_scale), queues(std::move(ul)), tRP(cycles(t_rp / 1000, io_freq)), tRCD(cycles(t_rcd / 1000, io_freq)),
       tCAS(cycles(t_cas / 1000, io_freq)), DRAM_DBUS_TURN_AROUND_TIME(cycles(turnaround / 1000, io_freq)),
-      DRAM_DBUS_RETURN_TIME(cycles(std::ceil(BLOCK_SIZE) / std::ceil(DRAM_CHANNEL_WIDTH), 1))
+      DRAM_DBUS_RETURN_TIME(cycles(std::ceil(BLOCK_SIZE) / std::ceil(DRAM_CHANNEL_WIDTH), 1)), far_memory(std::move(far))
+{
+}
+
+FAR_MEMORY::FAR_MEMORY(int io_freq, std::size_t link_queue_size, double link_latency, double device_latency, double transfer_time, unsigned migration_threshold,
+                       std::size_t migration_pages)
+    : LINK_QUEUE_SIZE(link_queue_size), LINK_LATENCY(cycles(link_latency / 1000, io_freq)), DEVICE_LATENCY(cycles(device_latency / 1000, io_freq)),
+      TRANSFER_CYCLES(std::max<uint64_t>(1, cycles(transfer_time / 1000, io_freq))), MIGRATION_THRESHOLD(migration_threshold), MIGRATION_PAGES(migration_pages)
 {
 }
 
@@ -47,24 +55,28 @@ long MEMORY_CONTROLLER::operate()
 
   initiate_requests();
 
+  progress += far_memory.operate(current_cycle, warmup);
+
   for (auto& channel : channels) {
     if (warmup) {
-      for (auto& entry : channel.RQ) {
-        if (entry.has_value()) {
-          response_type response{entry->address, entry->v_address, entry->data, entry->pf_metadata, entry->instr_depend_on_me};
-          for (auto ret : entry.value().to_return)
+      for (auto entry = std::begin(channel.RQ); entry != std::end(channel.RQ); ++entry) {
+        if (entry->has_value()) {
+          response_type response{entry->value().address, entry->value().v_address, entry->value().data, entry->value().pf_metadata,
+                                 entry->value().instr_depend_on_me};
+          response.served_by_memory = true;
+          for (auto ret : entry->value().to_return)
             ret->push_back(response);
 
           ++progress;
-          entry.reset();
+          channel.release(entry);
         }
       }
 
-      for (auto& entry : channel.WQ) {
-        if (entry.has_value()) {
+      for (auto entry = std::begin(channel.WQ); entry != std::end(channel.WQ); ++entry) {
+        if (entry->has_value()) {
           ++progress;
         }
-        entry.reset();
+        channel.release(entry);
       }
     }
 
@@ -76,12 +88,13 @@ long MEMORY_CONTROLLER::operate()
       response_type response{channel.active_request->pkt->value().address, channel.active_request->pkt->value().v_address,
                              channel.active_request->pkt->value().data, channel.active_request->pkt->value().pf_metadata,
                              channel.active_request->pkt->value().instr_depend_on_me};
+      response.served_by_memory = true;
       for (auto ret : channel.active_request->pkt->value().to_return)
         ret->push_back(response);
 
       channel.active_request->valid = false;
 
-      channel.active_request->pkt->reset();
+      channel.release(channel.active_request->pkt);
       channel.active_request = std::end(channel.bank_request);
       ++progress;
     }
@@ -192,6 +205,10 @@ void MEMORY_CONTROLLER::initialize()
   else
     fmt::print("{} MiB", dram_size);
   fmt::print(" Channels: {} Width: {}-bit Data Race: {} MT/s\n", DRAM_CHANNELS, 8 * DRAM_CHANNEL_WIDTH, DRAM_IO_FREQ);
+  if (far_memory.enabled()) {
+    fmt::print("Far memory above {:#x} Link queue: {} Link latency: {} cycles Device latency: {} cycles Transfer: {} cycles\n", size(),
+               far_memory.LINK_QUEUE_SIZE, far_memory.LINK_LATENCY, far_memory.DEVICE_LATENCY, far_memory.TRANSFER_CYCLES);
+  }
 }
 
 void MEMORY_CONTROLLER::begin_phase()
@@ -203,6 +220,10 @@ void MEMORY_CONTROLLER::begin_phase()
     chan.sim_stats = new_stats;
   }
 
+  FAR_MEMORY::stats_type new_far_stats;
+  new_far_stats.name = "Far memory";
+  far_memory.sim_stats = new_far_stats;
+
   for (auto ul : queues) {
     channel_type::stats_type ul_new_roi_stats, ul_new_sim_stats;
     ul->roi_stats = ul_new_roi_stats;
@@ -215,19 +236,43 @@ void MEMORY_CONTROLLER::end_phase(unsigned)
   for (auto& chan : channels) {
     chan.roi_stats = chan.sim_stats;
   }
+  far_memory.roi_stats = far_memory.sim_stats;
+}
+
+auto DRAM_CHANNEL::insert(queue_type& queue, request_type packet) -> queue_type::iterator
+{
+  // Find empty slot
+  auto slot = std::find_if_not(std::begin(queue), std::end(queue), [](const auto& pkt) { return pkt.has_value(); });
+  if (slot != std::end(queue)) {
+    auto& index = (&queue == &WQ) ? wq_index : rq_index;
+    index.insert(packet.address, static_cast<uint64_t>(std::distance(std::begin(queue), slot)));
+    *slot = std::move(packet);
+  }
+
+  return slot;
+}
+
+void DRAM_CHANNEL::release(queue_type::iterator slot)
+{
+  if (!slot->has_value())
+    return;
+
+  auto in_range = [ptr = &*slot](const queue_type& queue) {
+    return !std::less<const void*>{}(ptr, std::data(queue)) && std::less<const void*>{}(ptr, std::data(queue) + std::size(queue));
+  };
+  auto& queue = in_range(WQ) ? WQ : RQ;
+  auto& index = in_range(WQ) ? wq_index : rq_index;
+
+  index.erase(slot->value().address, static_cast<uint64_t>(std::distance(std::begin(queue), slot)));
+  slot->reset();
 }
 
 void DRAM_CHANNEL::check_collision()
 {
   for (auto wq_it = std::begin(WQ); wq_it != std::end(WQ); ++wq_it) {
     if (wq_it->has_value() && !wq_it->value().forward_checked) {
-      auto checker = [addr = wq_it->value().address, offset = LOG2_BLOCK_SIZE](const auto& pkt) {
-        return pkt.has_value() && (pkt->address >> offset) == (addr >> offset);
-      };
-      if (auto found = std::find_if(std::begin(WQ), wq_it, checker); found != wq_it) { // Forward check
-        wq_it->reset();
-      } else if (found = std::find_if(std::next(wq_it), std::end(WQ), checker); found != std::end(WQ)) { // Backward check
-        wq_it->reset();
+      if (std::size(wq_index.find(wq_it->value().address)) > 1) { // Another write to this block is already queued
+        release(wq_it);
       } else {
         wq_it->value().forward_checked = true;
       }
@@ -236,37 +281,27 @@ void DRAM_CHANNEL::check_collision()
 
   for (auto rq_it = std::begin(RQ); rq_it != std::end(RQ); ++rq_it) {
     if (rq_it->has_value() && !rq_it->value().forward_checked) {
-      auto checker = [addr = rq_it->value().address, offset = LOG2_BLOCK_SIZE](const auto& pkt) {
-        return pkt.has_value() && (pkt->address >> offset) == (addr >> offset);
-      };
-      if (auto wq_it = std::find_if(std::begin(WQ), std::end(WQ), checker); wq_it != std::end(WQ)) {
+      const auto& wq_holders = wq_index.find(rq_it->value().address);
+      const auto& rq_holders = rq_index.find(rq_it->value().address);
+      auto other_holder = std::find_if(std::begin(rq_holders), std::end(rq_holders),
+                                       [self = static_cast<uint64_t>(std::distance(std::begin(RQ), rq_it))](auto pos) { return pos != self; });
+
+      if (!std::empty(wq_holders)) {
+        auto wq_it = std::next(std::begin(WQ), static_cast<long>(wq_holders.front()));
         response_type response{rq_it->value().address, rq_it->value().v_address, rq_it->value().data, rq_it->value().pf_metadata,
                                rq_it->value().instr_depend_on_me};
+        response.served_by_memory = true;
         response.data = wq_it->value().data;
         for (auto ret : rq_it->value().to_return)
           ret->push_back(response);
 
-        rq_it->reset();
-      } else if (auto found = std::find_if(std::begin(RQ), rq_it, checker); found != rq_it) {
-        auto instr_copy = std::move(found->value().instr_depend_on_me);
-        auto ret_copy = std::move(found->value().to_return);
+        release(rq_it);
+      } else if (other_holder != std::end(rq_holders)) {
+        auto found = std::next(std::begin(RQ), static_cast<long>(*other_holder));
+        champsim::set_union_into(found->value().instr_depend_on_me, rq_it->value().instr_depend_on_me, ooo_model_instr::program_order);
+        champsim::set_union_into(found->value().to_return, rq_it->value().to_return);
 
-        std::set_union(std::begin(instr_copy), std::end(instr_copy), std::begin(rq_it->value().instr_depend_on_me), std::end(rq_it->value().instr_depend_on_me),
-                       std::back_inserter(found->value().instr_depend_on_me), ooo_model_instr::program_order);
-        std::set_union(std::begin(ret_copy), std::end(ret_copy), std::begin(rq_it->value().to_return), std::end(rq_it->value().to_return),
-                       std::back_inserter(found->value().to_return));
-
-        rq_it->reset();
-      } else if (found = std::find_if(std::next(rq_it), std::end(RQ), checker); found != std::end(RQ)) {
-        auto instr_copy = std::move(found->value().instr_depend_on_me);
-        auto ret_copy = std::move(found->value().to_return);
-
-        std::set_union(std::begin(instr_copy), std::end(instr_copy), std::begin(rq_it->value().instr_depend_on_me), std::end(rq_it->value().instr_depend_on_me),
-                       std::back_inserter(found->value().instr_depend_on_me), ooo_model_instr::program_order);
-        std::set_union(std::begin(ret_copy), std::end(ret_copy), std::begin(rq_it->value().to_return), std::end(rq_it->value().to_return),
-                       std::back_inserter(found->value().to_return));
-
-        rq_it->reset();
+        release(rq_it);
       } else {
         rq_it->value().forward_checked = true;
       }
@@ -298,12 +333,22 @@ DRAM_CHANNEL::request_type::request_type(typename champsim::channel::request_typ
 
 bool MEMORY_CONTROLLER::add_rq(const request_type& packet, champsim::channel* ul)
 {
+  if (is_far(packet.address)) {
+    FAR_MEMORY::request_type far_pkt;
+    far_pkt.pf_metadata = packet.pf_metadata;
+    far_pkt.address = packet.address;
+    far_pkt.v_address = packet.v_address;
+    far_pkt.data = packet.data;
+    far_pkt.instr_depend_on_me = packet.instr_depend_on_me;
+    if (packet.response_requested)
+      far_pkt.to_return = {&ul->returned};
+
+    return far_memory.add(far_pkt, current_cycle);
+  }
+
   auto& channel = channels[dram_get_channel(packet.address)];
 
-  // Find empty slot
-  if (auto rq_it = std::find_if_not(std::begin(channel.RQ), std::end(channel.RQ), [](const auto& pkt) { return pkt.has_value(); });
-      rq_it != std::end(channel.RQ)) {
-    *rq_it = DRAM_CHANNEL::request_type{packet};
+  if (auto rq_it = channel.insert(channel.RQ, DRAM_CHANNEL::request_type{packet}); rq_it != std::end(channel.RQ)) {
     rq_it->value().forward_checked = false;
     rq_it->value().event_cycle = current_cycle;
     if (packet.response_requested)
@@ -317,12 +362,19 @@ bool MEMORY_CONTROLLER::add_rq(const request_type& packet, champsim::channel* ul
 
 bool MEMORY_CONTROLLER::add_wq(const request_type& packet)
 {
+  if (is_far(packet.address)) {
+    FAR_MEMORY::request_type far_pkt;
+    far_pkt.is_write = true;
+    far_pkt.address = packet.address;
+    far_pkt.v_address = packet.v_address;
+    far_pkt.data = packet.data;
+
+    return far_memory.add(far_pkt, current_cycle);
+  }
+
   auto& channel = channels[dram_get_channel(packet.address)];
 
-  // search for the empty index
-  if (auto wq_it = std::find_if_not(std::begin(channel.WQ), std::end(channel.WQ), [](const auto& pkt) { return pkt.has_value(); });
-      wq_it != std::end(channel.WQ)) {
-    *wq_it = DRAM_CHANNEL::request_type{packet};
+  if (auto wq_it = channel.insert(channel.WQ, DRAM_CHANNEL::request_type{packet}); wq_it != std::end(channel.WQ)) {
     wq_it->value().forward_checked = false;
     wq_it->value().event_cycle = current_cycle;
 
@@ -370,6 +422,110 @@ uint32_t MEMORY_CONTROLLER::dram_get_row(uint64_t address)
 
 std::size_t MEMORY_CONTROLLER::size() const { return DRAM_CHANNELS * DRAM_RANKS * DRAM_BANKS * DRAM_ROWS * DRAM_COLUMNS * BLOCK_SIZE; }
 
+// Addresses above the near DRAM belong to the far tier, unless their page has been promoted
+bool MEMORY_CONTROLLER::is_far(uint64_t address) { return far_memory.enabled() && address >= size() && !far_memory.is_promoted(address); }
+
+bool FAR_MEMORY::enabled() const { return LINK_QUEUE_SIZE > 0; }
+
+bool FAR_MEMORY::is_promoted(uint64_t address)
+{
+  auto found = promoted_pages.find(address >> LOG2_PAGE_SIZE);
+  if (found == std::end(promoted_pages))
+    return false;
+
+  promoted_lru.splice(std::begin(promoted_lru), promoted_lru, found->second);
+  return true;
+}
+
+bool FAR_MEMORY::add(request_type packet, uint64_t current_cycle)
+{
+  if (std::size(link_queue) >= LINK_QUEUE_SIZE) {
+    ++sim_stats.link_full;
+    return false;
+  }
+
+  if (packet.is_write)
+    ++sim_stats.writes;
+  else
+    ++sim_stats.reads;
+
+  // Promote pages that reach the access threshold, demoting the least recently used promoted page if there is no room
+  if (MIGRATION_THRESHOLD > 0 && MIGRATION_PAGES > 0) {
+    auto page = packet.address >> LOG2_PAGE_SIZE;
+    if (++page_accesses[page] >= MIGRATION_THRESHOLD) {
+      page_accesses.erase(page);
+      promoted_lru.push_front(page);
+      promoted_pages.insert_or_assign(page, std::begin(promoted_lru));
+      ++sim_stats.promotions;
+      migration_cycles += (PAGE_SIZE / BLOCK_SIZE) * TRANSFER_CYCLES;
+
+      if (std::size(promoted_lru) > MIGRATION_PAGES) {
+        promoted_pages.erase(promoted_lru.back());
+        promoted_lru.pop_back();
+        ++sim_stats.demotions;
+        migration_cycles += (PAGE_SIZE / BLOCK_SIZE) * TRANSFER_CYCLES;
+      }
+    }
+  }
+
+  packet.cycle_enqueued = current_cycle;
+  link_queue.push_back(std::move(packet));
+  return true;
+}
+
+long FAR_MEMORY::operate(uint64_t current_cycle, bool warmup)
+{
+  long progress{0};
+
+  // Page migrations occupy the link ahead of any waiting requests
+  if (warmup) {
+    migration_cycles = 0;
+  } else if (migration_cycles > 0 && link_cycle_available <= current_cycle) {
+    link_cycle_available = current_cycle + migration_cycles;
+    migration_cycles = 0;
+  }
+
+  // Put the oldest waiting request on the link
+  while (!std::empty(link_queue) && (warmup || link_cycle_available <= current_cycle)) {
+    auto& pkt = link_queue.front();
+    if (warmup) {
+      pkt.event_cycle = current_cycle;
+    } else {
+      // Reads cross the link twice, once for the request and once for the data
+      pkt.event_cycle = current_cycle + TRANSFER_CYCLES + DEVICE_LATENCY + (pkt.is_write ? 1 : 2) * LINK_LATENCY;
+      link_cycle_available = current_cycle + TRANSFER_CYCLES;
+    }
+
+    inflight.push_back(std::move(pkt));
+    link_queue.pop_front();
+    ++progress;
+  }
+
+  // Return finished requests
+  for (auto it = std::begin(inflight); it != std::end(inflight);) {
+    if (it->event_cycle <= current_cycle) {
+      if (!it->is_write) {
+        response_type response{it->address, it->v_address, it->data, it->pf_metadata, it->instr_depend_on_me};
+        response.served_by_memory = true;
+        for (auto ret : it->to_return)
+          ret->push_back(response);
+        sim_stats.total_read_latency += current_cycle - it->cycle_enqueued;
+      }
+
+      it = inflight.erase(it);
+      ++progress;
+    } else {
+      ++it;
+    }
+  }
+
+  // Page migrations and requests in the device always finish, so they do not count toward a deadlock
+  if (link_cycle_available > current_cycle || !std::empty(inflight))
+    ++progress;
+
+  return progress;
+}
+
 // LCOV_EXCL_START Exclude the following function from LCOV
 void MEMORY_CONTROLLER::print_deadlock()
 {
@@ -378,6 +534,22 @@ void MEMORY_CONTROLLER::print_deadlock()
     fmt::print("DRAM Channel {}\n", j++);
     chan.print_deadlock();
   }
+
+  if (far_memory.enabled()) {
+    fmt::print("Far memory\n");
+    far_memory.print_deadlock();
+  }
+}
+
+void FAR_MEMORY::print_deadlock()
+{
+  std::string_view q_writer{"address: {:#x} v_addr: {:#x} write: {} event_cycle: {}"};
+  auto q_entry_pack = [](const auto& entry) {
+    return std::tuple{entry.address, entry.v_address, entry.is_write, entry.event_cycle};
+  };
+
+  champsim::range_print_deadlock(link_queue, "Link queue", q_writer, q_entry_pack);
+  champsim::range_print_deadlock(inflight, "Inflight", q_writer, q_entry_pack);
 }
 
 void DRAM_CHANNEL::print_deadlock()
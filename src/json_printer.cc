@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "stats_printer.h"
 #include <nlohmann/json.hpp>
@@ -34,10 +35,23 @@ void to_json(nlohmann::json& j, const O3_CPU::stats_type stats)
   for (auto [name, idx] : types)
     mpki.emplace(name, stats.branch_type_misses[idx]);
 
+  std::map<std::string, uint64_t> cpi_stack{};
+  for (std::size_t i = 0; i < std::size(cpi_component_names); ++i)
+    cpi_stack.emplace(cpi_component_names[i], stats.cpi_stack[i]);
+
+  std::vector<nlohmann::json> threads{};
+  for (const auto& thread : stats.threads)
+    threads.push_back(nlohmann::json{{"instructions", thread.instrs()}, {"branch mispredictions", thread.branch_mispredicts}});
+
   j = nlohmann::json{{"instructions", stats.instrs()},
                      {"cycles", stats.cycles()},
                      {"Avg ROB occupancy at mispredict", std::ceil(stats.total_rob_occupancy_at_branch_mispredict) / std::ceil(total_mispredictions)},
-                     {"mispredict", mpki}};
+                     {"mispredict", mpki},
+                     {"frontend stall cycles", stats.frontend_stall_cycles},
+                     {"Avg FTQ occupancy", std::ceil(stats.total_ftq_occupancy) / std::ceil(stats.cycles())},
+                     {"FTQ prefetches", stats.ftq_prefetches},
+                     {"CPI stack", cpi_stack},
+                     {"threads", threads}};
 }
 
 void to_json(nlohmann::json& j, const CACHE::stats_type stats)
@@ -52,6 +66,20 @@ void to_json(nlohmann::json& j, const CACHE::stats_type stats)
   statsmap.emplace("prefetch issued", stats.pf_issued);
   statsmap.emplace("useful prefetch", stats.pf_useful);
   statsmap.emplace("useless prefetch", stats.pf_useless);
+  statsmap.emplace("late prefetch", stats.pf_late);
+  statsmap.emplace("prefetch pollution", stats.pf_pollution);
+  statsmap.emplace("throttled prefetch", stats.pf_throttled);
+  statsmap.emplace("prefetch timeliness", nlohmann::json{{"lead time", stats.pf_lead_time.buckets},
+                                                        {"late by", stats.pf_late_by.buckets},
+                                                        {"unused lifetime", stats.pf_unused_lifetime.buckets}});
+  if (std::size(stats.pf_sources) > 1) {
+    std::map<std::string, nlohmann::json> sources;
+    for (const auto& source : stats.pf_sources) {
+      sources.emplace(source.name, nlohmann::json{{"requested", source.requested}, {"issued", source.issued}, {"duplicate", source.duplicate},
+                                                  {"dropped", source.dropped}, {"useful", source.useful}, {"useless", source.useless}});
+    }
+    statsmap.emplace("prefetchers", sources);
+  }
   statsmap.emplace("miss latency", stats.avg_miss_latency);
   for (const auto& type : types) {
     statsmap.emplace(type.first, nlohmann::json{{"hit", stats.hits[type.second]}, {"miss", stats.misses[type.second]}});
@@ -60,6 +88,26 @@ void to_json(nlohmann::json& j, const CACHE::stats_type stats)
   j = statsmap;
 }
 
+void to_json(nlohmann::json& j, const DRAM_CACHE::stats_type stats)
+{
+  constexpr std::array<std::pair<std::string_view, std::size_t>, 5> types{
+      {std::pair{"LOAD", champsim::to_underlying(access_type::LOAD)}, std::pair{"RFO", champsim::to_underlying(access_type::RFO)},
+       std::pair{"PREFETCH", champsim::to_underlying(access_type::PREFETCH)}, std::pair{"WRITE", champsim::to_underlying(access_type::WRITE)},
+       std::pair{"TRANSLATION", champsim::to_underlying(access_type::TRANSLATION)}}};
+
+  std::map<std::string, nlohmann::json> statsmap;
+  statsmap.emplace("ROW_BUFFER_HIT", stats.ROW_BUFFER_HIT);
+  statsmap.emplace("ROW_BUFFER_MISS", stats.ROW_BUFFER_MISS);
+  statsmap.emplace("writebacks", stats.writebacks);
+  statsmap.emplace("miss predictor",
+                   nlohmann::json{{"correct", stats.predictor_correct}, {"late miss", stats.predictor_late_miss}, {"wasted fetch", stats.predictor_wasted_fetch}});
+  for (const auto& type : types) {
+    statsmap.emplace(type.first, nlohmann::json{{"hit", stats.hits[type.second]}, {"miss", stats.misses[type.second]}});
+  }
+
+  j = statsmap;
+}
+
 void to_json(nlohmann::json& j, const DRAM_CHANNEL::stats_type stats)
 {
   j = nlohmann::json{{"RQ ROW_BUFFER_HIT", stats.RQ_ROW_BUFFER_HIT},
@@ -69,6 +117,16 @@ void to_json(nlohmann::json& j, const DRAM_CHANNEL::stats_type stats)
                      {"AVG DBUS CONGESTED CYCLE", std::ceil(stats.dbus_cycle_congested) / std::ceil(stats.dbus_count_congested)}};
 }
 
+void to_json(nlohmann::json& j, const FAR_MEMORY::stats_type stats)
+{
+  j = nlohmann::json{{"reads", stats.reads},
+                     {"writes", stats.writes},
+                     {"link full", stats.link_full},
+                     {"avg read latency", std::ceil(stats.total_read_latency) / std::ceil(stats.reads)},
+                     {"promotions", stats.promotions},
+                     {"demotions", stats.demotions}};
+}
+
 namespace champsim
 {
 void to_json(nlohmann::json& j, const champsim::phase_stats stats)
@@ -76,14 +134,22 @@ void to_json(nlohmann::json& j, const champsim::phase_stats stats)
   std::map<std::string, nlohmann::json> roi_stats;
   roi_stats.emplace("cores", stats.roi_cpu_stats);
   roi_stats.emplace("DRAM", stats.roi_dram_stats);
+  if (!std::empty(stats.roi_far_memory_stats))
+    roi_stats.emplace("far memory", stats.roi_far_memory_stats);
   for (auto x : stats.roi_cache_stats)
     roi_stats.emplace(x.name, x);
+  for (auto x : stats.roi_dram_cache_stats)
+    roi_stats.emplace(x.name, x);
 
   std::map<std::string, nlohmann::json> sim_stats;
   sim_stats.emplace("cores", stats.sim_cpu_stats);
   sim_stats.emplace("DRAM", stats.sim_dram_stats);
+  if (!std::empty(stats.sim_far_memory_stats))
+    sim_stats.emplace("far memory", stats.sim_far_memory_stats);
   for (auto x : stats.sim_cache_stats)
     sim_stats.emplace(x.name, x);
+  for (auto x : stats.sim_dram_cache_stats)
+    sim_stats.emplace(x.name, x);
 
   std::map<std::string, nlohmann::json> statsmap{{"name", stats.name}, {"traces", stats.trace_names}};
   statsmap.emplace("roi", roi_stats);
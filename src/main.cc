@@ -65,7 +65,13 @@ int main(int argc, char** argv)
   auto json_option =
       app.add_option("--json", json_file_name, "The name of the file to receive JSON output. If no name is specified, stdout will be used")->expected(0, 1);
 
-  app.add_option("traces", trace_names, "The paths to the traces")->required()->expected(NUM_CPUS)->check(CLI::ExistingFile);
+  // Each hardware thread reads its own trace
+  auto cpus = gen_environment.cpu_view();
+  auto num_contexts = std::accumulate(std::begin(cpus), std::end(cpus), std::size_t{0}, [](auto acc, const O3_CPU& cpu) { return acc + cpu.NUM_THREADS; });
+  app.add_option("traces", trace_names, "The paths to the traces, one for each thread of each core")
+      ->required()
+      ->expected(static_cast<int>(num_contexts))
+      ->check(CLI::ExistingFile);
 
   CLI11_PARSE(app, argc, argv);
 
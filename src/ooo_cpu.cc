@@ -35,21 +35,42 @@ std::chrono::seconds elapsed_time();
 long O3_CPU::operate()
 {
   long progress{0};
+  auto retired_before = num_retired;
+  auto skipped = quiescent();
+  issue_rejected = false;
+
+  if (skipped) {
+    // No stage can act this cycle, so only the cycle's accounting is done
+  } else if (MODEL == model_type::load_issuer) {
+    progress += operate_load_issuer();
+  } else {
+    progress += retire_rob();                    // retire
+    progress += complete_inflight_instruction(); // finalize execution
+    progress += execute_instruction();           // execute instructions
+    progress += schedule_instruction();          // schedule instructions
+    progress += handle_memory_return();          // finalize memory transactions
+    progress += operate_lsq();                   // execute memory transactions
+
+    progress += dispatch_instruction(); // dispatch
+    progress += decode_instruction();   // decode
+    progress += promote_to_decode();
+
+    progress += fetch_instruction(); // fetch
+    progress += check_dib();
+    progress += initialize_instruction();
+    progress += fill_fetch_target_queue();
+  }
 
-  progress += retire_rob();                    // retire
-  progress += complete_inflight_instruction(); // finalize execution
-  progress += execute_instruction();           // execute instructions
-  progress += schedule_instruction();          // schedule instructions
-  progress += handle_memory_return();          // finalize memory transactions
-  progress += operate_lsq();                   // execute memory transactions
+  sim_stats.total_ftq_occupancy += std::size(FTQ);
+  if (!std::empty(IFETCH_BUFFER) && IFETCH_BUFFER.front().fetched != COMPLETED && std::size(DECODE_BUFFER) < DECODE_BUFFER_SIZE)
+    ++sim_stats.frontend_stall_cycles;
 
-  progress += dispatch_instruction(); // dispatch
-  progress += decode_instruction();   // decode
-  progress += promote_to_decode();
+  account_cycle(num_retired - retired_before);
 
-  progress += fetch_instruction(); // fetch
-  progress += check_dib();
-  initialize_instruction();
+  if (!skipped) {
+    wake_cycle = (progress == 0 && !issue_rejected) ? next_wake_cycle() : 0;
+    quiescent_input_size = input_size();
+  }
 
   // heartbeat
   if (show_heartbeat && (num_retired >= next_print_instruction)) {
@@ -70,6 +91,167 @@ long O3_CPU::operate()
   return progress;
 }
 
+bool O3_CPU::quiescent() const
+{
+  return current_cycle < wake_cycle && std::empty(L1I_bus.lower_level->returned) && std::empty(L1D_bus.lower_level->returned)
+         && input_size() == quiescent_input_size;
+}
+
+std::size_t O3_CPU::input_size() const
+{
+  return std::accumulate(std::begin(threads), std::end(threads), std::size_t{0}, [](auto acc, const auto& ctx) { return acc + std::size(ctx.input_queue); });
+}
+
+uint64_t O3_CPU::next_wake_cycle()
+{
+  // Every stage that could act this cycle has stalled on room in a later stage, on a memory return, or on an event cycle that has not come.
+  // Room is only freed when some stage acts, so the earliest event cycle still to come is the first cycle in which anything can change.
+  uint64_t wake = std::numeric_limits<uint64_t>::max();
+  auto consider = [&wake, cycle = current_cycle](uint64_t event_cycle) {
+    if (event_cycle >= cycle)
+      wake = std::min(wake, event_cycle);
+  };
+
+  for (auto stage : {ROB, DISPATCH_BUFFER, DECODE_BUFFER, IFETCH_BUFFER, FTQ})
+    std::for_each(std::begin(stage), std::end(stage), [consider](const ooo_model_instr& x) { consider(x.event_cycle); });
+  for (const auto& lq_entry : LQ) {
+    if (lq_entry.has_value())
+      consider(lq_entry->event_cycle);
+  }
+  std::for_each(std::begin(SQ), std::end(SQ), [consider](const LSQ_ENTRY& x) { consider(x.event_cycle); });
+  std::for_each(std::begin(threads), std::end(threads), [consider](const thread_context& ctx) { consider(ctx.fetch_resume_cycle); });
+
+  // Stages that compare strictly against the event cycle act one cycle later, so waking on the event cycle itself is early enough
+  return std::max(wake, current_cycle + 1);
+}
+
+void O3_CPU::account_cycle(uint64_t retired)
+{
+  auto component = cpi_component::EXECUTION;
+  if (retired > 0) {
+    component = cpi_component::RETIRING;
+  } else if (std::empty(ROB)) {
+    auto recovering = std::any_of(std::begin(threads), std::end(threads), [cycle = current_cycle](const auto& ctx) { return cycle < ctx.fetch_resume_cycle; });
+    component = recovering ? cpi_component::BRANCH_RECOVERY : cpi_component::FRONTEND;
+  } else if (const auto& head = ROB.front();
+             head.executed == INFLIGHT && !std::empty(head.source_memory) && head.completed_mem_ops < head.num_mem_ops()) {
+    auto [lq_begin, lq_end] = lq_instr_index.equal_range(head.instr_id);
+    auto head_unissued = std::any_of(lq_begin, lq_end, [this](const auto& entry) { return !this->LQ[entry.second]->fetch_issued; });
+    if (!(memory_queue_rejected && head_unissued)) {
+      // The level that serves the load is not known until it returns
+      ++pending_load_stall_cycles;
+      return;
+    }
+    component = cpi_component::MEMORY_QUEUE_FULL;
+  } else if (std::empty(lq_free_slots) || std::size(SQ) >= SQ_SIZE) {
+    component = cpi_component::LSQ_FULL;
+  }
+
+  ++sim_stats.cpi_stack[champsim::to_underlying(component)];
+}
+
+long O3_CPU::operate_load_issuer()
+{
+  long progress{0};
+
+  progress += retire_rob();
+  progress += complete_inflight_instruction();
+  progress += handle_memory_return();
+  progress += operate_lsq();
+  progress += admit_to_window();
+
+  return progress;
+}
+
+long O3_CPU::admit_to_window()
+{
+  auto thread = select_fetch_thread();
+  if (!thread.has_value())
+    return 0;
+
+  auto window_idle = [this, thread]() {
+    return std::all_of(std::begin(ROB), std::end(ROB), [thread](const ooo_model_instr& x) { return x.thread_id != *thread || x.executed == COMPLETED; });
+  };
+
+  auto& input_queue = threads[*thread].input_queue;
+  auto issue_bw = ISSUE_WIDTH;
+  while (issue_bw > 0 && !std::empty(input_queue) && window_has_room(*thread, input_queue.front(), MLP_WINDOW)
+         && (!DEPENDENT_LOADS || input_queue.front().num_mem_ops() == 0 || window_idle())) {
+    auto& instr = ROB.emplace_back(take_input(*thread));
+    ++threads[*thread].rob_occupancy;
+    last_fetch_thread = *thread;
+
+    // Only memory operations are modeled, so the instruction begins execution immediately
+    instr.source_registers.clear();
+    instr.destination_registers.clear();
+    instr.fetched = COMPLETED;
+    instr.decoded = COMPLETED;
+    instr.scheduled = COMPLETED;
+    instr.executed = INFLIGHT;
+    instr.event_cycle = current_cycle;
+
+    do_memory_scheduling(instr);
+    execution_wheel.schedule(instr.event_cycle, instr);
+    --issue_bw;
+  }
+
+  return ISSUE_WIDTH - issue_bw;
+}
+
+std::optional<std::size_t> O3_CPU::select_fetch_thread() const
+{
+  auto can_fetch = [cycle = current_cycle](const thread_context& ctx) { return !std::empty(ctx.input_queue) && cycle >= ctx.fetch_resume_cycle; };
+
+  // Threads are considered starting after the last one to fetch, so that ties go to each in turn
+  std::optional<std::size_t> selected;
+  for (std::size_t offset = 1; offset <= std::size(threads); ++offset) {
+    auto idx = (last_fetch_thread + offset) % std::size(threads);
+    if (can_fetch(threads[idx])) {
+      if (FETCH_POLICY == fetch_policy_type::round_robin)
+        return idx;
+      if (!selected.has_value() || threads[idx].in_flight < threads[*selected].in_flight)
+        selected = idx;
+    }
+  }
+
+  return selected;
+}
+
+ooo_model_instr O3_CPU::take_input(std::size_t thread)
+{
+  auto& ctx = threads.at(thread);
+  auto instr = std::move(ctx.input_queue.front());
+  ctx.input_queue.pop_front();
+
+  instr.instr_id = next_instr_id++;
+  instr.thread_id = static_cast<uint8_t>(thread);
+  ++ctx.in_flight;
+
+  return instr;
+}
+
+std::size_t O3_CPU::thread_share(std::size_t size) const { return PARTITIONED_QUEUES ? size / NUM_THREADS : size; }
+
+bool O3_CPU::window_has_room(std::size_t thread, const ooo_model_instr& instr, std::size_t window_size) const
+{
+  auto loads = std::size(instr.source_memory);
+  auto stores = std::size(instr.destination_memory);
+  if (std::size(ROB) >= window_size || std::size(lq_free_slots) < loads || std::size(SQ) + stores > SQ_SIZE)
+    return false;
+
+  const auto& ctx = threads.at(thread);
+  return !PARTITIONED_QUEUES
+         || (ctx.rob_occupancy < thread_share(window_size) && ctx.lq_occupancy + loads <= thread_share(std::size(LQ))
+             && ctx.sq_occupancy + stores <= thread_share(SQ_SIZE));
+}
+
+uint64_t O3_CPU::sim_thread_instr() const
+{
+  auto thread_instr = [](const thread_context& ctx) { return ctx.num_retired - ctx.begin_phase_instr; };
+  return std::accumulate(std::begin(threads), std::end(threads), std::numeric_limits<uint64_t>::max(),
+                         [thread_instr](auto acc, const auto& ctx) { return std::min(acc, thread_instr(ctx)); });
+}
+
 void O3_CPU::initialize()
 {
   // BRANCH PREDICTOR & BTB
@@ -81,12 +263,18 @@ void O3_CPU::begin_phase()
 {
   begin_phase_instr = num_retired;
   begin_phase_cycle = current_cycle;
+  pending_load_stall_cycles = 0;
+  wake_cycle = 0;
 
   // Record where the next phase begins
   stats_type stats;
   stats.name = "CPU " + std::to_string(cpu);
   stats.begin_instrs = num_retired;
   stats.begin_cycles = current_cycle;
+  for (auto& ctx : threads) {
+    ctx.begin_phase_instr = ctx.num_retired;
+    stats.threads.push_back({ctx.num_retired, ctx.num_retired, 0});
+  }
   sim_stats = stats;
 }
 
@@ -95,6 +283,8 @@ void O3_CPU::end_phase(unsigned finished_cpu)
   // Record where the phase ended (overwrite if this is later)
   sim_stats.end_instrs = num_retired;
   sim_stats.end_cycles = current_cycle;
+  for (std::size_t thread = 0; thread < std::size(threads); ++thread)
+    sim_stats.threads.at(thread).end_instrs = threads[thread].num_retired;
 
   if (finished_cpu == this->cpu) {
     finish_phase_instr = num_retired;
@@ -104,23 +294,94 @@ void O3_CPU::end_phase(unsigned finished_cpu)
   }
 }
 
-void O3_CPU::initialize_instruction()
+long O3_CPU::initialize_instruction()
 {
   auto instrs_to_read_this_cycle = std::min(FETCH_WIDTH, static_cast<long>(IFETCH_BUFFER_SIZE - std::size(IFETCH_BUFFER)));
+  long progress{0};
+
+  if (FTQ_SIZE > 0) {
+    // Instructions in the fetch target queue were predicted when they entered it
+    while (instrs_to_read_this_cycle > 0 && !std::empty(FTQ)) {
+      instrs_to_read_this_cycle--;
+
+      auto stop_fetch = FTQ.front().branch_taken || FTQ.front().branch_mispredicted;
+      if (stop_fetch)
+        instrs_to_read_this_cycle = 0;
+
+      FTQ.advance(1);
+
+      IFETCH_BUFFER.back().event_cycle = current_cycle;
+      ++progress;
+    }
+    return progress;
+  }
+
+  auto thread = select_fetch_thread();
+  if (!thread.has_value())
+    return progress;
 
-  while (current_cycle >= fetch_resume_cycle && instrs_to_read_this_cycle > 0 && !std::empty(input_queue)) {
+  const auto& ctx = threads[*thread];
+  while (current_cycle >= ctx.fetch_resume_cycle && instrs_to_read_this_cycle > 0 && !std::empty(ctx.input_queue)) {
     instrs_to_read_this_cycle--;
+    last_fetch_thread = *thread;
 
-    auto stop_fetch = do_init_instruction(input_queue.front());
+    // Add to IFETCH_BUFFER
+    IFETCH_BUFFER.push_back(take_input(*thread));
+
+    auto stop_fetch = do_init_instruction(IFETCH_BUFFER.back());
     if (stop_fetch)
       instrs_to_read_this_cycle = 0;
 
-    // Add to IFETCH_BUFFER
-    IFETCH_BUFFER.push_back(input_queue.front());
-    input_queue.pop_front();
-
     IFETCH_BUFFER.back().event_cycle = current_cycle;
+    ++progress;
+  }
+
+  return progress;
+}
+
+long O3_CPU::fill_fetch_target_queue()
+{
+  auto instrs_to_predict_this_cycle = std::min(FETCH_WIDTH, static_cast<long>(FTQ_SIZE - std::size(FTQ)));
+  long progress{0};
+
+  auto thread = select_fetch_thread();
+  if (!thread.has_value())
+    return progress;
+
+  // The branch predictor runs ahead of fetch, and each new block on the predicted path is prefetched into the L1I
+  const auto& ctx = threads[*thread];
+  while (current_cycle >= ctx.fetch_resume_cycle && instrs_to_predict_this_cycle > 0 && !std::empty(ctx.input_queue)) {
+    instrs_to_predict_this_cycle--;
+    last_fetch_thread = *thread;
+
+    auto& instr = FTQ.emplace_back(take_input(*thread));
+    auto stop_fetch = do_init_instruction(instr);
+    if (stop_fetch)
+      instrs_to_predict_this_cycle = 0;
+
+    auto block = instr.ip >> LOG2_BLOCK_SIZE;
+    if (block != last_prefetched_block) {
+      CacheBus::request_type pf_packet;
+      pf_packet.v_address = instr.ip;
+      pf_packet.instr_id = instr.instr_id;
+      pf_packet.ip = instr.ip;
+      pf_packet.asid[0] = instr.asid[0];
+      pf_packet.asid[1] = instr.asid[1];
+
+      if constexpr (champsim::debug_print) {
+        fmt::print("[FTQ] {} instr_id: {} ip: {:#x} occupancy: {}\n", __func__, pf_packet.instr_id, pf_packet.ip, std::size(FTQ));
+      }
+
+      if (L1I_bus.issue_prefetch(pf_packet)) {
+        last_prefetched_block = block;
+        ++sim_stats.ftq_prefetches;
+      }
+    }
+
+    ++progress;
   }
+
+  return progress;
 }
 
 namespace
@@ -143,6 +404,12 @@ void do_stack_pointer_folding(ooo_model_instr& arch_instr)
     }
   }
 }
+
+void insert_in_program_order(std::vector<std::reference_wrapper<ooo_model_instr>>& queue, ooo_model_instr& instr)
+{
+  auto ins = std::upper_bound(std::begin(queue), std::end(queue), instr, ooo_model_instr::program_order);
+  queue.insert(ins, std::ref(instr));
+}
 } // namespace
 
 bool O3_CPU::do_predict_branch(ooo_model_instr& arch_instr)
@@ -169,8 +436,9 @@ bool O3_CPU::do_predict_branch(ooo_model_instr& arch_instr)
             && arch_instr.branch_taken != arch_instr.branch_prediction)) { // conditional branches are re-evaluated at decode when the target is computed
       sim_stats.total_rob_occupancy_at_branch_mispredict += std::size(ROB);
       sim_stats.branch_type_misses[arch_instr.branch_type]++;
+      sim_stats.threads.at(arch_instr.thread_id).branch_mispredicts++;
       if (!warmup) {
-        fetch_resume_cycle = std::numeric_limits<uint64_t>::max();
+        threads[arch_instr.thread_id].fetch_resume_cycle = std::numeric_limits<uint64_t>::max();
         stop_fetch = true;
         arch_instr.branch_mispredicted = 1;
       }
@@ -256,12 +524,14 @@ long O3_CPU::fetch_instruction()
   return progress;
 }
 
-bool O3_CPU::do_fetch_instruction(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end)
+bool O3_CPU::do_fetch_instruction(instr_window_type::iterator begin, instr_window_type::iterator end)
 {
   CacheBus::request_type fetch_packet;
   fetch_packet.v_address = begin->ip;
   fetch_packet.instr_id = begin->instr_id;
   fetch_packet.ip = begin->ip;
+  fetch_packet.asid[0] = begin->asid[0];
+  fetch_packet.asid[1] = begin->asid[1];
   fetch_packet.instr_depend_on_me = {begin, end};
 
   if constexpr (champsim::debug_print) {
@@ -269,7 +539,9 @@ bool O3_CPU::do_fetch_instruction(std::deque<ooo_model_instr>::iterator begin, s
                std::size(fetch_packet.instr_depend_on_me), begin->event_cycle);
   }
 
-  return L1I_bus.issue_read(fetch_packet);
+  auto success = L1I_bus.issue_read(fetch_packet);
+  issue_rejected |= !success;
+  return success;
 }
 
 long O3_CPU::promote_to_decode()
@@ -281,8 +553,7 @@ long O3_CPU::promote_to_decode()
 
   std::for_each(window_begin, window_end,
                 [cycle = current_cycle, lat = DECODE_LATENCY, warmup = warmup](auto& x) { return x.event_cycle = cycle + ((warmup || x.decoded) ? 0 : lat); });
-  std::move(window_begin, window_end, std::back_inserter(DECODE_BUFFER));
-  IFETCH_BUFFER.erase(window_begin, window_end);
+  IFETCH_BUFFER.advance(static_cast<std::size_t>(progress));
 
   return progress;
 }
@@ -306,7 +577,7 @@ long O3_CPU::decode_instruction()
         // clear the branch_mispredicted bit so we don't attempt to resume fetch again at execute
         db_entry.branch_mispredicted = 0;
         // pay misprediction penalty
-        this->fetch_resume_cycle = this->current_cycle + BRANCH_MISPREDICT_PENALTY;
+        this->threads[db_entry.thread_id].fetch_resume_cycle = this->current_cycle + BRANCH_MISPREDICT_PENALTY;
       }
     }
 
@@ -314,8 +585,7 @@ long O3_CPU::decode_instruction()
     db_entry.event_cycle = this->current_cycle + (this->warmup ? 0 : this->DISPATCH_LATENCY);
   });
 
-  std::move(window_begin, window_end, std::back_inserter(DISPATCH_BUFFER));
-  DECODE_BUFFER.erase(window_begin, window_end);
+  DECODE_BUFFER.advance(static_cast<std::size_t>(progress));
 
   return progress;
 }
@@ -327,12 +597,10 @@ long O3_CPU::dispatch_instruction()
   auto available_dispatch_bandwidth = DISPATCH_WIDTH;
 
   // dispatch DISPATCH_WIDTH instructions into the ROB
-  while (available_dispatch_bandwidth > 0 && !std::empty(DISPATCH_BUFFER) && DISPATCH_BUFFER.front().event_cycle < current_cycle && std::size(ROB) != ROB_SIZE
-         && ((std::size_t)std::count_if(std::begin(LQ), std::end(LQ), [](const auto& lq_entry) { return !lq_entry.has_value(); })
-             >= std::size(DISPATCH_BUFFER.front().source_memory))
-         && ((std::size(DISPATCH_BUFFER.front().destination_memory) + std::size(SQ)) <= SQ_SIZE)) {
-    ROB.push_back(std::move(DISPATCH_BUFFER.front()));
-    DISPATCH_BUFFER.pop_front();
+  while (available_dispatch_bandwidth > 0 && !std::empty(DISPATCH_BUFFER) && DISPATCH_BUFFER.front().event_cycle < current_cycle
+         && window_has_room(DISPATCH_BUFFER.front().thread_id, DISPATCH_BUFFER.front(), ROB_SIZE)) {
+    DISPATCH_BUFFER.advance(1);
+    ++threads[ROB.back().thread_id].rob_occupancy;
     do_memory_scheduling(ROB.back());
 
     available_dispatch_bandwidth--;
@@ -343,55 +611,78 @@ long O3_CPU::dispatch_instruction()
 
 long O3_CPU::schedule_instruction()
 {
-  auto search_bw = SCHEDULER_SIZE;
-  int progress{0};
-  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && search_bw > 0; ++rob_it) {
-    if (rob_it->scheduled == 0) {
-      do_scheduling(*rob_it);
+  // The scheduler holds the oldest SCHEDULER_SIZE instructions that have not begun execution
+  long progress{0};
+  for (; schedule_index < std::size(ROB) && scheduler_occupancy < SCHEDULER_SIZE; ++schedule_index) {
+    auto& rob_entry = ROB[schedule_index];
+    if (rob_entry.scheduled == 0) {
+      if (!do_rename(rob_entry))
+        break; // stall until retirement frees enough physical registers
+      do_scheduling(rob_entry);
       ++progress;
     }
 
-    if (rob_it->executed == 0)
-      --search_bw;
+    if (rob_entry.executed == 0)
+      ++scheduler_occupancy;
   }
 
   return progress;
 }
 
-void O3_CPU::do_scheduling(ooo_model_instr& instr)
+bool O3_CPU::do_rename(ooo_model_instr& instr)
 {
-  // Mark register dependencies
+  if (std::size(free_physical_registers) < std::size(instr.destination_registers))
+    return false;
+
+  auto& register_alias_table = threads[instr.thread_id].register_alias_table;
+
+  // Mark register dependencies on values that have not been produced yet
   for (auto src_reg : instr.source_registers) {
-    if (!std::empty(reg_producers[src_reg])) {
-      ooo_model_instr& prior = reg_producers[src_reg].back();
-      if (prior.registers_instrs_depend_on_me.empty() || prior.registers_instrs_depend_on_me.back().get().instr_id != instr.instr_id) {
-        prior.registers_instrs_depend_on_me.push_back(instr);
+    if (auto preg = register_alias_table[src_reg]; preg != NO_REGISTER && !physical_register_file[preg].ready) {
+      auto& consumers = physical_register_file[preg].consumers;
+      if (consumers.empty() || &consumers.back().get() != &instr) {
+        consumers.push_back(instr);
         instr.num_reg_dependent++;
       }
     }
   }
 
+  // Map each destination to a fresh physical register
   for (auto dreg : instr.destination_registers) {
-    auto begin = std::begin(reg_producers[dreg]);
-    auto end = std::end(reg_producers[dreg]);
-    auto ins = std::lower_bound(begin, end, instr, [](const ooo_model_instr& lhs, const ooo_model_instr& rhs) { return lhs.instr_id < rhs.instr_id; });
-    reg_producers[dreg].insert(ins, std::ref(instr));
+    auto preg = free_physical_registers.back();
+    free_physical_registers.pop_back();
+    physical_register_file[preg].ready = false;
+
+    instr.previous_physical_registers.push_back(register_alias_table[dreg]);
+    instr.destination_physical_registers.push_back(preg);
+    register_alias_table[dreg] = preg;
   }
 
+  return true;
+}
+
+void O3_CPU::do_scheduling(ooo_model_instr& instr)
+{
   instr.scheduled = COMPLETED;
   instr.event_cycle = current_cycle + (warmup ? 0 : SCHEDULING_LATENCY);
+
+  if (instr.num_reg_dependent == 0 && instr.executed == 0)
+    ::insert_in_program_order(ready_queue, instr);
 }
 
 long O3_CPU::execute_instruction()
 {
   auto exec_bw = EXEC_WIDTH;
-  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && exec_bw > 0; ++rob_it) {
-    if (rob_it->scheduled == COMPLETED && rob_it->executed == 0 && rob_it->num_reg_dependent == 0 && rob_it->event_cycle <= current_cycle) {
-      do_execution(*rob_it);
+  for (auto it = std::begin(ready_queue); it != std::end(ready_queue) && exec_bw > 0; ++it) {
+    if (it->get().event_cycle <= current_cycle) {
+      do_execution(*it);
       --exec_bw;
     }
   }
 
+  ready_queue.erase(std::remove_if(std::begin(ready_queue), std::end(ready_queue), [](const ooo_model_instr& x) { return x.executed != 0; }),
+                    std::end(ready_queue));
+
   return EXEC_WIDTH - exec_bw;
 }
 
@@ -399,16 +690,18 @@ void O3_CPU::do_execution(ooo_model_instr& rob_entry)
 {
   rob_entry.executed = INFLIGHT;
   rob_entry.event_cycle = current_cycle + (warmup ? 0 : EXEC_LATENCY);
+  execution_wheel.schedule(rob_entry.event_cycle, rob_entry);
+  --scheduler_occupancy;
 
   // Mark LQ entries as ready to translate
-  for (auto& lq_entry : LQ)
-    if (lq_entry.has_value() && lq_entry->instr_id == rob_entry.instr_id)
-      lq_entry->event_cycle = current_cycle + (warmup ? 0 : EXEC_LATENCY);
+  auto [lq_begin, lq_end] = lq_instr_index.equal_range(rob_entry.instr_id);
+  for (auto it = lq_begin; it != lq_end; ++it)
+    LQ[it->second]->event_cycle = current_cycle + (warmup ? 0 : EXEC_LATENCY);
 
-  // Mark SQ entries as ready to translate
-  for (auto& sq_entry : SQ)
-    if (sq_entry.instr_id == rob_entry.instr_id)
-      sq_entry.event_cycle = current_cycle + (warmup ? 0 : EXEC_LATENCY);
+  // Mark SQ entries as ready to translate. The SQ is in program order.
+  auto sq_begin = std::partition_point(std::begin(SQ), std::end(SQ), [id = rob_entry.instr_id](const auto& x) { return x.instr_id < id; });
+  auto sq_end = std::partition_point(sq_begin, std::end(SQ), [id = rob_entry.instr_id](const auto& x) { return x.instr_id == id; });
+  std::for_each(sq_begin, sq_end, [cycle = current_cycle + (warmup ? 0 : EXEC_LATENCY)](auto& sq_entry) { sq_entry.event_cycle = cycle; });
 
   if constexpr (champsim::debug_print) {
     fmt::print("[ROB] {} instr_id: {} event_cycle: {}\n", __func__, rob_entry.instr_id, rob_entry.event_cycle);
@@ -419,17 +712,33 @@ void O3_CPU::do_memory_scheduling(ooo_model_instr& instr)
 {
   // load
   for (auto& smem : instr.source_memory) {
-    auto q_entry = std::find_if_not(std::begin(LQ), std::end(LQ), [](const auto& lq_entry) { return lq_entry.has_value(); });
-    assert(q_entry != std::end(LQ));
-    q_entry->emplace(instr.instr_id, smem, instr.ip, instr.asid); // add it to the load queue
+    assert(!std::empty(lq_free_slots));
+    auto slot = lq_free_slots.top();
+    lq_free_slots.pop();
+    auto q_entry = std::next(std::begin(LQ), static_cast<std::ptrdiff_t>(slot));
+    q_entry->emplace(instr.instr_id, smem, instr.ip, instr.asid, instr.thread_id); // add it to the load queue
+    ++threads[instr.thread_id].lq_occupancy;
+    lq_instr_index.emplace(instr.instr_id, slot);
+    lq_block_index.insert(smem, slot);
+
+    // Check for forwarding from the youngest store to this address by the same thread. If one instruction stores to it more than once, the first
+    // of those stores forwards.
+    const auto& stores = sq_address_index.find(smem);
+    auto sq_entry_at = [this](uint64_t seq) { return std::next(std::begin(SQ), static_cast<std::ptrdiff_t>(seq - sq_base_seq)); };
+    auto youngest = std::find_if(std::rbegin(stores), std::rend(stores), [&](uint64_t seq) { return sq_entry_at(seq)->thread_id == instr.thread_id; });
+    auto sq_it = std::end(SQ);
+    if (youngest != std::rend(stores)) {
+      auto first = std::prev(youngest.base());
+      while (first != std::begin(stores) && sq_entry_at(*std::prev(first))->instr_id == sq_entry_at(*first)->instr_id)
+        --first;
+      sq_it = sq_entry_at(*first);
+    }
 
-    // Check for forwarding
-    auto sq_it = std::max_element(std::begin(SQ), std::end(SQ), [smem](const auto& lhs, const auto& rhs) {
-      return lhs.virtual_address != smem || (rhs.virtual_address == smem && lhs.instr_id < rhs.instr_id);
-    });
-    if (sq_it != std::end(SQ) && sq_it->virtual_address == smem) {
+    if (sq_it == std::end(SQ)) {
+      lq_unissued.insert(std::upper_bound(std::begin(lq_unissued), std::end(lq_unissued), slot), slot);
+    } else {
       if (sq_it->fetch_issued) { // Store already executed
-        q_entry->reset();
+        release_lq_entry(slot);
         ++instr.completed_mem_ops;
 
         if constexpr (champsim::debug_print)
@@ -446,8 +755,11 @@ void O3_CPU::do_memory_scheduling(ooo_model_instr& instr)
   }
 
   // store
-  for (auto& dmem : instr.destination_memory)
-    SQ.emplace_back(instr.instr_id, dmem, instr.ip, instr.asid); // add it to the store queue
+  for (auto& dmem : instr.destination_memory) {
+    SQ.emplace_back(instr.instr_id, dmem, instr.ip, instr.asid, instr.thread_id); // add it to the store queue
+    ++threads[instr.thread_id].sq_occupancy;
+    sq_address_index.insert(dmem, sq_base_seq + std::size(SQ) - 1);
+  }
 
   if constexpr (champsim::debug_print) {
     fmt::print("[DISPATCH] {} instr_id: {} loads: {} stores: {}\n", __func__, instr.instr_id, std::size(instr.source_memory),
@@ -459,9 +771,8 @@ long O3_CPU::operate_lsq()
 {
   auto store_bw = SQ_WIDTH;
 
-  const auto complete_id = std::empty(ROB) ? std::numeric_limits<uint64_t>::max() : ROB.front().instr_id;
-  auto do_complete = [cycle = current_cycle, complete_id, this](const auto& x) {
-    return x.instr_id < complete_id && x.event_cycle <= cycle && this->do_complete_store(x);
+  auto do_complete = [cycle = current_cycle, this](const auto& x) {
+    return x.instr_id < this->threads[x.thread_id].oldest_unretired && x.event_cycle <= cycle && this->do_complete_store(x);
   };
 
   auto unfetched_begin = std::partition_point(std::begin(SQ), std::end(SQ), [](const auto& x) { return x.fetch_issued; });
@@ -476,18 +787,25 @@ long O3_CPU::operate_lsq()
 
   auto [complete_begin, complete_end] = champsim::get_span_p(std::cbegin(SQ), std::cend(SQ), store_bw, do_complete);
   store_bw -= std::distance(complete_begin, complete_end);
+  std::for_each(complete_begin, complete_end, [this](const auto& sq_entry) {
+    this->sq_address_index.erase(sq_entry.virtual_address, this->sq_base_seq++);
+    --this->threads[sq_entry.thread_id].sq_occupancy;
+  });
   SQ.erase(complete_begin, complete_end);
 
   auto load_bw = LQ_WIDTH;
-
-  for (auto& lq_entry : LQ) {
-    if (load_bw > 0 && lq_entry.has_value() && lq_entry->producer_id == std::numeric_limits<uint64_t>::max() && !lq_entry->fetch_issued
-        && lq_entry->event_cycle < current_cycle) {
-      auto success = execute_load(*lq_entry);
-      if (success) {
-        --load_bw;
-        lq_entry->fetch_issued = true;
-      }
+  memory_queue_rejected = false;
+
+  for (auto it = std::begin(lq_unissued); it != std::end(lq_unissued) && load_bw > 0;) {
+    auto& lq_entry = LQ[*it];
+    assert(lq_entry.has_value() && lq_entry->producer_id == std::numeric_limits<uint64_t>::max() && !lq_entry->fetch_issued);
+    if (lq_entry->event_cycle < current_cycle && execute_load(*lq_entry)) {
+      --load_bw;
+      lq_entry->fetch_issued = true;
+      it = lq_unissued.erase(it);
+    } else {
+      memory_queue_rejected |= (lq_entry->event_cycle < current_cycle);
+      ++it;
     }
   }
 
@@ -504,22 +822,47 @@ void O3_CPU::do_finish_store(const LSQ_ENTRY& sq_entry)
     assert(dependent->producer_id == sq_entry.instr_id);
 
     dependent->finish(std::begin(ROB), std::end(ROB));
-    dependent.reset();
+    release_lq_entry(static_cast<std::size_t>(std::distance(std::data(LQ), &dependent)));
   }
 }
 
+void O3_CPU::release_lq_entry(std::size_t slot)
+{
+  auto& lq_entry = LQ[slot];
+  assert(lq_entry.has_value());
+
+  lq_block_index.erase(lq_entry->virtual_address, slot);
+
+  auto [instr_begin, instr_end] = lq_instr_index.equal_range(lq_entry->instr_id);
+  auto instr_it = std::find_if(instr_begin, instr_end, [slot](const auto& x) { return x.second == slot; });
+  assert(instr_it != instr_end);
+  lq_instr_index.erase(instr_it);
+
+  if (auto unissued_it = std::lower_bound(std::begin(lq_unissued), std::end(lq_unissued), slot);
+      unissued_it != std::end(lq_unissued) && *unissued_it == slot)
+    lq_unissued.erase(unissued_it);
+
+  --threads[lq_entry->thread_id].lq_occupancy;
+  lq_entry.reset();
+  lq_free_slots.push(slot);
+}
+
 bool O3_CPU::do_complete_store(const LSQ_ENTRY& sq_entry)
 {
   CacheBus::request_type data_packet;
   data_packet.v_address = sq_entry.virtual_address;
   data_packet.instr_id = sq_entry.instr_id;
   data_packet.ip = sq_entry.ip;
+  data_packet.asid[0] = sq_entry.asid[0];
+  data_packet.asid[1] = sq_entry.asid[1];
 
   if constexpr (champsim::debug_print) {
     fmt::print("[SQ] {} instr_id: {} vaddr: {:x}\n", __func__, data_packet.instr_id, data_packet.v_address);
   }
 
-  return L1D_bus.issue_write(data_packet);
+  auto success = L1D_bus.issue_write(data_packet);
+  issue_rejected |= !success;
+  return success;
 }
 
 bool O3_CPU::execute_load(const LSQ_ENTRY& lq_entry)
@@ -528,49 +871,61 @@ bool O3_CPU::execute_load(const LSQ_ENTRY& lq_entry)
   data_packet.v_address = lq_entry.virtual_address;
   data_packet.instr_id = lq_entry.instr_id;
   data_packet.ip = lq_entry.ip;
+  data_packet.asid[0] = lq_entry.asid[0];
+  data_packet.asid[1] = lq_entry.asid[1];
 
   if constexpr (champsim::debug_print) {
     fmt::print("[LQ] {} instr_id: {} vaddr: {:#x}\n", __func__, data_packet.instr_id, data_packet.v_address);
   }
 
-  return L1D_bus.issue_read(data_packet);
+  auto success = L1D_bus.issue_read(data_packet);
+  issue_rejected |= !success;
+  return success;
 }
 
 void O3_CPU::do_complete_execution(ooo_model_instr& instr)
 {
-  for (auto dreg : instr.destination_registers) {
-    auto begin = std::begin(reg_producers[dreg]);
-    auto end = std::end(reg_producers[dreg]);
-    auto elem = std::find_if(begin, end, [id = instr.instr_id](ooo_model_instr& x) { return x.instr_id == id; });
-    assert(elem != end);
-    reg_producers[dreg].erase(elem);
-  }
-
   instr.executed = COMPLETED;
 
-  for (ooo_model_instr& dependent : instr.registers_instrs_depend_on_me) {
-    dependent.num_reg_dependent--;
-    assert(dependent.num_reg_dependent >= 0);
+  // Broadcast the destination tags to the waiting instructions
+  for (auto preg : instr.destination_physical_registers) {
+    auto& reg = physical_register_file[preg];
+    reg.ready = true;
+
+    for (ooo_model_instr& dependent : reg.consumers) {
+      dependent.num_reg_dependent--;
+      assert(dependent.num_reg_dependent >= 0);
 
-    if (dependent.num_reg_dependent == 0)
-      dependent.scheduled = COMPLETED;
+      if (dependent.num_reg_dependent == 0) {
+        dependent.scheduled = COMPLETED;
+        ::insert_in_program_order(ready_queue, dependent);
+      }
+    }
+    reg.consumers.clear();
   }
 
   if (instr.branch_mispredicted)
-    fetch_resume_cycle = current_cycle + BRANCH_MISPREDICT_PENALTY;
+    threads[instr.thread_id].fetch_resume_cycle = current_cycle + BRANCH_MISPREDICT_PENALTY;
 }
 
 long O3_CPU::complete_inflight_instruction()
 {
+  // Instructions whose execution latency has elapsed wait here for their memory operations
+  execution_wheel.advance(current_cycle, [this](ooo_model_instr& instr) { ::insert_in_program_order(completion_queue, instr); });
+
   // update ROB entries with completed executions
   auto complete_bw = EXEC_WIDTH;
-  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && complete_bw > 0; ++rob_it) {
-    if ((rob_it->executed == INFLIGHT) && (rob_it->event_cycle <= current_cycle) && rob_it->completed_mem_ops == rob_it->num_mem_ops()) {
-      do_complete_execution(*rob_it);
+  for (auto it = std::begin(completion_queue); it != std::end(completion_queue) && complete_bw > 0; ++it) {
+    if (it->get().completed_mem_ops == it->get().num_mem_ops()) {
+      do_complete_execution(*it);
       --complete_bw;
     }
   }
 
+  completion_queue.erase(
+      std::remove_if(std::begin(completion_queue), std::end(completion_queue), [](const ooo_model_instr& x) { return x.executed == COMPLETED; }),
+      std::end(completion_queue));
+
   return EXEC_WIDTH - complete_bw;
 }
 
@@ -605,10 +960,14 @@ long O3_CPU::handle_memory_return()
 
   auto l1d_it = std::begin(L1D_bus.lower_level->returned);
   for (auto l1d_bw = L1D_BANDWIDTH; l1d_bw > 0 && l1d_it != std::end(L1D_bus.lower_level->returned); --l1d_bw, ++l1d_it) {
-    for (auto& lq_entry : LQ) {
-      if (lq_entry.has_value() && lq_entry->fetch_issued && lq_entry->virtual_address >> LOG2_BLOCK_SIZE == l1d_it->v_address >> LOG2_BLOCK_SIZE) {
-        lq_entry->finish(std::begin(ROB), std::end(ROB));
-        lq_entry.reset();
+    auto waiting = lq_block_index.find(l1d_it->v_address); // copied, since finished entries are removed from the index
+    for (auto slot : waiting) {
+      auto& lq_entry = LQ[slot];
+      if (lq_entry->fetch_issued) {
+        auto rob_entry = lq_entry->finish(std::begin(ROB), std::end(ROB));
+        rob_entry->miss_depth = std::max(rob_entry->miss_depth, l1d_it->miss_depth);
+        rob_entry->served_by_memory |= l1d_it->served_by_memory;
+        release_lq_entry(slot);
         ++progress;
       }
     }
@@ -621,14 +980,63 @@ long O3_CPU::handle_memory_return()
 
 long O3_CPU::retire_rob()
 {
-  auto [retire_begin, retire_end] = champsim::get_span_p(std::cbegin(ROB), std::cend(ROB), RETIRE_WIDTH, [](const auto& x) { return x.executed == COMPLETED; });
-  if constexpr (champsim::debug_print) {
-    std::for_each(retire_begin, retire_end, [](const auto& x) { fmt::print("[ROB] retire_rob instr_id: {} is retired\n", x.instr_id); });
+  // Each thread retires in its own program order, so a thread whose oldest instruction has not completed does not block the others.
+  // Instructions retired behind an unretired one are marked, and they leave the ROB once every older instruction has retired.
+  for (auto& ctx : threads)
+    ctx.retire_blocked = false;
+
+  auto retire_bw = RETIRE_WIDTH;
+  std::size_t blocked_threads = 0;
+  auto rob_it = std::begin(ROB);
+  for (; rob_it != std::end(ROB) && retire_bw > 0 && blocked_threads < std::size(threads); ++rob_it) {
+    auto& ctx = threads[rob_it->thread_id];
+    if (rob_it->retired || ctx.retire_blocked)
+      continue;
+
+    if (rob_it->executed != COMPLETED) {
+      ctx.retire_blocked = true;
+      ctx.oldest_unretired = rob_it->instr_id;
+      ++blocked_threads;
+      continue;
+    }
+
+    if constexpr (champsim::debug_print) {
+      fmt::print("[ROB] retire_rob instr_id: {} is retired\n", rob_it->instr_id);
+    }
+
+    // Charge the cycles the head waited on its loads to the level that served them
+    if (rob_it == std::begin(ROB) && pending_load_stall_cycles > 0) {
+      constexpr std::array load_components{cpi_component::LOAD_L1D, cpi_component::LOAD_L2C, cpi_component::LOAD_LLC};
+      auto component = rob_it->served_by_memory ? cpi_component::LOAD_DRAM
+                                                : load_components.at(std::min<std::size_t>(rob_it->miss_depth, std::size(load_components) - 1));
+      sim_stats.cpi_stack[champsim::to_underlying(component)] += pending_load_stall_cycles;
+      pending_load_stall_cycles = 0;
+    }
+
+    // The registers that held the previous values of the retired instruction's destinations can no longer be read
+    std::copy_if(std::begin(rob_it->previous_physical_registers), std::end(rob_it->previous_physical_registers), std::back_inserter(free_physical_registers),
+                 [](auto preg) { return preg != NO_REGISTER; });
+
+    rob_it->retired = true;
+    ++ctx.num_retired;
+    --ctx.rob_occupancy;
+    --ctx.in_flight;
+    --retire_bw;
+  }
+
+  // The oldest unretired instruction of a thread that did not block is no older than where the scan stopped
+  for (auto& ctx : threads) {
+    if (!ctx.retire_blocked)
+      ctx.oldest_unretired = (rob_it == std::end(ROB)) ? std::numeric_limits<uint64_t>::max() : rob_it->instr_id;
   }
-  auto retire_count = std::distance(retire_begin, retire_end);
-  num_retired += retire_count;
-  ROB.erase(retire_begin, retire_end);
 
+  auto retired_end = std::find_if(std::begin(ROB), std::end(ROB), [](const auto& x) { return !x.retired; });
+  auto leave_count = static_cast<std::size_t>(std::distance(std::begin(ROB), retired_end));
+  ROB.erase(std::begin(ROB), retired_end);
+  schedule_index -= std::min(schedule_index, leave_count);
+
+  auto retire_count = RETIRE_WIDTH - retire_bw;
+  num_retired += static_cast<uint64_t>(retire_count);
   return retire_count;
 }
 
@@ -668,14 +1076,14 @@ void O3_CPU::print_deadlock()
 }
 // LCOV_EXCL_STOP
 
-LSQ_ENTRY::LSQ_ENTRY(uint64_t id, uint64_t addr, uint64_t local_ip, std::array<uint8_t, 2> local_asid)
-    : instr_id(id), virtual_address(addr), ip(local_ip), asid(local_asid)
+LSQ_ENTRY::LSQ_ENTRY(uint64_t id, uint64_t addr, uint64_t local_ip, std::array<uint8_t, 2> local_asid, uint8_t thread)
+    : instr_id(id), virtual_address(addr), ip(local_ip), asid(local_asid), thread_id(thread)
 {
 }
 
-void LSQ_ENTRY::finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const
+auto LSQ_ENTRY::finish(rob_iterator begin, rob_iterator end) const -> rob_iterator
 {
-  auto rob_entry = std::partition_point(begin, end, [id = this->instr_id](auto x) { return x.instr_id < id; });
+  auto rob_entry = std::partition_point(begin, end, [id = this->instr_id](const auto& x) { return x.instr_id < id; });
   assert(rob_entry != end);
   assert(rob_entry->instr_id == this->instr_id);
 
@@ -686,6 +1094,8 @@ void LSQ_ENTRY::finish(std::deque<ooo_model_instr>::iterator begin, std::deque<o
     fmt::print("[LSQ] {} instr_id: {} full_address: {:#x} remain_mem_ops: {} event_cycle: {}\n", __func__, instr_id, virtual_address,
                rob_entry->num_mem_ops() - rob_entry->completed_mem_ops, event_cycle);
   }
+
+  return rob_entry;
 }
 
 bool CacheBus::issue_read(request_type data_packet)
@@ -708,3 +1118,14 @@ bool CacheBus::issue_write(request_type data_packet)
 
   return lower_level->add_wq(data_packet);
 }
+
+bool CacheBus::issue_prefetch(request_type data_packet)
+{
+  data_packet.address = data_packet.v_address;
+  data_packet.is_translated = false;
+  data_packet.cpu = cpu;
+  data_packet.type = access_type::PREFETCH;
+  data_packet.response_requested = false;
+
+  return lower_level->add_pq(data_packet);
+}
@@ -37,9 +37,16 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
 
   fmt::print(stream, "\n{} cumulative IPC: {:.4g} instructions: {} cycles: {}\n", stats.name, std::ceil(stats.instrs()) / std::ceil(stats.cycles()),
              stats.instrs(), stats.cycles());
+  if (std::size(stats.threads) > 1) {
+    for (std::size_t thread = 0; thread < std::size(stats.threads); ++thread)
+      fmt::print(stream, "{} thread {} IPC: {:.4g} instructions: {} branch mispredictions: {}\n", stats.name, thread,
+                 std::ceil(stats.threads[thread].instrs()) / std::ceil(stats.cycles()), stats.threads[thread].instrs(), stats.threads[thread].branch_mispredicts);
+  }
   fmt::print(stream, "{} Branch Prediction Accuracy: {:.4g}% MPKI: {:.4g} Average ROB Occupancy at Mispredict: {:.4g}\n", stats.name,
              (100.0 * std::ceil(total_branch - total_mispredictions)) / total_branch, (1000.0 * total_mispredictions) / std::ceil(stats.instrs()),
              std::ceil(stats.total_rob_occupancy_at_branch_mispredict) / total_mispredictions);
+  fmt::print(stream, "{} Front-end stall cycles: {} Average FTQ Occupancy: {:.4g} FTQ prefetches: {}\n", stats.name, stats.frontend_stall_cycles,
+             std::ceil(stats.total_ftq_occupancy) / std::ceil(stats.cycles()), stats.ftq_prefetches);
 
   std::vector<double> mpkis;
   std::transform(std::begin(stats.branch_type_misses), std::end(stats.branch_type_misses), std::back_inserter(mpkis),
@@ -49,6 +56,11 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
   for (auto [str, idx] : types)
     fmt::print(stream, "{}: {:.3}\n", str, mpkis[idx]);
   fmt::print(stream, "\n");
+
+  fmt::print(stream, "CPI stack\n");
+  for (std::size_t i = 0; i < std::size(cpi_component_names); ++i)
+    fmt::print(stream, "{}: {} cycles CPI: {:.4g}\n", cpi_component_names[i], stats.cpi_stack[i], std::ceil(stats.cpi_stack[i]) / std::ceil(stats.instrs()));
+  fmt::print(stream, "\n");
 }
 
 void champsim::plain_printer::print(CACHE::stats_type stats)
@@ -73,11 +85,44 @@ void champsim::plain_printer::print(CACHE::stats_type stats)
 
     fmt::print(stream, "{} PREFETCH REQUESTED: {:10} ISSUED: {:10} USEFUL: {:10} USELESS: {:10}\n", stats.name, stats.pf_requested, stats.pf_issued,
                stats.pf_useful, stats.pf_useless);
+    fmt::print(stream, "{} PREFETCH LATE: {:10} POLLUTION: {:10} THROTTLED: {:10}\n", stats.name, stats.pf_late, stats.pf_pollution, stats.pf_throttled);
+    if (std::size(stats.pf_sources) > 1) {
+      for (const auto& source : stats.pf_sources) {
+        fmt::print(stream, "{} PREFETCHER {:<12s} ISSUED: {:10} USEFUL: {:10} USELESS: {:10} DUPLICATE: {:10} DROPPED: {:10}\n", stats.name, source.name,
+                   source.issued, source.useful, source.useless, source.duplicate, source.dropped);
+      }
+    }
 
     fmt::print(stream, "{} AVERAGE MISS LATENCY: {:.4g} cycles\n", stats.name, stats.avg_miss_latency);
   }
 }
 
+void champsim::plain_printer::print(DRAM_CACHE::stats_type stats)
+{
+  constexpr std::array<std::pair<std::string_view, std::size_t>, 5> types{
+      {std::pair{"LOAD", champsim::to_underlying(access_type::LOAD)}, std::pair{"RFO", champsim::to_underlying(access_type::RFO)},
+       std::pair{"PREFETCH", champsim::to_underlying(access_type::PREFETCH)}, std::pair{"WRITE", champsim::to_underlying(access_type::WRITE)},
+       std::pair{"TRANSLATION", champsim::to_underlying(access_type::TRANSLATION)}}};
+
+  uint64_t TOTAL_HIT = 0, TOTAL_MISS = 0;
+  for (const auto& type : types) {
+    TOTAL_HIT += stats.hits.at(type.second);
+    TOTAL_MISS += stats.misses.at(type.second);
+  }
+
+  fmt::print(stream, "{} TOTAL        ACCESS: {:10d} HIT: {:10d} MISS: {:10d}\n", stats.name, TOTAL_HIT + TOTAL_MISS, TOTAL_HIT, TOTAL_MISS);
+  for (const auto& type : types) {
+    fmt::print(stream, "{} {:<12s} ACCESS: {:10d} HIT: {:10d} MISS: {:10d}\n", stats.name, type.first, stats.hits[type.second] + stats.misses[type.second],
+               stats.hits[type.second], stats.misses[type.second]);
+  }
+
+  fmt::print(stream, "{} ROW_BUFFER_HIT: {:10} ROW_BUFFER_MISS: {:10} WRITEBACKS: {:10}\n", stats.name, stats.ROW_BUFFER_HIT, stats.ROW_BUFFER_MISS,
+             stats.writebacks);
+  fmt::print(stream, "{} MISS PREDICTOR CORRECT: {:10} LATE MISS: {:10} WASTED FETCH: {:10}\n", stats.name, stats.predictor_correct,
+             stats.predictor_late_miss, stats.predictor_wasted_fetch);
+  fmt::print(stream, "{} AVERAGE MISS LATENCY: {:.4g} cycles\n", stats.name, std::ceil(stats.total_miss_latency) / std::ceil(TOTAL_MISS));
+}
+
 void champsim::plain_printer::print(DRAM_CHANNEL::stats_type stats)
 {
   fmt::print(stream, "\n{} RQ ROW_BUFFER_HIT: {:10}\n  ROW_BUFFER_MISS: {:10}\n", stats.name, stats.RQ_ROW_BUFFER_HIT, stats.RQ_ROW_BUFFER_MISS);
@@ -89,6 +134,16 @@ void champsim::plain_printer::print(DRAM_CHANNEL::stats_type stats)
              stats.WQ_FULL);
 }
 
+void champsim::plain_printer::print(FAR_MEMORY::stats_type stats)
+{
+  fmt::print(stream, "\n{} READS: {:10}  WRITES: {:10}  LINK FULL: {:10}\n", stats.name, stats.reads, stats.writes, stats.link_full);
+  if (stats.reads > 0)
+    fmt::print(stream, " AVG READ LATENCY: {:.4g} cycles\n", std::ceil(stats.total_read_latency) / std::ceil(stats.reads));
+  else
+    fmt::print(stream, " AVG READ LATENCY: -\n");
+  fmt::print(stream, " PROMOTIONS: {:10}  DEMOTIONS: {:10}\n", stats.promotions, stats.demotions);
+}
+
 void champsim::plain_printer::print(champsim::phase_stats& stats)
 {
   fmt::print(stream, "=== {} ===\n", stats.name);
@@ -115,9 +170,21 @@ void champsim::plain_printer::print(champsim::phase_stats& stats)
   for (const auto& stat : stats.roi_cache_stats)
     print(stat);
 
+  if (!std::empty(stats.roi_dram_cache_stats)) {
+    fmt::print(stream, "\nDRAM Cache Statistics\n");
+    for (const auto& stat : stats.roi_dram_cache_stats)
+      print(stat);
+  }
+
   fmt::print(stream, "\nDRAM Statistics\n");
   for (const auto& stat : stats.roi_dram_stats)
     print(stat);
+
+  if (!std::empty(stats.roi_far_memory_stats)) {
+    fmt::print(stream, "\nFar Memory Statistics\n");
+    for (const auto& stat : stats.roi_far_memory_stats)
+      print(stat);
+  }
 }
 
 void champsim::plain_printer::print(std::vector<phase_stats>& stats)
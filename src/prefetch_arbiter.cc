@@ -0,0 +1,73 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prefetch_arbiter.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "policy.hpp"
+
+champsim::prefetch_arbiter::prefetch_arbiter(policy arbitration_, std::size_t num_sources_)
+    : arbitration(arbitration_), num_sources(num_sources_), issued(num_sources_), useful(num_sources_),
+      bandit(std::make_unique<UCB>(num_sources_, BANDIT_EXPLORATION)), chosen_arm(bandit->selectNextArm())
+{
+}
+
+champsim::prefetch_arbiter::~prefetch_arbiter() = default;
+
+std::vector<std::size_t> champsim::prefetch_arbiter::order()
+{
+  if (arbitration == policy::bandit)
+    return {chosen_arm};
+
+  std::vector<std::size_t> retval(num_sources);
+  std::iota(std::begin(retval), std::end(retval), 0);
+
+  if (arbitration == policy::round_robin) {
+    std::rotate(std::begin(retval), std::next(std::begin(retval), static_cast<long>(next_turn)), std::end(retval));
+    next_turn = (next_turn + 1) % num_sources;
+  } else if (arbitration == policy::accuracy) {
+    // Untried prefetchers start from an accuracy of one half
+    auto accuracy = [this](std::size_t source) {
+      return static_cast<double>(useful[source] + 1) / static_cast<double>(issued[source] + 2);
+    };
+    std::stable_sort(std::begin(retval), std::end(retval), [accuracy](auto x, auto y) { return accuracy(x) > accuracy(y); });
+  }
+
+  return retval;
+}
+
+void champsim::prefetch_arbiter::record_issued(std::size_t source) { ++issued.at(source); }
+
+void champsim::prefetch_arbiter::record_useful(std::size_t source)
+{
+  ++useful.at(source);
+  if (source == chosen_arm)
+    ++epoch_reward;
+}
+
+void champsim::prefetch_arbiter::record_fill()
+{
+  if (arbitration != policy::bandit || ++epoch_fills < EPOCH)
+    return;
+
+  // The bandit normalizes rewards by their mean, so an epoch without useful prefetches must still earn something
+  bandit->updateState(chosen_arm, static_cast<double>(epoch_reward + 1));
+  chosen_arm = bandit->selectNextArm();
+  epoch_fills = 0;
+  epoch_reward = 0;
+}
@@ -0,0 +1,102 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prefetch_feedback.h"
+
+#include <algorithm>
+
+std::size_t champsim::prefetch_feedback::filter_index(uint64_t block)
+{
+  // Fibonacci hashing spreads neighbouring lines across the filter
+  return static_cast<std::size_t>((block * 0x9e3779b97f4a7c15ull) >> 52) % FILTER_SIZE;
+}
+
+bool champsim::prefetch_feedback::record_demand_miss(uint64_t block)
+{
+  ++interval.demand_misses;
+  bool polluted = evicted_by_prefetch.test(filter_index(block));
+  if (polluted)
+    ++interval.polluting;
+  return polluted;
+}
+
+void champsim::prefetch_feedback::record_prefetch_eviction(uint64_t block) { evicted_by_prefetch.set(filter_index(block)); }
+
+void champsim::prefetch_feedback::record_demand_fill(uint64_t block) { evicted_by_prefetch.reset(filter_index(block)); }
+
+bool champsim::prefetch_feedback::record_fill()
+{
+  ++interval_fills;
+  if (interval_fills < INTERVAL)
+    return false;
+  return end_interval();
+}
+
+bool champsim::prefetch_feedback::end_interval()
+{
+  // Each interval's counts are weighted equally with the history of all previous intervals
+  auto blend = [](double old_value, double new_value) {
+    return (old_value + new_value) / 2;
+  };
+  smoothed.sent = blend(smoothed.sent, interval.sent);
+  smoothed.used = blend(smoothed.used, interval.used);
+  smoothed.late = blend(smoothed.late, interval.late);
+  smoothed.polluting = blend(smoothed.polluting, interval.polluting);
+  smoothed.demand_misses = blend(smoothed.demand_misses, interval.demand_misses);
+  interval = {};
+  interval_fills = 0;
+
+  auto ratio = [](double num, double denom) {
+    return denom > 0 ? num / denom : 0.0;
+  };
+  auto accuracy = ratio(smoothed.used, smoothed.sent);
+  auto late = ratio(smoothed.late, smoothed.used) > LATENESS_THRESHOLD;
+  auto polluting = ratio(smoothed.polluting, smoothed.demand_misses) > POLLUTION_THRESHOLD;
+
+  // The decision table of Srinath et al., Table 2
+  int step = 0;
+  if (accuracy >= ACCURACY_HIGH) {
+    if (late)
+      step = 1;
+    else if (polluting)
+      step = -1;
+  } else if (accuracy >= ACCURACY_LOW) {
+    if (late && !polluting)
+      step = 1;
+    else if (polluting)
+      step = -1;
+  } else {
+    if (late || polluting)
+      step = -1;
+  }
+
+  auto next_level = std::clamp<int>(static_cast<int>(current_level) + step, MIN_LEVEL, MAX_LEVEL);
+  bool changed = static_cast<unsigned>(next_level) != current_level;
+  current_level = static_cast<unsigned>(next_level);
+  return changed;
+}
+
+double champsim::prefetch_feedback::occupancy_ceiling(unsigned level, bool fill_this_level)
+{
+  auto steps = level + (fill_this_level ? 1 : 0);
+  return std::min(1.0, static_cast<double>(steps) / MAX_LEVEL);
+}
+
+int champsim::prefetch_feedback::scaled_degree(int default_degree, unsigned level)
+{
+  constexpr auto middle = static_cast<int>((MIN_LEVEL + MAX_LEVEL) / 2);
+  return std::max(1, default_degree + static_cast<int>(level) - middle);
+}
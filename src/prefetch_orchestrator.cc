@@ -0,0 +1,76 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prefetch_orchestrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+bool champsim::prefetch_orchestrator::record_access(bool hit)
+{
+  ++epoch_accesses;
+  if (hit)
+    ++epoch_hits;
+
+  if (epoch_accesses < EPOCH)
+    return false;
+
+  // Rewards are normalized by their mean, so the reward must never be zero
+  update(static_cast<double>(epoch_hits + 1) / static_cast<double>(epoch_accesses + 1));
+  epoch_accesses = 0;
+  epoch_hits = 0;
+
+  auto next_arm = select_arm();
+  bool changed = next_arm != arm;
+  arm = next_arm;
+  return changed;
+}
+
+void champsim::prefetch_orchestrator::update(double reward)
+{
+  if (first_round) {
+    reward_sums[arm] = reward;
+    pulls[arm] = 1;
+
+    // Once every arm has been tried, normalize by the mean reward, so that the exploration constant does not depend on the workload's hit rate
+    if (std::none_of(std::begin(pulls), std::end(pulls), [](auto x) { return x == 0; })) {
+      first_round = false;
+      reward_scale = std::accumulate(std::begin(reward_sums), std::end(reward_sums), 0.0) / NUM_ARMS;
+      std::transform(std::begin(reward_sums), std::end(reward_sums), std::begin(reward_sums), [scale = reward_scale](auto x) { return x / scale; });
+    }
+    return;
+  }
+
+  // Every arm is discounted, so that an arm not chosen for a while is explored again
+  std::transform(std::begin(pulls), std::end(pulls), std::begin(pulls), [](auto x) { return x * DISCOUNT; });
+  std::transform(std::begin(reward_sums), std::end(reward_sums), std::begin(reward_sums), [](auto x) { return x * DISCOUNT; });
+  pulls[arm] += 1;
+  reward_sums[arm] += reward / reward_scale;
+}
+
+unsigned champsim::prefetch_orchestrator::select_arm() const
+{
+  // Try every arm once, in order
+  if (first_round)
+    return static_cast<unsigned>(std::distance(std::begin(pulls), std::find(std::begin(pulls), std::end(pulls), 0)));
+
+  auto total_pulls = std::accumulate(std::begin(pulls), std::end(pulls), 0.0);
+  std::array<double, NUM_ARMS> potential{};
+  for (unsigned i = 0; i < NUM_ARMS; ++i)
+    potential[i] = reward_sums[i] / pulls[i] + EXPLORATION * std::sqrt(std::log(total_pulls) / pulls[i]);
+  return static_cast<unsigned>(std::distance(std::begin(potential), std::max_element(std::begin(potential), std::end(potential))));
+}
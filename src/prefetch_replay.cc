@@ -0,0 +1,122 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prefetch_replay.h"
+
+#include <algorithm>
+
+#include "cache.h"
+#include "util/bits.h"
+
+namespace
+{
+double ratio(uint64_t num, uint64_t denom) { return denom > 0 ? static_cast<double>(num) / static_cast<double>(denom) : 0.0; }
+} // namespace
+
+double champsim::prefetch_replay::stats_type::accuracy() const { return ratio(pf_useful, pf_issued); }
+
+double champsim::prefetch_replay::stats_type::coverage() const { return ratio(pf_useful, pf_useful + demand_misses); }
+
+champsim::prefetch_replay::prefetch_replay(CACHE& cache_, uint64_t fill_latency_)
+    : cache(cache_), fill_latency(fill_latency_), lines(cache.NUM_SET * cache.NUM_WAY)
+{
+}
+
+auto champsim::prefetch_replay::find(uint64_t block) -> line_type*
+{
+  auto set_begin = std::next(std::begin(lines), static_cast<long>((block & champsim::bitmask(champsim::lg2(cache.NUM_SET))) * cache.NUM_WAY));
+  auto set_end = std::next(set_begin, cache.NUM_WAY);
+  auto found = std::find_if(set_begin, set_end, [block](const auto& x) { return x.valid && x.block == block; });
+  return found != set_end ? &*found : nullptr;
+}
+
+void champsim::prefetch_replay::fill(const fill_type& filled)
+{
+  auto set = static_cast<uint32_t>(filled.block & champsim::bitmask(champsim::lg2(cache.NUM_SET)));
+  auto set_begin = std::next(std::begin(lines), static_cast<long>(set * cache.NUM_WAY));
+  auto set_end = std::next(set_begin, cache.NUM_WAY);
+  auto way = std::find_if_not(set_begin, set_end, [](const auto& x) { return x.valid; });
+  if (way == set_end)
+    way = std::min_element(set_begin, set_end, [](const auto& x, const auto& y) { return x.last_used < y.last_used; });
+
+  if (way->valid && way->prefetch)
+    ++stats.pf_useless;
+
+  auto evicted_addr = way->valid ? (way->block << cache.OFFSET_BITS) : 0;
+  *way = line_type{true, filled.prefetch, filled.block, clock};
+  cache.impl_prefetcher_cache_fill(filled.block << cache.OFFSET_BITS, set, static_cast<uint32_t>(std::distance(set_begin, way)), filled.prefetch,
+                                   evicted_addr, 0);
+}
+
+void champsim::prefetch_replay::complete_fills()
+{
+  while (!std::empty(inflight) && inflight.front().ready <= clock) {
+    fill(inflight.front());
+    inflight.pop_front();
+  }
+}
+
+void champsim::prefetch_replay::replay(const access_record& record)
+{
+  ++clock;
+  complete_fills();
+
+  const auto block = record.address >> cache.OFFSET_BITS;
+  const bool demand = record.type != access_type::PREFETCH;
+  auto line = find(block);
+  const bool hit = line != nullptr;
+  const bool useful = hit && line->prefetch;
+  auto pending = std::find_if(std::begin(inflight), std::end(inflight), [block](const auto& x) { return x.block == block; });
+  const bool late = !hit && pending != std::end(inflight) && pending->prefetch;
+
+  ++stats.accesses;
+  if (useful || late)
+    ++stats.pf_useful;
+  if (late)
+    ++stats.pf_late;
+
+  if (demand) {
+    ++stats.demand_accesses;
+    if (!record.hit)
+      ++stats.recorded_demand_misses;
+    if (!hit && !late)
+      ++stats.demand_misses;
+  }
+
+  if (hit) {
+    line->last_used = clock;
+    line->prefetch = false;
+  } else if (late) {
+    pending->prefetch = false;
+  } else if (pending == std::end(inflight)) {
+    inflight.push_back({block, false, clock + fill_latency});
+  }
+
+  cache.current_cycle = clock;
+  cache.impl_prefetcher_cache_operate(record.address, record.ip, hit, useful, champsim::to_underlying(record.type), 0);
+
+  for (auto pf_addr : cache.take_queued_prefetches()) {
+    auto pf_block = pf_addr >> cache.OFFSET_BITS;
+    auto already_inflight = std::any_of(std::begin(inflight), std::end(inflight), [pf_block](const auto& x) { return x.block == pf_block; });
+    if (find(pf_block) == nullptr && !already_inflight) {
+      ++stats.pf_issued;
+      inflight.push_back({pf_block, true, clock + fill_latency});
+    }
+  }
+
+  cache.impl_prefetcher_cycle_operate();
+  complete_fills();
+}
@@ -23,9 +23,11 @@
 #include "dram_controller.h"
 #include <fmt/core.h>
 
-VirtualMemory::VirtualMemory(uint64_t page_table_page_size, std::size_t page_table_levels, uint64_t minor_penalty, MEMORY_CONTROLLER& dram)
+VirtualMemory::VirtualMemory(uint64_t page_table_page_size, std::size_t page_table_levels, uint64_t minor_penalty, MEMORY_CONTROLLER& dram,
+                             placement_type placement)
     : next_ppage(VMEM_RESERVE_CAPACITY), last_ppage(1ull << (LOG2_PAGE_SIZE + champsim::lg2(page_table_page_size / PTE_BYTES) * page_table_levels)),
-      minor_fault_penalty(minor_penalty), pt_levels(page_table_levels), pte_page_size(page_table_page_size)
+      near_limit(last_ppage), next_far_ppage(last_ppage), minor_fault_penalty(minor_penalty), pt_levels(page_table_levels),
+      pte_page_size(page_table_page_size)
 {
   assert(page_table_page_size > 1024);
   assert(page_table_page_size == (1ull << champsim::lg2(page_table_page_size)));
@@ -36,6 +38,11 @@ VirtualMemory::VirtualMemory(uint64_t page_table_page_size, std::size_t page_tab
     fmt::print("WARNING: virtual memory configuration would require {} bits of addressing.\n", required_bits); // LCOV_EXCL_LINE
   if (required_bits > champsim::lg2(dram.size()))
     fmt::print("WARNING: physical memory size is smaller than virtual memory size.\n"); // LCOV_EXCL_LINE
+
+  if (placement == placement_type::interleave && dram.far_memory.enabled() && dram.size() > next_ppage && dram.size() < last_ppage) {
+    near_limit = dram.size();
+    next_far_ppage = dram.size();
+  }
 }
 
 uint64_t VirtualMemory::shamt(std::size_t level) const { return LOG2_PAGE_SIZE + champsim::lg2(pte_page_size / PTE_BYTES) * (level - 1); }
@@ -45,15 +52,24 @@ uint64_t VirtualMemory::get_offset(uint64_t vaddr, std::size_t level) const
   return (vaddr >> shamt(level)) & champsim::bitmask(champsim::lg2(pte_page_size / PTE_BYTES));
 }
 
+bool VirtualMemory::far_next() const { return next_ppage >= near_limit || (far_turn && next_far_ppage < last_ppage); }
+
 uint64_t VirtualMemory::ppage_front() const
 {
   assert(available_ppages() > 0);
-  return next_ppage;
+  return far_next() ? next_far_ppage : next_ppage;
 }
 
-void VirtualMemory::ppage_pop() { next_ppage += PAGE_SIZE; }
+void VirtualMemory::ppage_pop()
+{
+  if (far_next())
+    next_far_ppage += PAGE_SIZE;
+  else
+    next_ppage += PAGE_SIZE;
+  far_turn = !far_turn;
+}
 
-std::size_t VirtualMemory::available_ppages() const { return (last_ppage - next_ppage) / PAGE_SIZE; }
+std::size_t VirtualMemory::available_ppages() const { return (near_limit - next_ppage) / PAGE_SIZE + (last_ppage - next_far_ppage) / PAGE_SIZE; }
 
 std::pair<uint64_t, uint64_t> VirtualMemory::va_to_pa(uint32_t cpu_num, uint64_t vaddr)
 {
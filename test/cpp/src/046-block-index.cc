@@ -0,0 +1,107 @@
+#include <catch.hpp>
+
+#include "champsim_constants.h"
+#include "channel.h"
+#include "util/block_index.h"
+
+namespace {
+struct indexed_entry {
+  uint64_t address;
+  int id;
+};
+}
+
+SCENARIO("A block-indexed queue finds the oldest entry for a block") {
+  GIVEN("A queue with several entries in the same block") {
+    champsim::block_indexed_queue<indexed_entry> uut{6};
+    uut.push_back({0xdeadbe00, 0});
+    uut.push_back({0xcafe0000, 1});
+    uut.push_back({0xdeadbe08, 2});
+    uut.push_back({0xdeadbe10, 3});
+
+    THEN("The oldest entry is found") {
+      auto found = uut.find(0xdeadbe3f);
+      REQUIRE(found != std::end(uut));
+      REQUIRE(found->id == 0);
+    }
+
+    THEN("An absent block is not found") {
+      REQUIRE(uut.find(0xdeadbe40) == std::end(uut));
+    }
+
+    WHEN("The front of the queue is erased") {
+      uut.erase(std::cbegin(uut), std::next(std::cbegin(uut)));
+
+      THEN("The next oldest entry is found") {
+        auto found = uut.find(0xdeadbe00);
+        REQUIRE(found != std::end(uut));
+        REQUIRE(found->id == 2);
+      }
+    }
+
+    WHEN("An entry is erased from the middle of the queue") {
+      uut.erase(std::next(std::cbegin(uut), 2));
+
+      THEN("The remaining entries are still found") {
+        REQUIRE(uut.find(0xcafe0000)->id == 1);
+        REQUIRE(uut.find(0xdeadbe00)->id == 0);
+        uut.erase(std::cbegin(uut));
+        REQUIRE(uut.find(0xdeadbe00)->id == 3);
+      }
+    }
+
+    WHEN("The queue is cleared") {
+      uut.clear();
+
+      THEN("Nothing is found") {
+        REQUIRE(std::empty(uut));
+        REQUIRE(uut.find(0xdeadbe00) == std::end(uut));
+      }
+    }
+  }
+}
+
+SCENARIO("A deep channel merges with the oldest matching entry after the front is consumed") {
+  GIVEN("A channel with a deep read queue holding one request for each of many blocks") {
+    constexpr std::size_t depth = 512;
+    champsim::channel uut{depth, depth, depth, LOG2_BLOCK_SIZE, false};
+
+    for (uint64_t i = 0; i < depth / 2; ++i) {
+      champsim::channel::request_type pkt;
+      pkt.address = i << LOG2_BLOCK_SIZE;
+      pkt.is_translated = true;
+      uut.add_rq(pkt);
+    }
+    uut.check_collision();
+
+    WHEN("The oldest half is consumed and a request to a remaining block is added") {
+      uut.RQ.erase(std::cbegin(uut.RQ), std::next(std::cbegin(uut.RQ), depth / 4));
+
+      champsim::channel::request_type pkt;
+      pkt.address = ((depth / 2 - 1) << LOG2_BLOCK_SIZE) + 8;
+      pkt.is_translated = true;
+      uut.add_rq(pkt);
+      uut.check_collision();
+
+      THEN("The request is merged") {
+        REQUIRE(uut.sim_stats.RQ_MERGED == 1);
+        REQUIRE(uut.rq_occupancy() == depth / 4);
+      }
+    }
+
+    WHEN("A request to a consumed block is added") {
+      uut.RQ.erase(std::cbegin(uut.RQ), std::next(std::cbegin(uut.RQ), depth / 4));
+
+      champsim::channel::request_type pkt;
+      pkt.address = 0;
+      pkt.is_translated = true;
+      uut.add_rq(pkt);
+      uut.check_collision();
+
+      THEN("The request is not merged") {
+        REQUIRE(uut.sim_stats.RQ_MERGED == 0);
+        REQUIRE(uut.rq_occupancy() == depth / 4 + 1);
+      }
+    }
+  }
+}
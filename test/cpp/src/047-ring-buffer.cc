@@ -0,0 +1,89 @@
+#include <catch.hpp>
+
+#include <numeric>
+#include <vector>
+
+#include "util/ring_buffer.h"
+
+SCENARIO("A ring buffer is a FIFO queue") {
+  GIVEN("A ring buffer with a bounded capacity") {
+    champsim::ring_buffer<int> uut{5};
+
+    THEN("The capacity is rounded up to a power of two") {
+      REQUIRE(uut.capacity() == 8);
+      REQUIRE(std::empty(uut));
+    }
+
+    WHEN("Elements are pushed and popped past the end of the storage") {
+      for (int i = 0; i < 6; ++i)
+        uut.push_back(i);
+      for (int i = 0; i < 4; ++i)
+        uut.pop_front();
+      for (int i = 6; i < 12; ++i)
+        uut.push_back(i);
+
+      THEN("The elements are in order and the buffer did not grow") {
+        std::vector<int> expected(8);
+        std::iota(std::begin(expected), std::end(expected), 4);
+        REQUIRE(std::vector<int>(std::begin(uut), std::end(uut)) == expected);
+        REQUIRE(uut.capacity() == 8);
+        REQUIRE(uut.full());
+      }
+
+      AND_WHEN("Another element is pushed") {
+        uut.push_back(12);
+
+        THEN("The buffer grows and preserves the order") {
+          std::vector<int> expected(9);
+          std::iota(std::begin(expected), std::end(expected), 4);
+          REQUIRE(std::vector<int>(std::begin(uut), std::end(uut)) == expected);
+          REQUIRE(uut.capacity() == 16);
+        }
+      }
+    }
+
+    WHEN("An element is erased from the middle") {
+      for (int i = 0; i < 5; ++i)
+        uut.push_back(i);
+      auto it = uut.erase(std::next(std::cbegin(uut), 1), std::next(std::cbegin(uut), 3));
+
+      THEN("The remaining elements keep their order") {
+        REQUIRE(std::vector<int>(std::begin(uut), std::end(uut)) == std::vector<int>{0, 3, 4});
+        REQUIRE(*it == 3);
+      }
+    }
+
+    WHEN("A prefix is erased") {
+      for (int i = 0; i < 5; ++i)
+        uut.push_back(i);
+      uut.erase(std::cbegin(uut), std::next(std::cbegin(uut), 2));
+
+      THEN("The remaining elements keep their order") {
+        REQUIRE(std::vector<int>(std::begin(uut), std::end(uut)) == std::vector<int>{2, 3, 4});
+        REQUIRE(uut.front() == 2);
+        REQUIRE(uut.back() == 4);
+      }
+    }
+  }
+}
+
+SCENARIO("A ring buffer recycles the storage of its slots") {
+  GIVEN("A ring buffer of vectors that has been filled and drained") {
+    champsim::ring_buffer<std::vector<int>> uut{2};
+    uut.push_back(std::vector<int>(16, 1));
+    const int* storage = uut.front().data();
+    uut.pop_front();
+    uut.push_back(std::vector<int>(16, 2));
+    uut.pop_front();
+
+    WHEN("A smaller vector is copied into the recycled slot") {
+      const std::vector<int> added(4, 3);
+      uut.push_back(added);
+
+      THEN("The slot reuses its existing storage") {
+        REQUIRE(uut.front().data() == storage);
+        REQUIRE(uut.front() == added);
+      }
+    }
+  }
+}
@@ -0,0 +1,90 @@
+#include <catch.hpp>
+
+#include <vector>
+
+#include "util/small_vector.h"
+
+SCENARIO("A small vector stores a few elements inline") {
+  GIVEN("An empty small vector") {
+    champsim::small_vector<int, 4> uut{};
+    const int* inline_storage = uut.data();
+
+    WHEN("Elements are added up to the inline capacity") {
+      for (int i = 0; i < 4; ++i)
+        uut.push_back(i);
+
+      THEN("The elements are stored inline") {
+        REQUIRE(std::size(uut) == 4);
+        REQUIRE(uut.data() == inline_storage);
+        REQUIRE(std::vector<int>(std::begin(uut), std::end(uut)) == std::vector<int>{0, 1, 2, 3});
+      }
+
+      AND_WHEN("One more element is added") {
+        uut.push_back(4);
+
+        THEN("The elements spill to the heap in order") {
+          REQUIRE(uut.data() != inline_storage);
+          REQUIRE(std::vector<int>(std::begin(uut), std::end(uut)) == std::vector<int>{0, 1, 2, 3, 4});
+        }
+
+        THEN("A copy holds the same elements") {
+          champsim::small_vector<int, 4> copy{uut};
+          REQUIRE(std::vector<int>(std::begin(copy), std::end(copy)) == std::vector<int>{0, 1, 2, 3, 4});
+        }
+      }
+
+      AND_WHEN("The front element is erased") {
+        uut.erase(std::cbegin(uut));
+
+        THEN("The remaining elements keep their order") {
+          REQUIRE(std::vector<int>(std::begin(uut), std::end(uut)) == std::vector<int>{1, 2, 3});
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Sorted small vectors can be merged in place") {
+  GIVEN("Two overlapping sorted small vectors") {
+    champsim::small_vector<int, 4> dest{1, 3, 5};
+    champsim::small_vector<int, 4> src{2, 3};
+
+    WHEN("The source is merged into the destination") {
+      const int* inline_storage = dest.data();
+      champsim::set_union_into(dest, src);
+
+      THEN("The result is the sorted union, still stored inline") {
+        REQUIRE(std::vector<int>(std::begin(dest), std::end(dest)) == std::vector<int>{1, 2, 3, 5});
+        REQUIRE(dest.data() == inline_storage);
+      }
+    }
+
+    WHEN("A source that extends past the inline capacity is merged") {
+      champsim::small_vector<int, 4> big_src{0, 4, 6, 7};
+      champsim::set_union_into(dest, big_src);
+
+      THEN("The result is the sorted union") {
+        REQUIRE(std::vector<int>(std::begin(dest), std::end(dest)) == std::vector<int>{0, 1, 3, 4, 5, 6, 7});
+      }
+    }
+
+    WHEN("A subset is merged") {
+      champsim::small_vector<int, 4> subset{3, 5};
+      champsim::set_union_into(dest, subset);
+
+      THEN("The destination is unchanged") {
+        REQUIRE(std::vector<int>(std::begin(dest), std::end(dest)) == std::vector<int>{1, 3, 5});
+      }
+    }
+
+    WHEN("The union is taken with a custom ordering") {
+      champsim::small_vector<int, 4> desc_dest{5, 3, 1};
+      champsim::small_vector<int, 4> desc_src{4, 3};
+      champsim::set_union_into(desc_dest, desc_src, std::greater<>{});
+
+      THEN("The result follows that ordering") {
+        REQUIRE(std::vector<int>(std::begin(desc_dest), std::end(desc_dest)) == std::vector<int>{5, 4, 3, 1});
+      }
+    }
+  }
+}
@@ -0,0 +1,88 @@
+#include <catch.hpp>
+
+#include <vector>
+
+#include "util/timing_wheel.h"
+
+SCENARIO("A timing wheel releases events in the cycle they are due") {
+  GIVEN("A timing wheel with events scheduled for several cycles") {
+    champsim::timing_wheel<int> uut;
+    uut.schedule(3, 30);
+    uut.schedule(1, 10);
+    uut.schedule(3, 31);
+    uut.schedule(2, 20);
+
+    std::vector<int> released;
+    auto collect = [&](int x) { released.push_back(x); };
+
+    THEN("All events are pending") {
+      REQUIRE(std::size(uut) == 4);
+    }
+
+    WHEN("The wheel advances to a cycle before any event is due") {
+      uut.advance(0, collect);
+
+      THEN("No events are released") {
+        REQUIRE(std::empty(released));
+        REQUIRE(std::size(uut) == 4);
+      }
+    }
+
+    WHEN("The wheel advances one cycle at a time") {
+      std::vector<std::vector<int>> per_cycle;
+      for (uint64_t cycle = 0; cycle < 5; ++cycle) {
+        released.clear();
+        uut.advance(cycle, collect);
+        per_cycle.push_back(released);
+      }
+
+      THEN("Each event is released in its own cycle, in the order it was scheduled") {
+        REQUIRE(per_cycle == std::vector<std::vector<int>>{{}, {10}, {20}, {30, 31}, {}});
+        REQUIRE(std::empty(uut));
+      }
+    }
+
+    WHEN("The wheel jumps past all of the events") {
+      uut.advance(1000, collect);
+
+      THEN("The events are released in due order") {
+        REQUIRE(released == std::vector<int>{10, 20, 30, 31});
+        REQUIRE(std::empty(uut));
+      }
+    }
+  }
+
+  GIVEN("A timing wheel that has advanced past a cycle") {
+    champsim::timing_wheel<int> uut;
+    std::vector<int> released;
+    auto collect = [&](int x) { released.push_back(x); };
+    uut.advance(10, collect);
+
+    WHEN("An event is scheduled for a past cycle") {
+      uut.schedule(5, 50);
+      uut.advance(11, collect);
+
+      THEN("The event is released at the next advance") {
+        REQUIRE(released == std::vector<int>{50});
+      }
+    }
+
+    WHEN("An event is scheduled further ahead than the wheel reaches") {
+      uut.schedule(12, 120);
+      uut.schedule(500, 5000);
+      uut.advance(499, collect);
+
+      THEN("Only the nearer event has been released") {
+        REQUIRE(released == std::vector<int>{120});
+      }
+
+      AND_WHEN("The wheel reaches the later event") {
+        uut.advance(500, collect);
+
+        THEN("The later event is released") {
+          REQUIRE(released == std::vector<int>{120, 5000});
+        }
+      }
+    }
+  }
+}
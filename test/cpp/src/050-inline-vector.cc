@@ -0,0 +1,46 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include "util/inline_vector.h"
+
+SCENARIO("An inline vector holds up to its capacity without allocating") {
+  GIVEN("An inline vector built from a range") {
+    std::vector<int> source{1, 2, 3};
+    champsim::inline_vector<int, 4> uut{std::begin(source), std::end(source)};
+
+    THEN("It holds the elements of the range") {
+      REQUIRE(std::size(uut) == 3);
+      REQUIRE(std::equal(std::begin(uut), std::end(uut), std::begin(source), std::end(source)));
+      REQUIRE_FALSE(uut.full());
+    }
+
+    WHEN("An element is pushed") {
+      uut.push_back(4);
+
+      THEN("The vector is full") {
+        REQUIRE(uut.full());
+        REQUIRE(uut.back() == 4);
+      }
+    }
+
+    WHEN("Elements are removed") {
+      uut.erase(std::remove(std::begin(uut), std::end(uut), 2), std::end(uut));
+
+      THEN("The remaining elements keep their order") {
+        REQUIRE(uut == champsim::inline_vector<int, 4>{1, 3});
+      }
+    }
+
+    WHEN("The vector is copied") {
+      auto copy = uut;
+      copy.clear();
+
+      THEN("The copy is independent of the original") {
+        REQUIRE(std::empty(copy));
+        REQUIRE(std::size(uut) == 3);
+      }
+    }
+  }
+}
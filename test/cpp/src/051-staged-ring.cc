@@ -0,0 +1,57 @@
+#include <catch.hpp>
+
+#include "util/staged_ring.h"
+
+SCENARIO("Elements of a staged ring do not move as they advance through the stages") {
+  GIVEN("A ring with three stages and elements in the youngest") {
+    champsim::staged_ring<int, 3> uut{8};
+    auto oldest = uut.stage(0);
+    auto middle = uut.stage(1);
+    auto youngest = uut.stage(2);
+
+    for (int i = 0; i < 4; ++i)
+      youngest.push_back(i);
+    const int* first_addr = &youngest.front();
+
+    WHEN("Elements advance to older stages") {
+      youngest.advance(3);
+      middle.advance(2);
+
+      THEN("Each stage holds its elements in order") {
+        REQUIRE(std::size(oldest) == 2);
+        REQUIRE(std::size(middle) == 1);
+        REQUIRE(std::size(youngest) == 1);
+        REQUIRE(oldest.at(0) == 0);
+        REQUIRE(oldest.at(1) == 1);
+        REQUIRE(middle.front() == 2);
+        REQUIRE(youngest.front() == 3);
+      }
+
+      THEN("The elements kept their slots") {
+        REQUIRE(&oldest.front() == first_addr);
+      }
+
+      AND_WHEN("The oldest element leaves and another enters") {
+        oldest.pop_front();
+        youngest.push_back(4);
+
+        THEN("The remaining elements kept their slots") {
+          REQUIRE(&oldest.front() == first_addr + 1);
+          REQUIRE(youngest.back() == 4);
+          REQUIRE(uut.size() == 4);
+        }
+      }
+    }
+
+    WHEN("An element is added to an older stage") {
+      oldest.push_back(-1);
+
+      THEN("It is placed before the younger stages") {
+        REQUIRE(std::size(oldest) == 1);
+        REQUIRE(oldest.front() == -1);
+        REQUIRE(std::size(youngest) == 4);
+        REQUIRE(youngest.front() == 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,77 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("A fetch target queue prefetches the predicted path into the L1I") {
+  GIVEN("A core with a fetch target queue and instructions in several blocks") {
+    constexpr std::array<uint64_t, 4> addrs{{0xdeadbeef, 0xbeefdead, 0xcafebabe, 0xbabecafe}};
+
+    do_nothing_MRC mock_L1I;
+    do_nothing_MRC mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+      .fetch_width(4)
+      .ftq_size(16)
+    };
+    uut.initialize();
+
+    for (auto addr : addrs)
+      uut.threads.front().input_queue.push_back(champsim::test::instruction_with_ip(addr));
+
+    WHEN("The core operates for one cycle") {
+      uut._operate();
+
+      THEN("The instructions enter the fetch target queue") {
+        REQUIRE(std::size(uut.FTQ) == std::size(addrs));
+        REQUIRE(std::empty(uut.threads.front().input_queue));
+      }
+
+      THEN("Each block is prefetched before it is fetched") {
+        REQUIRE(std::size(mock_L1I.queues.PQ) == std::size(addrs));
+        REQUIRE(std::empty(mock_L1I.queues.RQ));
+        REQUIRE(uut.sim_stats.ftq_prefetches == std::size(addrs));
+        auto addr_it = std::begin(addrs);
+        for (const auto& pkt : mock_L1I.queues.PQ) {
+          REQUIRE(pkt.v_address == *addr_it++);
+          REQUIRE(pkt.type == access_type::PREFETCH);
+          REQUIRE_FALSE(pkt.response_requested);
+        }
+      }
+
+      AND_WHEN("The core operates again") {
+        uut._operate();
+
+        THEN("The instructions move to the fetch buffer") {
+          REQUIRE(std::empty(uut.FTQ));
+          REQUIRE(std::size(uut.IFETCH_BUFFER) == std::size(addrs));
+        }
+      }
+    }
+  }
+
+  GIVEN("A core without a fetch target queue") {
+    do_nothing_MRC mock_L1I;
+    do_nothing_MRC mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.initialize();
+
+    uut.threads.front().input_queue.push_back(champsim::test::instruction_with_ip(0xdeadbeef));
+
+    WHEN("The core operates for one cycle") {
+      uut._operate();
+
+      THEN("No prefetches are issued") {
+        REQUIRE(std::empty(uut.FTQ));
+        REQUIRE(std::size(uut.IFETCH_BUFFER) == 1);
+        REQUIRE(std::empty(mock_L1I.queues.PQ));
+      }
+    }
+  }
+}
@@ -0,0 +1,68 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("Instructions execute when their producers complete") {
+  GIVEN("A ROB with a dependent instruction between two independent ones") {
+    constexpr unsigned execute_latency = 5;
+
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .schedule_latency(0)
+      .execute_latency(execute_latency)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.warmup = false;
+
+    uut.ROB.push_back(champsim::test::instruction_with_registers(42));
+    uut.ROB.push_back(champsim::test::instruction_with_registers(42));
+    uut.ROB.push_back(champsim::test::instruction_with_ip(1));
+    uint64_t id = 0;
+    for (auto &instr : uut.ROB)
+      instr.instr_id = id++;
+
+    std::array<champsim::operable*,3> elements{{&uut, &mock_L1I, &mock_L1D}};
+    for (auto op : elements)
+      op->_operate();
+
+    WHEN("The instructions are scheduled") {
+      for (auto op : elements)
+        op->_operate();
+
+      THEN("The independent instructions begin execution and the dependent instruction waits") {
+        REQUIRE(uut.ROB.at(0).executed == INFLIGHT);
+        REQUIRE(uut.ROB.at(1).executed == 0);
+        REQUIRE(uut.ROB.at(1).num_reg_dependent == 1);
+        REQUIRE(uut.ROB.at(2).executed == INFLIGHT);
+      }
+    }
+
+    WHEN("The producer completes") {
+      std::size_t cycles = 0;
+      while (uut.ROB.at(0).executed != COMPLETED && cycles < 100) {
+        for (auto op : elements)
+          op->_operate();
+        ++cycles;
+      }
+
+      THEN("The producer took the execution latency") {
+        REQUIRE(cycles == execute_latency + 1);
+      }
+
+      AND_WHEN("Another cycle passes") {
+        for (auto op : elements)
+          op->_operate();
+
+        THEN("The dependent instruction begins execution") {
+          auto dependent = std::find_if(std::begin(uut.ROB), std::end(uut.ROB), [](const auto& x){ return x.instr_id == 1; });
+          REQUIRE(dependent != std::end(uut.ROB));
+          REQUIRE(dependent->num_reg_dependent == 0);
+          REQUIRE(dependent->executed == INFLIGHT);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,64 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("A load to the address of an older store is forwarded from the store queue") {
+  GIVEN("A store followed by a load to the same address") {
+    constexpr uint64_t address = 0xdeadbeef;
+
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.warmup = false;
+
+    auto store = champsim::test::instruction_with_ip(1);
+    store.instr_id = 1;
+    store.destination_memory.push_back(address);
+    auto load = champsim::test::instruction_with_ip(2);
+    load.instr_id = 2;
+    load.source_memory.push_back(address);
+
+    for (auto& instr : {store, load}) {
+      uut.DISPATCH_BUFFER.push_back(instr);
+      uut.DISPATCH_BUFFER.back().event_cycle = uut.current_cycle;
+    }
+
+    std::array<champsim::operable*,3> elements{{&uut, &mock_L1I, &mock_L1D}};
+
+    WHEN("The instructions are dispatched") {
+      for (int i = 0; i < 10 && std::empty(uut.ROB); ++i) {
+        for (auto op : elements)
+          op->_operate();
+      }
+
+      THEN("The load waits on the store") {
+        REQUIRE(std::size(uut.ROB) == 2);
+        auto lq_entry = std::find_if(std::begin(uut.LQ), std::end(uut.LQ), [](const auto& x){ return x.has_value(); });
+        REQUIRE(lq_entry != std::end(uut.LQ));
+        REQUIRE((*lq_entry)->producer_id == store.instr_id);
+      }
+
+      AND_WHEN("Both instructions retire") {
+        for (int i = 0; i < 100 && !std::empty(uut.ROB); ++i) {
+          for (auto op : elements)
+            op->_operate();
+        }
+
+        THEN("The load did not read the cache") {
+          REQUIRE(std::empty(uut.ROB));
+          REQUIRE(mock_L1D.packet_count() == 1);
+          REQUIRE(mock_L1D.addresses.front() == address);
+        }
+
+        THEN("The load queue is empty") {
+          REQUIRE(std::size(uut.lq_free_slots) == std::size(uut.LQ));
+          REQUIRE(std::none_of(std::begin(uut.LQ), std::end(uut.LQ), [](const auto& x){ return x.has_value(); }));
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,75 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+namespace
+{
+ooo_model_instr load_from(uint64_t id, uint64_t address)
+{
+  auto instr = champsim::test::instruction_with_registers(42);
+  instr.instr_id = id;
+  instr.source_memory.push_back(address);
+  return instr;
+}
+}
+
+SCENARIO("A load issuer keeps its window of loads in flight") {
+  auto dependent = GENERATE(false, true);
+  GIVEN("A load issuer with a long-latency data cache") {
+    constexpr std::size_t mlp_window = 4;
+    constexpr uint64_t latency = 50;
+
+    do_nothing_MRC mock_L1I, mock_L1D{latency};
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .model(O3_CPU::model_type::load_issuer)
+      .mlp_window(mlp_window)
+      .issue_width(2)
+      .dependent_loads(dependent)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.warmup = false;
+
+    for (uint64_t i = 0; i < 2 * mlp_window; ++i)
+      uut.threads.front().input_queue.push_back(load_from(i, i << LOG2_BLOCK_SIZE));
+
+    std::array<champsim::operable*,3> elements{{&uut, &mock_L1I, &mock_L1D}};
+
+    WHEN("The core runs for less than the memory latency") {
+      for (uint64_t i = 0; i < latency / 2; ++i) {
+        for (auto op : elements)
+          op->_operate();
+      }
+
+      if (dependent) {
+        THEN("Only one load is issued") {
+          REQUIRE(mock_L1D.packet_count() == 1);
+        }
+      } else {
+        THEN("The window of loads is issued") {
+          REQUIRE(mock_L1D.packet_count() == mlp_window);
+          REQUIRE(std::size(uut.ROB) == mlp_window);
+        }
+      }
+
+      THEN("No instructions are fetched or retired") {
+        REQUIRE(mock_L1I.packet_count() == 0);
+        REQUIRE(uut.num_retired == 0);
+      }
+    }
+
+    WHEN("The core runs until the trace is consumed") {
+      for (uint64_t i = 0; i < 100 * latency && uut.num_retired < 2 * mlp_window; ++i) {
+        for (auto op : elements)
+          op->_operate();
+      }
+
+      THEN("Every instruction retires") {
+        REQUIRE(uut.num_retired == 2 * mlp_window);
+        REQUIRE(mock_L1D.packet_count() == 2 * mlp_window);
+      }
+    }
+  }
+}
@@ -0,0 +1,49 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("Renaming stalls when the physical registers run out") {
+  GIVEN("A core with two physical registers") {
+    // Architectural registers start out mapped to no physical register, so the physical registers only bound the destinations in flight
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .physical_registers(2)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    // Each instruction reads and writes a single register
+    std::vector test_instructions( 3, champsim::test::instruction_with_registers(42) );
+    std::copy(std::begin(test_instructions), std::end(test_instructions), std::back_inserter(uut.ROB));
+    uint64_t id = 0;
+    for (auto &instr : uut.ROB)
+      instr.instr_id = id++;
+
+    WHEN("The scheduler operates") {
+      uut.schedule_instruction();
+
+      THEN("Only the instructions that found a free register are scheduled") {
+        REQUIRE(uut.ROB.at(0).scheduled == COMPLETED);
+        REQUIRE(uut.ROB.at(1).scheduled == COMPLETED);
+        REQUIRE(uut.ROB.at(1).num_reg_dependent == 1);
+        REQUIRE(uut.ROB.at(2).scheduled == 0);
+        REQUIRE(std::empty(uut.free_physical_registers));
+      }
+
+      AND_WHEN("The first two instructions complete and retire") {
+        uut.do_complete_execution(uut.ROB.at(0));
+        uut.do_complete_execution(uut.ROB.at(1));
+        uut.retire_rob();
+        uut.schedule_instruction();
+
+        THEN("The register held by the first result is reused") {
+          REQUIRE(uut.ROB.front().instr_id == 2);
+          REQUIRE(uut.ROB.front().scheduled == COMPLETED);
+          REQUIRE(uut.ROB.front().num_reg_dependent == 0);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,170 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("Threads take turns fetching under a round-robin policy") {
+  GIVEN("A core with two threads that both have instructions") {
+    do_nothing_MRC mock_L1I{100}, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .threads(2)
+      .fetch_policy(O3_CPU::fetch_policy_type::round_robin)
+      .fetch_width(2)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.initialize();
+
+    for (auto& thread : uut.threads) {
+      for (uint64_t ip = 0x1000; ip < 0x1010; ip += 4)
+        thread.input_queue.push_back(champsim::test::instruction_with_ip(ip));
+    }
+
+    WHEN("The core operates for one cycle") {
+      uut._operate();
+
+      THEN("Only one thread fetches") {
+        REQUIRE(uut.threads.at(0).in_flight + uut.threads.at(1).in_flight == 2);
+        REQUIRE((uut.threads.at(0).in_flight == 0 || uut.threads.at(1).in_flight == 0));
+      }
+
+      AND_WHEN("The core operates for another cycle") {
+        uut._operate();
+
+        THEN("The other thread fetches") {
+          REQUIRE(uut.threads.at(0).in_flight == 2);
+          REQUIRE(uut.threads.at(1).in_flight == 2);
+        }
+
+        THEN("The instructions are numbered in the order they were fetched") {
+          REQUIRE(std::is_sorted(std::begin(uut.IFETCH_BUFFER), std::end(uut.IFETCH_BUFFER), ooo_model_instr::program_order));
+          REQUIRE(uut.IFETCH_BUFFER.at(0).thread_id == uut.IFETCH_BUFFER.at(1).thread_id);
+          REQUIRE(uut.IFETCH_BUFFER.at(1).thread_id != uut.IFETCH_BUFFER.at(2).thread_id);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("ICOUNT fetches for the thread with the fewest instructions in flight") {
+  GIVEN("A core with two threads, one of which has instructions in flight") {
+    do_nothing_MRC mock_L1I{100}, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .threads(2)
+      .fetch_policy(O3_CPU::fetch_policy_type::icount)
+      .fetch_width(2)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.initialize();
+
+    for (uint64_t ip = 0x1000; ip < 0x1010; ip += 4)
+      uut.threads.at(0).input_queue.push_back(champsim::test::instruction_with_ip(ip));
+    uut._operate();
+    uut._operate();
+
+    for (uint64_t ip = 0x2000; ip < 0x2010; ip += 4)
+      uut.threads.at(1).input_queue.push_back(champsim::test::instruction_with_ip(ip));
+
+    WHEN("The core operates for two more cycles") {
+      uut._operate();
+      uut._operate();
+
+      THEN("The thread with fewer instructions fetches in both") {
+        REQUIRE(uut.threads.at(0).in_flight == 4);
+        REQUIRE(uut.threads.at(1).in_flight == 4);
+      }
+    }
+  }
+}
+
+SCENARIO("Partitioned queues limit each thread to its share of the ROB") {
+  auto partitioned = GENERATE(false, true);
+  GIVEN("A core with two threads and a thread with more loads than its share") {
+    constexpr std::size_t rob_size = 8;
+
+    do_nothing_MRC mock_L1I, mock_L1D{100};
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .threads(2)
+      .partitioned_queues(partitioned)
+      .rob_size(rob_size)
+      .lq_size(2 * rob_size)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.warmup = false;
+
+    for (uint64_t id = 1; id <= rob_size; ++id) {
+      auto load = champsim::test::instruction_with_ip(id);
+      load.instr_id = id;
+      load.source_memory.push_back(id << LOG2_BLOCK_SIZE);
+      uut.DISPATCH_BUFFER.push_back(load);
+    }
+
+    WHEN("The core operates for a few cycles") {
+      for (int i = 0; i < 10; ++i)
+        uut._operate();
+
+      if (partitioned) {
+        THEN("The thread holds only its share of the ROB") {
+          REQUIRE(std::size(uut.ROB) == rob_size / 2);
+          REQUIRE(uut.threads.at(0).rob_occupancy == rob_size / 2);
+        }
+      } else {
+        THEN("The thread fills the ROB") {
+          REQUIRE(std::size(uut.ROB) == rob_size);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A thread retires while another thread's oldest instruction waits") {
+  GIVEN("A ROB whose oldest instruction has not completed, followed by completed instructions of both threads") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .threads(2)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    for (uint64_t id = 1; id <= 3; ++id) {
+      auto instr = champsim::test::instruction_with_ip(id);
+      instr.instr_id = id;
+      instr.thread_id = (id == 2) ? 1 : 0;
+      instr.executed = (id == 1) ? INFLIGHT : COMPLETED;
+      uut.ROB.push_back(instr);
+    }
+    uut.threads.at(0).rob_occupancy = 2;
+    uut.threads.at(1).rob_occupancy = 1;
+
+    WHEN("The core retires") {
+      auto retired = uut.retire_rob();
+
+      THEN("Only the other thread retires") {
+        REQUIRE(retired == 1);
+        REQUIRE(uut.threads.at(0).num_retired == 0);
+        REQUIRE(uut.threads.at(1).num_retired == 1);
+      }
+
+      THEN("The retired instruction stays in the ROB behind the waiting one") {
+        REQUIRE(std::size(uut.ROB) == 3);
+        REQUIRE(uut.ROB.at(1).retired);
+        REQUIRE(uut.threads.at(0).oldest_unretired == 1);
+      }
+
+      AND_WHEN("The oldest instruction completes and the core retires again") {
+        uut.ROB.front().executed = COMPLETED;
+        retired = uut.retire_rob();
+
+        THEN("The remaining instructions retire and leave the ROB") {
+          REQUIRE(retired == 2);
+          REQUIRE(uut.threads.at(0).num_retired == 2);
+          REQUIRE(uut.num_retired == 3);
+          REQUIRE(std::empty(uut.ROB));
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,79 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+namespace
+{
+struct core_under_test {
+  do_nothing_MRC mock_L1I, mock_L1D;
+  O3_CPU cpu;
+
+  explicit core_under_test(uint64_t latency)
+      : mock_L1D{latency}, cpu{O3_CPU::Builder{champsim::defaults::default_core}.fetch_queues(&mock_L1I.queues).data_queues(&mock_L1D.queues)}
+  {
+    cpu.warmup = false;
+    cpu.begin_phase();
+
+    auto load = champsim::test::instruction_with_ip(1);
+    load.instr_id = 1;
+    load.source_memory.push_back(0xdeadbeef);
+    cpu.DISPATCH_BUFFER.push_back(load);
+  }
+
+  void operate()
+  {
+    for (champsim::operable* op : std::array<champsim::operable*, 3>{{&cpu, &mock_L1I, &mock_L1D}})
+      op->_operate();
+  }
+};
+} // namespace
+
+SCENARIO("A core waiting on a long-latency load is quiescent") {
+  GIVEN("A core whose only instruction is a load to a slow lower level") {
+    constexpr uint64_t latency = 50;
+    core_under_test uut{latency};
+
+    WHEN("The load has issued") {
+      for (int i = 0; i < 10; ++i)
+        uut.operate();
+
+      THEN("The core is quiescent until the load returns") {
+        REQUIRE(uut.mock_L1D.packet_count() == 1);
+        REQUIRE(uut.cpu.quiescent());
+      }
+
+      AND_WHEN("The load returns") {
+        for (uint64_t i = 0; i < latency; ++i)
+          uut.operate();
+
+        THEN("The core wakes and retires the load") {
+          REQUIRE(uut.cpu.num_retired == 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Skipping quiescent cycles does not change the core's statistics") {
+  GIVEN("Two identical cores, one of which is never quiescent") {
+    constexpr uint64_t latency = 50;
+    core_under_test uut{latency}, control{latency};
+
+    WHEN("Both cores run until the load retires") {
+      for (uint64_t i = 0; i < 2 * latency; ++i) {
+        control.cpu.wake_cycle = 0;
+        uut.operate();
+        control.operate();
+        REQUIRE(uut.cpu.num_retired == control.cpu.num_retired);
+      }
+
+      THEN("Their statistics are the same") {
+        REQUIRE(uut.cpu.num_retired == 1);
+        REQUIRE(uut.cpu.sim_stats.cpi_stack == control.cpu.sim_stats.cpi_stack);
+        REQUIRE(uut.cpu.sim_stats.frontend_stall_cycles == control.cpu.sim_stats.frontend_stall_cycles);
+      }
+    }
+  }
+}
@@ -0,0 +1,52 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+#include <numeric>
+
+SCENARIO("Cycles that the ROB head waits on a load are charged to the level that served it") {
+  auto served_by_memory = GENERATE(false, true);
+  GIVEN("A load that misses to a slow lower level") {
+    constexpr uint64_t latency = 20;
+
+    do_nothing_MRC mock_L1I, mock_L1D{latency};
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.warmup = false;
+    uut.begin_phase();
+
+    auto load = champsim::test::instruction_with_ip(1);
+    load.instr_id = 1;
+    load.source_memory.push_back(0xdeadbeef);
+    uut.DISPATCH_BUFFER.push_back(load);
+    uut.DISPATCH_BUFFER.back().event_cycle = uut.current_cycle;
+
+    std::array<champsim::operable*,3> elements{{&uut, &mock_L1I, &mock_L1D}};
+
+    WHEN("The load retires") {
+      uint64_t cycles = 0;
+      for (; cycles < 100 && (cycles == 0 || !std::empty(uut.ROB) || !std::empty(uut.DISPATCH_BUFFER)); ++cycles) {
+        for (auto op : elements)
+          op->_operate();
+        for (auto& response : mock_L1D.queues.returned)
+          response.served_by_memory = served_by_memory;
+      }
+
+      THEN("The wait is charged to the serving level") {
+        auto served = served_by_memory ? cpi_component::LOAD_DRAM : cpi_component::LOAD_L1D;
+        auto other = served_by_memory ? cpi_component::LOAD_L1D : cpi_component::LOAD_DRAM;
+        REQUIRE(uut.sim_stats.cpi_stack.at(champsim::to_underlying(served)) >= latency - 1);
+        REQUIRE(uut.sim_stats.cpi_stack.at(champsim::to_underlying(other)) == 0);
+        REQUIRE(uut.sim_stats.cpi_stack.at(champsim::to_underlying(cpi_component::RETIRING)) == 1);
+      }
+
+      THEN("Every cycle is charged once") {
+        REQUIRE(std::accumulate(std::begin(uut.sim_stats.cpi_stack), std::end(uut.sim_stats.cpi_stack), uint64_t{0}) == cycles);
+      }
+    }
+  }
+}
@@ -0,0 +1,198 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+#include "prefetch_feedback.h"
+
+namespace
+{
+struct throttle_testbed {
+  constexpr static uint64_t hit_latency = 1;
+  constexpr static uint64_t miss_latency = 100;
+  constexpr static uint32_t mshr_size = 16;
+
+  do_nothing_MRC mock_ll{miss_latency};
+  to_rq_MRP mock_ul;
+  CACHE uut;
+  std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+  uint64_t next_id = 1;
+
+  template <typename B>
+  explicit throttle_testbed(B builder)
+      : uut{builder.upper_levels({&mock_ul.queues}).lower_level(&mock_ll.queues).hit_latency(hit_latency).mshr_size(mshr_size)}
+  {
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+  }
+
+  void issue(uint64_t address, access_type type = access_type::LOAD)
+  {
+    decltype(mock_ul)::request_type packet;
+    packet.address = address;
+    packet.type = type;
+    packet.instr_id = next_id++;
+    packet.cpu = 0;
+    REQUIRE(mock_ul.issue(packet));
+  }
+
+  void run(uint64_t cycles)
+  {
+    for (uint64_t i = 0; i < cycles; ++i)
+      for (auto elem : elements)
+        elem->_operate();
+  }
+
+  // Occupy the given number of MSHRs with demand misses that will not return for a while
+  void occupy_mshrs(std::size_t count)
+  {
+    for (std::size_t i = 0; i < count; ++i) {
+      issue(0xdead'0000 + i * BLOCK_SIZE);
+      run(1);
+    }
+    run(2 * hit_latency + 2);
+    REQUIRE(uut.get_mshr_occupancy() == count);
+  }
+};
+} // namespace
+
+SCENARIO("A throttled cache drops low-confidence prefetches when its MSHR is busy") {
+  GIVEN("A throttled cache at the starting aggressiveness whose MSHR is more than half full") {
+    throttle_testbed testbed{CACHE::Builder{champsim::defaults::default_l1d}.name("427a-uut").set_prefetch_throttle()};
+    REQUIRE(testbed.uut.get_prefetch_aggressiveness() == 3);
+    testbed.occupy_mshrs(11);
+
+    WHEN("A prefetch is issued that would not fill this level") {
+      auto result = testbed.uut.prefetch_line(0xbeef'0000, false, 0);
+
+      THEN("The prefetch is dropped") {
+        REQUIRE_FALSE(result);
+        REQUIRE(testbed.uut.sim_stats.pf_throttled == 1);
+        REQUIRE(testbed.uut.sim_stats.pf_issued == 0);
+      }
+    }
+
+    WHEN("A prefetch is issued that would fill this level") {
+      auto result = testbed.uut.prefetch_line(0xbeef'0000, true, 0);
+
+      THEN("The prefetch is issued") {
+        REQUIRE(result);
+        REQUIRE(testbed.uut.sim_stats.pf_throttled == 0);
+        REQUIRE(testbed.uut.sim_stats.pf_issued == 1);
+      }
+    }
+  }
+
+  GIVEN("An unthrottled cache whose MSHR is more than half full") {
+    throttle_testbed testbed{CACHE::Builder{champsim::defaults::default_l1d}.name("427b-uut")};
+    testbed.occupy_mshrs(11);
+
+    WHEN("A prefetch is issued that would not fill this level") {
+      auto result = testbed.uut.prefetch_line(0xbeef'0000, false, 0);
+
+      THEN("The prefetch is issued") {
+        REQUIRE(result);
+        REQUIRE(testbed.uut.sim_stats.pf_throttled == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A demand that merges with an in-flight prefetch is counted as late") {
+  GIVEN("A cache with a prefetch in flight") {
+    throttle_testbed testbed{CACHE::Builder{champsim::defaults::default_l1d}.name("427c-uut")};
+    REQUIRE(testbed.uut.prefetch_line(0xbeef'0000, true, 0));
+    testbed.run(2 * throttle_testbed::hit_latency + 2);
+    REQUIRE(testbed.uut.get_mshr_occupancy() == 1);
+
+    WHEN("A load to the same line misses") {
+      testbed.issue(0xbeef'0000);
+      testbed.run(2 * throttle_testbed::hit_latency + 2);
+
+      THEN("The prefetch is useful, but late") {
+        REQUIRE(testbed.uut.sim_stats.pf_useful == 1);
+        REQUIRE(testbed.uut.sim_stats.pf_late == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("Prefetch feedback moves the aggressiveness level") {
+  GIVEN("A fresh feedback unit") {
+    champsim::prefetch_feedback feedback;
+    auto start = feedback.level();
+
+    WHEN("Every prefetch is used, but late") {
+      for (int i = 0; i < 100; ++i) {
+        feedback.record_sent();
+        feedback.record_used();
+        feedback.record_late();
+      }
+      auto changed = feedback.end_interval();
+
+      THEN("The prefetcher becomes more aggressive") {
+        REQUIRE(changed);
+        REQUIRE(feedback.level() == start + 1);
+      }
+    }
+
+    WHEN("Prefetches are inaccurate and evict lines that demands then miss on") {
+      for (uint64_t block = 0; block < 100; ++block) {
+        feedback.record_sent();
+        feedback.record_prefetch_eviction(block);
+        feedback.record_demand_miss(block);
+      }
+      auto changed = feedback.end_interval();
+
+      THEN("The prefetcher becomes less aggressive") {
+        REQUIRE(changed);
+        REQUIRE(feedback.level() == start - 1);
+      }
+    }
+
+    WHEN("Prefetches are accurate and timely") {
+      for (int i = 0; i < 100; ++i) {
+        feedback.record_sent();
+        feedback.record_used();
+      }
+      auto changed = feedback.end_interval();
+
+      THEN("The level is unchanged") {
+        REQUIRE_FALSE(changed);
+        REQUIRE(feedback.level() == start);
+      }
+    }
+
+    WHEN("A line is evicted by a prefetch and then refilled by a demand") {
+      feedback.record_prefetch_eviction(0x1234);
+      feedback.record_demand_fill(0x1234);
+
+      THEN("A later miss on it is not pollution") {
+        REQUIRE_FALSE(feedback.record_demand_miss(0x1234));
+      }
+    }
+  }
+}
+
+SCENARIO("The scaled degree moves one step with each aggressiveness level") {
+  using feedback_type = champsim::prefetch_feedback;
+  constexpr auto middle = (feedback_type::MIN_LEVEL + feedback_type::MAX_LEVEL) / 2;
+
+  GIVEN("A prefetcher with a default degree of 2") {
+    THEN("The middle level keeps the default degree") {
+      REQUIRE(feedback_type::scaled_degree(2, middle) == 2);
+    }
+
+    THEN("The maximum level adds one for each level above the middle") {
+      REQUIRE(feedback_type::scaled_degree(2, feedback_type::MAX_LEVEL) == 2 + static_cast<int>(feedback_type::MAX_LEVEL - middle));
+    }
+
+    THEN("The minimum level never goes below a degree of 1") {
+      REQUIRE(feedback_type::scaled_degree(2, feedback_type::MIN_LEVEL) == 1);
+      REQUIRE(feedback_type::scaled_degree(1, feedback_type::MIN_LEVEL) == 1);
+    }
+  }
+}
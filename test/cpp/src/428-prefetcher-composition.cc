@@ -0,0 +1,144 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+namespace
+{
+constexpr auto first_source = CACHE::pprefetcherDnext_line;
+constexpr auto second_source = CACHE::pprefetcherDno;
+
+struct composed_testbed {
+  do_nothing_MRC mock_ll;
+  CACHE uut;
+  std::array<champsim::operable*, 2> elements{{&mock_ll, &uut}};
+
+  explicit composed_testbed(std::string name, champsim::prefetch_arbiter::policy arbitration)
+      : uut{CACHE::Builder{champsim::defaults::default_l1d}
+                .name(name)
+                .lower_level(&mock_ll.queues)
+                .prefetch_arbitration(arbitration)
+                .prefetcher<first_source | second_source>()}
+  {
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+  }
+
+  // Request prefetches as if the given module had asked for them
+  void request(unsigned long long source, uint64_t base, std::size_t count)
+  {
+    uut.active_prefetcher = source;
+    for (std::size_t i = 0; i < count; ++i)
+      REQUIRE(uut.prefetch_line(base + i * BLOCK_SIZE, true, 0));
+  }
+
+  void run(uint64_t cycles)
+  {
+    for (uint64_t i = 0; i < cycles; ++i)
+      for (auto elem : elements)
+        elem->_operate();
+  }
+
+  const prefetch_source_stats& stats(std::size_t index) const { return uut.sim_stats.pf_sources.at(index); }
+};
+} // namespace
+
+SCENARIO("A cache with composed prefetchers keeps statistics for each of them") {
+  GIVEN("A cache with two prefetchers") {
+    composed_testbed testbed{"428a-uut", champsim::prefetch_arbiter::policy::priority};
+
+    THEN("Each prefetcher is named") {
+      REQUIRE(std::size(testbed.uut.sim_stats.pf_sources) == 2);
+      REQUIRE(testbed.stats(0).name == "next_line");
+      REQUIRE(testbed.stats(1).name == "no");
+    }
+
+    WHEN("Both prefetchers request the same line") {
+      testbed.request(first_source, 0xdead'0000, 1);
+      testbed.request(second_source, 0xdead'0000, 1);
+      testbed.run(1);
+
+      THEN("The line is prefetched once, and the second request is a duplicate") {
+        REQUIRE(testbed.uut.sim_stats.pf_issued == 1);
+        REQUIRE(testbed.stats(0).issued == 1);
+        REQUIRE(testbed.stats(1).issued == 0);
+        REQUIRE(testbed.stats(1).duplicate == 1);
+      }
+    }
+
+    WHEN("A prefetcher requests a line after another prefetcher's request for it has left the queues") {
+      testbed.request(first_source, 0xdead'0000, 1);
+      testbed.run(10);
+      testbed.request(second_source, 0xdead'0000, 1);
+      testbed.run(1);
+
+      THEN("The second request is not a duplicate") {
+        REQUIRE(testbed.stats(1).duplicate == 0);
+        REQUIRE(testbed.stats(1).issued == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("Composed prefetchers are arbitrated") {
+  constexpr std::size_t pq_size = 8;
+
+  GIVEN("A cache that arbitrates by priority") {
+    composed_testbed testbed{"428b-uut", champsim::prefetch_arbiter::policy::priority};
+
+    WHEN("Both prefetchers fill their queues of candidates") {
+      testbed.request(first_source, 0xdead'0000, pq_size);
+      testbed.request(second_source, 0xbeef'0000, pq_size);
+      testbed.run(1);
+
+      THEN("Only the first prefetcher issues") {
+        REQUIRE(testbed.stats(0).issued == pq_size);
+        REQUIRE(testbed.stats(1).issued == 0);
+      }
+    }
+  }
+
+  GIVEN("A cache that arbitrates round-robin") {
+    composed_testbed testbed{"428c-uut", champsim::prefetch_arbiter::policy::round_robin};
+
+    WHEN("Both prefetchers fill their queues of candidates") {
+      testbed.request(first_source, 0xdead'0000, pq_size);
+      testbed.request(second_source, 0xbeef'0000, pq_size);
+      testbed.run(2);
+
+      THEN("The second prefetcher takes the second turn") {
+        REQUIRE(testbed.stats(0).issued == pq_size);
+        REQUIRE(testbed.stats(1).issued > 0);
+      }
+    }
+  }
+
+  GIVEN("A cache that arbitrates with a bandit") {
+    composed_testbed testbed{"428d-uut", champsim::prefetch_arbiter::policy::bandit};
+
+    WHEN("Both prefetchers request lines") {
+      testbed.request(first_source, 0xdead'0000, 4);
+      testbed.request(second_source, 0xbeef'0000, 4);
+      testbed.run(1);
+
+      THEN("One prefetcher issues and the other's candidates are dropped") {
+        REQUIRE(testbed.stats(0).issued + testbed.stats(1).issued == 4);
+        REQUIRE(testbed.stats(0).dropped + testbed.stats(1).dropped == 4);
+      }
+
+      AND_WHEN("A prefetcher requests a line whose candidate was dropped") {
+        auto dropped_source = testbed.stats(0).dropped > 0 ? first_source : second_source;
+        auto dropped_base = testbed.stats(0).dropped > 0 ? 0xdead'0000 : 0xbeef'0000;
+        testbed.request(dropped_source, dropped_base, 1);
+
+        THEN("The request is not a duplicate") {
+          REQUIRE(testbed.stats(0).duplicate + testbed.stats(1).duplicate == 0);
+        }
+      }
+    }
+  }
+}
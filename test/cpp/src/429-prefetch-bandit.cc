@@ -0,0 +1,78 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+#include "prefetch_orchestrator.h"
+
+SCENARIO("The prefetch orchestrator tries every configuration and then follows the best") {
+  GIVEN("A new orchestrator") {
+    champsim::prefetch_orchestrator uut;
+
+    THEN("Prefetching starts turned off") {
+      REQUIRE(uut.chosen_arm() == 0);
+      REQUIRE_FALSE(uut.prefetch_enabled());
+    }
+
+    WHEN("An epoch of accesses passes") {
+      bool changed = false;
+      for (uint64_t i = 0; i < champsim::prefetch_orchestrator::EPOCH; ++i)
+        changed = uut.record_access(false);
+
+      THEN("The next configuration is tried") {
+        REQUIRE(changed);
+        REQUIRE(uut.chosen_arm() == 1);
+        REQUIRE(uut.prefetch_enabled());
+      }
+    }
+
+    WHEN("One configuration hits much more often than the others") {
+      constexpr unsigned best_arm = 3;
+      for (unsigned arm = 0; arm < champsim::prefetch_orchestrator::NUM_ARMS; ++arm) {
+        REQUIRE(uut.chosen_arm() == arm);
+        for (uint64_t i = 0; i < champsim::prefetch_orchestrator::EPOCH; ++i)
+          uut.record_access(arm == best_arm);
+      }
+
+      THEN("That configuration is chosen") {
+        REQUIRE(uut.chosen_arm() == best_arm);
+      }
+
+      AND_WHEN("That configuration stops hitting") {
+        bool left_best_arm = false;
+        for (int epoch = 0; epoch < 100 && !left_best_arm; ++epoch) {
+          for (uint64_t i = 0; i < champsim::prefetch_orchestrator::EPOCH; ++i)
+            uut.record_access(false);
+          left_best_arm = uut.chosen_arm() != best_arm;
+        }
+
+        THEN("Another configuration is tried") {
+          REQUIRE(left_best_arm);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A cache whose prefetcher is controlled by a bandit starts with prefetching off") {
+  GIVEN("A cache with a bandit") {
+    do_nothing_MRC mock_ll;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}.name("429-uut").lower_level(&mock_ll.queues).set_prefetch_bandit()};
+    std::array<champsim::operable*, 2> elements{{&mock_ll, &uut}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A prefetch is requested") {
+      auto accepted = uut.prefetch_line(0xdead'beef, true, 0);
+
+      THEN("It is dropped") {
+        REQUIRE_FALSE(accepted);
+        REQUIRE(uut.sim_stats.pf_throttled == 1);
+      }
+    }
+  }
+}
@@ -0,0 +1,19 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+
+SCENARIO("A cache gives its prefetcher the parameters it was configured with") {
+  GIVEN("A cache with one prefetcher parameter") {
+    do_nothing_MRC mock_ll;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}.name("430-uut").lower_level(&mock_ll.queues).prefetcher_parameters({{"table_sets", 2048}})};
+
+    THEN("The configured parameter is returned") {
+      REQUIRE(uut.get_prefetcher_parameter("table_sets", 512) == 2048);
+    }
+
+    THEN("A parameter that was not configured takes its default") {
+      REQUIRE(uut.get_prefetcher_parameter("table_ways", 8) == 8);
+    }
+  }
+}
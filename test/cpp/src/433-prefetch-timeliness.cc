@@ -0,0 +1,108 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+#include <numeric>
+
+namespace
+{
+struct timeliness_testbed {
+  constexpr static uint64_t hit_latency = 1;
+  constexpr static uint64_t miss_latency = 100;
+
+  do_nothing_MRC mock_ll{miss_latency};
+  to_rq_MRP mock_ul;
+  CACHE uut;
+  std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+
+  explicit timeliness_testbed(std::string name)
+      : uut{CACHE::Builder{champsim::defaults::default_l1d}.name(name).upper_levels({&mock_ul.queues}).lower_level(&mock_ll.queues).hit_latency(hit_latency)}
+  {
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+  }
+
+  void load(uint64_t address)
+  {
+    decltype(mock_ul)::request_type packet;
+    packet.address = address;
+    packet.type = access_type::LOAD;
+    packet.instr_id = 1;
+    packet.cpu = 0;
+    REQUIRE(mock_ul.issue(packet));
+  }
+
+  void run(uint64_t cycles)
+  {
+    for (uint64_t i = 0; i < cycles; ++i)
+      for (auto elem : elements)
+        elem->_operate();
+  }
+};
+
+uint64_t total(const cycle_histogram& histogram) { return std::accumulate(std::begin(histogram.buckets), std::end(histogram.buckets), uint64_t{0}); }
+
+uint64_t total_below(const cycle_histogram& histogram, uint64_t cycles)
+{
+  return std::accumulate(std::begin(histogram.buckets), std::next(std::begin(histogram.buckets), champsim::msl::lg2(cycles) + 1), uint64_t{0});
+}
+} // namespace
+
+SCENARIO("Cycle histograms count intervals in power-of-two buckets") {
+  GIVEN("An empty histogram") {
+    cycle_histogram histogram;
+
+    WHEN("Intervals are recorded") {
+      for (uint64_t cycles : {0, 1, 2, 3, 4, 1000})
+        histogram.record(cycles);
+      histogram.record(std::numeric_limits<uint64_t>::max());
+
+      THEN("Each is counted in its bucket") {
+        REQUIRE(histogram.buckets[0] == 1);
+        REQUIRE(histogram.buckets[1] == 1);
+        REQUIRE(histogram.buckets[2] == 2);
+        REQUIRE(histogram.buckets[3] == 1);
+        REQUIRE(histogram.buckets[10] == 1);
+        REQUIRE(histogram.buckets.back() == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("A cache measures how early its prefetches arrive") {
+  GIVEN("A cache with a prefetch in flight") {
+    timeliness_testbed testbed{"433a-uut"};
+    REQUIRE(testbed.uut.prefetch_line(0xbeef'0000, true, 0));
+
+    WHEN("The prefetch fills long before a load uses it") {
+      testbed.run(3 * timeliness_testbed::miss_latency);
+      testbed.load(0xbeef'0000);
+      testbed.run(2 * timeliness_testbed::hit_latency + 2);
+
+      THEN("The lead time is recorded, and the prefetch was not late") {
+        REQUIRE(testbed.uut.sim_stats.pf_useful == 1);
+        REQUIRE(total(testbed.uut.sim_stats.pf_lead_time) == 1);
+        REQUIRE(total_below(testbed.uut.sim_stats.pf_lead_time, timeliness_testbed::miss_latency) == 0);
+        REQUIRE(total(testbed.uut.sim_stats.pf_late_by) == 0);
+      }
+    }
+
+    WHEN("A load finds the prefetch still in flight") {
+      testbed.run(2 * timeliness_testbed::hit_latency + 2);
+      testbed.load(0xbeef'0000);
+      testbed.run(2 * timeliness_testbed::miss_latency);
+
+      THEN("The time the load waited for the fill is recorded") {
+        REQUIRE(testbed.uut.sim_stats.pf_late == 1);
+        REQUIRE(total(testbed.uut.sim_stats.pf_late_by) == 1);
+        REQUIRE(total_below(testbed.uut.sim_stats.pf_late_by, timeliness_testbed::miss_latency / 2) == 0);
+        REQUIRE(total(testbed.uut.sim_stats.pf_lead_time) == 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,108 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+namespace
+{
+template <unsigned long long R>
+struct insertion_testbed {
+  constexpr static uint64_t hit_latency = 1;
+  constexpr static uint64_t miss_latency = 10;
+
+  do_nothing_MRC mock_ll{miss_latency};
+  to_rq_MRP mock_ul;
+  CACHE uut;
+  std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+
+  explicit insertion_testbed(std::string name)
+      : uut{CACHE::Builder{champsim::defaults::default_l1d}
+                .name(name)
+                .sets(1)
+                .ways(2)
+                .upper_levels({&mock_ul.queues})
+                .lower_level(&mock_ll.queues)
+                .hit_latency(hit_latency)
+                .template replacement<R>()}
+  {
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+  }
+
+  void load(uint64_t address)
+  {
+    typename decltype(mock_ul)::request_type packet;
+    packet.address = address;
+    packet.type = access_type::LOAD;
+    packet.instr_id = 1;
+    packet.cpu = 0;
+    REQUIRE(mock_ul.issue(packet));
+    run(4 * miss_latency);
+  }
+
+  void prefetch(uint64_t address, champsim::insertion_priority priority)
+  {
+    REQUIRE(uut.prefetch_line(address, true, 0, priority));
+    run(4 * miss_latency);
+  }
+
+  void run(uint64_t cycles)
+  {
+    for (uint64_t i = 0; i < cycles; ++i)
+      for (auto elem : elements)
+        elem->_operate();
+  }
+
+  uint64_t load_hits() const { return uut.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0); }
+};
+
+template <unsigned long long R>
+void check_insertion(std::string name)
+{
+  GIVEN("A two-way cache holding a demanded line") {
+    insertion_testbed<R> testbed{name};
+    testbed.load(0x1000);
+
+    WHEN("A low-priority prefetch fills the other way") {
+      testbed.prefetch(0x2000, champsim::insertion_priority::low);
+
+      THEN("The prefetched block carries its hint") {
+        REQUIRE(testbed.uut.get_insertion_priority(0, 1) == champsim::insertion_priority::low);
+        REQUIRE(testbed.uut.get_insertion_priority(0, 0) == champsim::insertion_priority::normal);
+      }
+
+      AND_WHEN("Another line is demanded") {
+        testbed.load(0x3000);
+        auto hits = testbed.load_hits();
+        testbed.load(0x1000);
+
+        THEN("The prefetch was evicted instead of the demanded line") {
+          REQUIRE(testbed.load_hits() == hits + 1);
+        }
+      }
+    }
+
+    WHEN("A normal-priority prefetch fills the other way") {
+      testbed.prefetch(0x2000, champsim::insertion_priority::normal);
+
+      AND_WHEN("Another line is demanded") {
+        testbed.load(0x3000);
+        auto hits = testbed.load_hits();
+        testbed.load(0x2000);
+
+        THEN("The demanded line was evicted instead of the prefetch") {
+          REQUIRE(testbed.load_hits() == hits + 1);
+        }
+      }
+    }
+  }
+}
+} // namespace
+
+SCENARIO("LRU inserts low-priority prefetches at the LRU position") { check_insertion<CACHE::rreplacementDlru>("434a-uut"); }
+
+SCENARIO("SRRIP inserts low-priority prefetches with a distant re-reference") { check_insertion<CACHE::rreplacementDsrrip>("434b-uut"); }
@@ -0,0 +1,94 @@
+#include <catch.hpp>
+#include "defaults.hpp"
+#include "access_log.h"
+#include "cache.h"
+#include "champsim_constants.h"
+#include "prefetch_replay.h"
+
+#include <cstdio>
+#include <filesystem>
+
+SCENARIO("Access logs read back the records that were written") {
+  GIVEN("A log of two accesses") {
+    auto file_name = (std::filesystem::temp_directory_path() / "435a-access.log").string();
+    {
+      champsim::access_log_writer writer{file_name};
+      writer.write({0xdeadbeef, 0xcafe, true, access_type::LOAD});
+      writer.write({0xfeedf00d, 0, false, access_type::PREFETCH});
+    }
+
+    WHEN("The log is read") {
+      champsim::access_log_reader reader{file_name};
+      auto first = reader.read();
+      auto second = reader.read();
+      auto third = reader.read();
+
+      THEN("Each record is read in order, then the log ends") {
+        REQUIRE(first.has_value());
+        REQUIRE(first->address == 0xdeadbeef);
+        REQUIRE(first->ip == 0xcafe);
+        REQUIRE(first->hit);
+        REQUIRE(first->type == access_type::LOAD);
+
+        REQUIRE(second.has_value());
+        REQUIRE(second->address == 0xfeedf00d);
+        REQUIRE(second->ip == 0);
+        REQUIRE_FALSE(second->hit);
+        REQUIRE(second->type == access_type::PREFETCH);
+
+        REQUIRE_FALSE(third.has_value());
+      }
+    }
+
+    std::remove(file_name.c_str());
+  }
+}
+
+SCENARIO("A replay measures how well a prefetcher covers a stream of accesses") {
+  auto fill_latency = GENERATE(as<uint64_t>{}, 0, 4);
+
+  GIVEN("A next-line prefetcher, replayed with a fill latency of " + std::to_string(fill_latency) + " accesses") {
+    CACHE uut{CACHE::Builder{champsim::defaults::default_llc}.name("435b-uut").prefetcher<CACHE::pprefetcherDnext_line>()};
+    uut.initialize();
+    uut.begin_phase();
+    champsim::prefetch_replay replay{uut, fill_latency};
+
+    WHEN("A sequential stream is replayed") {
+      constexpr uint64_t num_accesses = 100;
+      for (uint64_t i = 0; i < num_accesses; ++i)
+        replay.replay({0xbeef'0000 + i * BLOCK_SIZE, 0xcafe, false, access_type::LOAD});
+
+      const auto& stats = replay.get_stats();
+      THEN("Every access after the first was prefetched") {
+        REQUIRE(stats.demand_accesses == num_accesses);
+        REQUIRE(stats.recorded_demand_misses == num_accesses);
+        REQUIRE(stats.demand_misses == 1);
+        REQUIRE(stats.pf_useful == num_accesses - 1);
+        REQUIRE(stats.pf_useless == 0);
+        REQUIRE(stats.coverage() == Approx(static_cast<double>(num_accesses - 1) / num_accesses));
+      }
+
+      if (fill_latency > 0) {
+        THEN("The prefetches arrived too late") {
+          REQUIRE(stats.pf_late == num_accesses - 1);
+        }
+      } else {
+        THEN("The prefetches arrived in time") {
+          REQUIRE(stats.pf_late == 0);
+        }
+      }
+    }
+
+    WHEN("The same line is accessed repeatedly") {
+      for (uint64_t i = 0; i < 10; ++i)
+        replay.replay({0xbeef'0000, 0xcafe, false, access_type::LOAD});
+
+      const auto& stats = replay.get_stats();
+      THEN("The prefetches were not useful") {
+        REQUIRE(stats.pf_issued == 1);
+        REQUIRE(stats.pf_useful == 0);
+        REQUIRE(stats.accuracy() == 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,53 @@
+#include <catch.hpp>
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+#include "prefetcher_under_test.h"
+
+#include <stdexcept>
+
+SCENARIO("The Berti prefetcher learns a timely delta from the miss latency") {
+  GIVEN("A cache whose misses take many times longer than the interval between accesses") {
+    constexpr uint64_t latency = 50;
+    constexpr uint64_t interval = 10;
+    constexpr uint64_t page = 0xffff'0000;
+    test::prefetcher_under_test trained{CACHE::Builder{champsim::defaults::default_l1d}.name("454-uut-trained").prefetcher<CACHE::pprefetcherDberti>(), latency};
+
+    WHEN("Consecutive blocks of a page are accessed") {
+      constexpr uint64_t accesses = 24;
+      for (uint64_t offset = 0; offset < accesses; ++offset)
+        trained.access(page + offset * BLOCK_SIZE, interval);
+      trained.run(2 * latency);
+
+      THEN("The cache issues prefetches in addition to the demand misses") {
+        REQUIRE(trained.mock_ll.packet_count() > accesses);
+      }
+
+      AND_WHEN("Another cache with its own Berti sees a new block of the same page") {
+        test::prefetcher_under_test fresh{CACHE::Builder{champsim::defaults::default_l1d}.name("454-uut-fresh").prefetcher<CACHE::pprefetcherDberti>(), latency};
+        fresh.access(page + accesses * BLOCK_SIZE, 2 * latency);
+
+        THEN("It has learned nothing from the first cache") {
+          REQUIRE(fresh.mock_ll.packet_count() == 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("The Berti prefetcher rejects tables without entries") {
+  auto parameter = GENERATE(as<std::string>{}, "current_pages_table_entries", "prev_requests_table_entries", "prev_prefetches_table_entries",
+                            "record_pages_table_entries", "ip_table_entries");
+  GIVEN("A cache whose Berti parameter " + parameter + " is 0") {
+    do_nothing_MRC mock_ll;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+                  .name("454-uut-" + parameter)
+                  .lower_level(&mock_ll.queues)
+                  .prefetcher<CACHE::pprefetcherDberti>()
+                  .prefetcher_parameters({{parameter, 0}})};
+
+    THEN("The cache cannot be initialized") {
+      REQUIRE_THROWS_AS(uut.initialize(), std::invalid_argument);
+    }
+  }
+}
@@ -0,0 +1,72 @@
+#include <catch.hpp>
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+#include "prefetcher_under_test.h"
+
+#include <stdexcept>
+
+namespace
+{
+const std::array<uint64_t, 4> sequence{{0x1234'5000, 0x0042'0fc0, 0x7777'0100, 0x0101'0040}};
+
+auto single_block_cache(std::string name)
+{
+  return CACHE::Builder{champsim::defaults::default_l1d}.name(name).sets(1).ways(1).prefetcher<CACHE::pprefetcherDtriage>();
+}
+} // namespace
+
+SCENARIO("The Triage prefetcher replays a recurring irregular sequence") {
+  GIVEN("A single-block cache that has missed on a sequence of unrelated lines") {
+    test::prefetcher_under_test triage{single_block_cache("455-uut")};
+    for (auto address : sequence)
+      triage.access(address);
+
+    THEN("Only the demand misses reached the lower level") {
+      REQUIRE(triage.mock_ll.packet_count() == std::size(sequence));
+    }
+
+    WHEN("The first line of the sequence is accessed again") {
+      triage.access(sequence.at(0));
+
+      THEN("Its two successors are prefetched") {
+        REQUIRE(triage.mock_ll.packet_count() == std::size(sequence) + 3);
+        std::array<uint64_t, 3> expected{{sequence.at(0), sequence.at(1), sequence.at(2)}};
+        REQUIRE(std::is_permutation(std::prev(std::end(triage.mock_ll.addresses), 3), std::end(triage.mock_ll.addresses), std::begin(expected)));
+      }
+    }
+  }
+}
+
+SCENARIO("The Triage prefetcher follows as many successors as its lookahead") {
+  auto lookahead = GENERATE(as<uint64_t>{}, 1, 3);
+  GIVEN("A single-block cache with a lookahead of " + std::to_string(lookahead) + " that has missed on a sequence of unrelated lines") {
+    test::prefetcher_under_test triage{single_block_cache("455-uut-" + std::to_string(lookahead)).prefetcher_parameters({{"lookahead", lookahead}})};
+    for (auto address : sequence)
+      triage.access(address);
+
+    WHEN("The first line of the sequence is accessed again") {
+      triage.access(sequence.at(0));
+
+      THEN("As many successors as the lookahead are prefetched") {
+        REQUIRE(triage.mock_ll.packet_count() == std::size(sequence) + 1 + lookahead);
+      }
+    }
+  }
+}
+
+SCENARIO("The Triage prefetcher rejects a metadata store that cannot be indexed") {
+  GIVEN("A cache whose Triage metadata budget does not divide into a power-of-two number of sets") {
+    do_nothing_MRC mock_ll;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("455-uut-invalid")
+      .lower_level(&mock_ll.queues)
+      .prefetcher<CACHE::pprefetcherDtriage>()
+      .prefetcher_parameters({{"metadata_budget", 3 * 1024}, {"metadata_ways", 16}})
+    };
+
+    THEN("The cache cannot be initialized") {
+      REQUIRE_THROWS_AS(uut.initialize(), std::invalid_argument);
+    }
+  }
+}
@@ -0,0 +1,95 @@
+#include <catch.hpp>
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+#include "prefetcher_under_test.h"
+
+#include <stdexcept>
+
+namespace
+{
+auto va_ampm_lite_cache(std::string name, std::map<std::string, uint64_t> parameters)
+{
+  return CACHE::Builder{champsim::defaults::default_l1d}.name(name).prefetcher<CACHE::pprefetcherDva_ampm_lite>().prefetcher_parameters(parameters);
+}
+
+bool was_requested(const test::prefetcher_under_test& cache, uint64_t address)
+{
+  return std::find(std::begin(cache.mock_ll.addresses), std::end(cache.mock_ll.addresses), address) != std::end(cache.mock_ll.addresses);
+}
+} // namespace
+
+SCENARIO("The va_ampm_lite prefetcher tracks as many regions as it is configured to") {
+  auto [sets, ways] = GENERATE(table<uint64_t, uint64_t>({{16, 8}, {1, 1}}));
+  GIVEN("A region table with " + std::to_string(sets) + " sets and " + std::to_string(ways) + " ways") {
+    test::prefetcher_under_test uut{va_ampm_lite_cache("456a-uut-" + std::to_string(sets) + "x" + std::to_string(ways), {{"region_sets", sets}, {"region_ways", ways}})};
+
+    WHEN("Two pages are accessed in turn with a stride") {
+      constexpr uint64_t accesses = 6;
+      for (uint64_t offset = 0; offset < accesses; ++offset) {
+        uut.access(0xdead'0000 + offset * BLOCK_SIZE);
+        uut.access(0xbeef'0000 + offset * BLOCK_SIZE);
+      }
+
+      if (sets * ways > 1) {
+        THEN("Both regions are tracked, and the strides are prefetched") {
+          REQUIRE(uut.mock_ll.packet_count() > 2 * accesses);
+        }
+      } else {
+        THEN("Each page evicts the other's region, so nothing is prefetched") {
+          REQUIRE(uut.mock_ll.packet_count() == 2 * accesses);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("The va_ampm_lite prefetcher searches for patterns in the first pages of the address space") {
+  GIVEN("A cache with the default region table") {
+    test::prefetcher_under_test uut{va_ampm_lite_cache("456b-uut", {})};
+
+    WHEN("The first blocks of page 0 are accessed with a stride") {
+      constexpr uint64_t accesses = 4;
+      for (uint64_t offset = 1; offset <= accesses; ++offset)
+        uut.access(offset * BLOCK_SIZE);
+
+      THEN("The block after the last access is prefetched") {
+        REQUIRE(uut.mock_ll.packet_count() > accesses);
+        REQUIRE(was_requested(uut, (accesses + 1) * BLOCK_SIZE));
+      }
+    }
+  }
+}
+
+SCENARIO("The va_ampm_lite prefetcher finds long strides in the negative direction") {
+  GIVEN("A cache with the default region table") {
+    test::prefetcher_under_test uut{va_ampm_lite_cache("456c-uut", {})};
+
+    WHEN("Blocks more than half the maximum distance apart are accessed in descending order") {
+      constexpr uint64_t base = 0x1000'0000;
+      constexpr uint64_t stride = 160 * BLOCK_SIZE;
+
+      // The first access to each page only starts tracking its region, so each block is accessed twice
+      for (auto address : {base + 2 * stride, base + stride, base}) {
+        uut.access(address);
+        uut.access(address);
+      }
+
+      THEN("The next block in the descending stride is prefetched") {
+        REQUIRE(was_requested(uut, base - stride));
+      }
+    }
+  }
+}
+
+SCENARIO("The va_ampm_lite prefetcher rejects a region table without entries") {
+  auto parameter = GENERATE(as<std::string>{}, "region_sets", "region_ways");
+  GIVEN("A cache whose va_ampm_lite parameter " + parameter + " is 0") {
+    do_nothing_MRC mock_ll;
+    CACHE uut{va_ampm_lite_cache("456d-uut-" + parameter, {{parameter, 0}}).lower_level(&mock_ll.queues)};
+
+    THEN("The cache cannot be initialized") {
+      REQUIRE_THROWS_AS(uut.initialize(), std::invalid_argument);
+    }
+  }
+}
@@ -0,0 +1,82 @@
+#include <catch.hpp>
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+#include "prefetcher_under_test.h"
+
+#include <stdexcept>
+
+namespace
+{
+auto spp_dev_cache(std::string name, std::map<std::string, uint64_t> parameters)
+{
+  return CACHE::Builder{champsim::defaults::default_l2c}.name(name).prefetcher<CACHE::pprefetcherDspp_dev>().prefetcher_parameters(parameters);
+}
+} // namespace
+
+SCENARIO("Each cache with the SPP prefetcher learns its own signatures") {
+  GIVEN("A cache with the SPP prefetcher") {
+    constexpr uint64_t page = 0xffff'0000;
+    test::prefetcher_under_test trained{spp_dev_cache("457a-uut-trained", {})};
+
+    WHEN("Consecutive blocks of a page are accessed") {
+      constexpr uint64_t accesses = 12;
+      for (uint64_t offset = 0; offset < accesses; ++offset)
+        trained.access(page + offset * BLOCK_SIZE);
+
+      THEN("The cache issues prefetches in addition to the demand misses") {
+        REQUIRE(trained.mock_ll.packet_count() > accesses);
+      }
+
+      AND_WHEN("Another cache with its own SPP sees a new block of the same page") {
+        test::prefetcher_under_test fresh{spp_dev_cache("457a-uut-fresh", {})};
+        fresh.access(page + accesses * BLOCK_SIZE);
+
+        THEN("It has learned nothing from the first cache") {
+          REQUIRE(fresh.mock_ll.packet_count() == 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("The SPP signature table holds as many pages as it is configured to") {
+  auto ways = GENERATE(as<uint64_t>{}, 256, 1);
+  GIVEN("A signature table with " + std::to_string(ways) + " ways") {
+    test::prefetcher_under_test uut{spp_dev_cache("457b-uut-" + std::to_string(ways), {{"st_sets", 1}, {"st_ways", ways}})};
+
+    WHEN("Two pages are accessed in turn with a stride") {
+      constexpr uint64_t accesses = 12;
+      for (uint64_t offset = 0; offset < accesses; ++offset) {
+        uut.access(0xdead'0000 + offset * BLOCK_SIZE);
+        uut.access(0xbeef'0000 + offset * BLOCK_SIZE);
+      }
+
+      if (ways > 1) {
+        THEN("Both pages build signatures, and the strides are prefetched") {
+          REQUIRE(uut.mock_ll.packet_count() > 2 * accesses);
+        }
+      } else {
+        THEN("Each page evicts the other's signature, so nothing is prefetched") {
+          REQUIRE(uut.mock_ll.packet_count() == 2 * accesses);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("The SPP prefetcher rejects tables without entries") {
+  auto parameter = GENERATE(as<std::string>{}, "st_sets", "st_ways", "pt_sets", "pt_ways", "filter_sets", "ghr_size");
+  GIVEN("A cache whose SPP parameter " + parameter + " is 0") {
+    do_nothing_MRC mock_ll;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+                  .name("457c-uut-" + parameter)
+                  .lower_level(&mock_ll.queues)
+                  .prefetcher<CACHE::pprefetcherDspp_dev>()
+                  .prefetcher_parameters({{parameter, 0}})};
+
+    THEN("The cache cannot be initialized") {
+      REQUIRE_THROWS_AS(uut.initialize(), std::invalid_argument);
+    }
+  }
+}
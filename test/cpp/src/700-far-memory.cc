@@ -0,0 +1,115 @@
+#include <catch.hpp>
+
+#include "champsim_constants.h"
+#include "channel.h"
+#include "dram_controller.h"
+#include "vmem.h"
+
+SCENARIO("The far memory returns reads after crossing the link twice") {
+  GIVEN("An idle far memory") {
+    FAR_MEMORY uut{3200, 4, 25, 80, 2, 0, 0};
+    champsim::channel ul{};
+
+    WHEN("A read is added") {
+      FAR_MEMORY::request_type packet;
+      packet.address = 0xdeadbeef;
+      packet.to_return = {&ul.returned};
+      REQUIRE(uut.add(packet, 0));
+
+      uint64_t cycle = 0;
+      while (std::empty(ul.returned) && cycle < 10000)
+        uut.operate(cycle++, false);
+
+      THEN("The response arrives after the link, device, and transfer latencies") {
+        REQUIRE(std::size(ul.returned) == 1);
+        REQUIRE(ul.returned.front().address == 0xdeadbeef);
+        REQUIRE(cycle - 1 == uut.TRANSFER_CYCLES + uut.DEVICE_LATENCY + 2 * uut.LINK_LATENCY);
+        REQUIRE(uut.sim_stats.reads == 1);
+        REQUIRE(uut.sim_stats.total_read_latency == cycle - 1);
+      }
+    }
+
+    WHEN("More requests are added than the link queue holds") {
+      for (uint64_t i = 0; i < uut.LINK_QUEUE_SIZE; ++i) {
+        FAR_MEMORY::request_type packet;
+        packet.address = i << LOG2_BLOCK_SIZE;
+        REQUIRE(uut.add(packet, 0));
+      }
+
+      FAR_MEMORY::request_type packet;
+      packet.address = 0xdeadbeef;
+
+      THEN("The extra request is rejected") {
+        REQUIRE_FALSE(uut.add(packet, 0));
+        REQUIRE(uut.sim_stats.link_full == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("The far memory promotes frequently accessed pages") {
+  GIVEN("A far memory that promotes a single page after two accesses") {
+    FAR_MEMORY uut{3200, 16, 25, 80, 2, 2, 1};
+
+    auto access = [&](uint64_t address) {
+      FAR_MEMORY::request_type packet;
+      packet.address = address;
+      return uut.add(packet, 0);
+    };
+
+    WHEN("A page is accessed twice") {
+      REQUIRE(access(0x10000));
+      REQUIRE(access(0x10040));
+
+      THEN("The page is promoted") {
+        REQUIRE(uut.is_promoted(0x10080));
+        REQUIRE(uut.sim_stats.promotions == 1);
+      }
+
+      AND_WHEN("Another page is accessed twice") {
+        REQUIRE(access(0x20000));
+        REQUIRE(access(0x20000));
+
+        THEN("The older page is demoted") {
+          REQUIRE(uut.is_promoted(0x20000));
+          REQUIRE_FALSE(uut.is_promoted(0x10000));
+          REQUIRE(uut.sim_stats.demotions == 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Interleaved placement spreads pages across the memory tiers") {
+  GIVEN("A memory controller with a far memory and an interleaving virtual memory") {
+    MEMORY_CONTROLLER dram{1, 3200, 12.5, 12.5, 12.5, 7.5, {}, FAR_MEMORY{3200, 16, 25, 80, 2, 0, 0}};
+    VirtualMemory uut{1ull << 12, 5, 200, dram, VirtualMemory::placement_type::interleave};
+
+    WHEN("Two pages are translated") {
+      auto [paddr_a, delay_a] = uut.va_to_pa(0, 0x1000);
+      auto [paddr_b, delay_b] = uut.va_to_pa(0, 0x2000);
+
+      THEN("One page is in each tier") {
+        REQUIRE(paddr_a < dram.size());
+        REQUIRE(paddr_b >= dram.size());
+        REQUIRE_FALSE(dram.is_far(paddr_a));
+        REQUIRE(dram.is_far(paddr_b));
+      }
+    }
+  }
+
+  GIVEN("A memory controller without a far memory") {
+    MEMORY_CONTROLLER dram{1, 3200, 12.5, 12.5, 12.5, 7.5, {}};
+    VirtualMemory uut{1ull << 12, 5, 200, dram, VirtualMemory::placement_type::interleave};
+
+    WHEN("Two pages are translated") {
+      auto [paddr_a, delay_a] = uut.va_to_pa(0, 0x1000);
+      auto [paddr_b, delay_b] = uut.va_to_pa(0, 0x2000);
+
+      THEN("Both pages are in the near memory") {
+        REQUIRE(paddr_a < dram.size());
+        REQUIRE(paddr_b < dram.size());
+      }
+    }
+  }
+}
@@ -0,0 +1,185 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include "channel.h"
+#include "dram_cache.h"
+
+namespace
+{
+struct dram_cache_harness {
+  champsim::channel ul{};
+  champsim::channel ll{};
+  DRAM_CACHE uut;
+  uint64_t memory_reads = 0;
+
+  explicit dram_cache_harness(std::size_t predictor_size)
+      : uut{DRAM_CACHE::Builder{}
+                .name("701-uut")
+                .sets(16)
+                .mshr_size(8)
+                .tag_bandwidth(1)
+                .fill_bandwidth(1)
+                .timing(10, 10, 10)
+                .io_frequency(1000)
+                .miss_predictor_size(predictor_size)
+                .upper_levels({&ul})
+                .lower_level(&ll)}
+  {
+    uut.warmup = false;
+    uut.begin_phase();
+  }
+
+  bool issue(uint64_t address, uint64_t ip)
+  {
+    champsim::channel::request_type pkt;
+    pkt.address = address;
+    pkt.v_address = address;
+    pkt.ip = ip;
+    pkt.cpu = 0;
+    return ul.add_rq(pkt);
+  }
+
+  // The memory returns every request in the cycle after it is sent
+  void run_memory()
+  {
+    for (const auto& pkt : ll.RQ)
+      ll.returned.push_back(champsim::channel::response_type{pkt});
+    memory_reads += std::size(ll.RQ);
+    ll.RQ.clear();
+  }
+
+  // Like the memory controller, reads of the same block are merged into one response
+  void run_merging_memory()
+  {
+    std::vector<uint64_t> blocks;
+    for (const auto& pkt : ll.RQ) {
+      if (std::find(std::begin(blocks), std::end(blocks), pkt.address >> LOG2_BLOCK_SIZE) == std::end(blocks)) {
+        blocks.push_back(pkt.address >> LOG2_BLOCK_SIZE);
+        ll.returned.push_back(champsim::channel::response_type{pkt});
+      }
+    }
+    memory_reads += std::size(blocks);
+    ll.RQ.clear();
+  }
+
+  void run_until_returned()
+  {
+    for (int i = 0; i < 1000 && std::empty(ul.returned); ++i) {
+      uut._operate();
+      run_memory();
+    }
+  }
+};
+} // namespace
+
+SCENARIO("A DRAM cache serves repeated reads from the stacked DRAM") {
+  GIVEN("An empty DRAM cache without a miss predictor") {
+    dram_cache_harness harness{0};
+
+    WHEN("A block is read") {
+      REQUIRE(harness.issue(0xdeadbeef, 0));
+      harness.run_until_returned();
+
+      THEN("The block is fetched from memory") {
+        REQUIRE(std::size(harness.ul.returned) == 1);
+        REQUIRE(harness.memory_reads == 1);
+        REQUIRE(harness.uut.sim_stats.misses.at(champsim::to_underlying(access_type::LOAD)) == 1);
+      }
+
+      AND_WHEN("The block is read again") {
+        harness.ul.returned.clear();
+        REQUIRE(harness.issue(0xdeadbeef, 0));
+        harness.run_until_returned();
+
+        THEN("The block is returned without accessing memory") {
+          REQUIRE(std::size(harness.ul.returned) == 1);
+          REQUIRE(harness.memory_reads == 1);
+          REQUIRE(harness.uut.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)) == 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("The DRAM cache miss predictor sends predicted misses to memory with the lookup") {
+  GIVEN("A DRAM cache whose miss predictor has seen an instruction miss repeatedly") {
+    dram_cache_harness harness{16};
+    constexpr uint64_t ip = 0xcafe;
+    for (uint64_t i = 0; i < 4; ++i) {
+      harness.ul.returned.clear();
+      REQUIRE(harness.issue(i << LOG2_BLOCK_SIZE, ip));
+      harness.run_until_returned();
+    }
+
+    REQUIRE(harness.uut.sim_stats.predictor_late_miss == 4);
+    REQUIRE(harness.uut.predict_miss(ip, 0));
+
+    WHEN("The instruction reads another block") {
+      REQUIRE(harness.issue(0x1000, ip));
+      harness.uut._operate();
+
+      THEN("The read is sent to memory in the same cycle") {
+        REQUIRE(std::size(harness.ll.RQ) == 1);
+      }
+
+      AND_WHEN("The read completes") {
+        harness.ul.returned.clear();
+        harness.run_until_returned();
+
+        THEN("The prediction was correct") {
+          REQUIRE(std::size(harness.ul.returned) == 1);
+          REQUIRE(harness.uut.sim_stats.predictor_correct == 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Reads of a block that was mispredicted to miss all return") {
+  GIVEN("A DRAM cache whose miss predictor predicts an instruction to miss, and a block that is present") {
+    dram_cache_harness harness{16};
+    constexpr uint64_t ip = 0xcafe;
+    for (uint64_t i = 0; i < 8; ++i) {
+      harness.ul.returned.clear();
+      REQUIRE(harness.issue(i << LOG2_BLOCK_SIZE, ip));
+      harness.run_until_returned();
+    }
+    harness.ul.returned.clear();
+
+    REQUIRE(harness.uut.predict_miss(ip, 0));
+
+    WHEN("The instruction reads the block, and the lookup hits while memory is still fetching it") {
+      REQUIRE(harness.issue(0, ip));
+      for (int i = 0; i < 1000 && std::empty(harness.ul.returned); ++i)
+        harness.uut._operate();
+
+      REQUIRE(std::size(harness.ul.returned) == 1);
+      REQUIRE(harness.uut.sim_stats.predictor_wasted_fetch == 1);
+
+      AND_WHEN("A second read of the block is sent to memory, and the block is evicted before its lookup") {
+        REQUIRE(harness.issue(0, ip));
+        harness.uut._operate();
+        REQUIRE(std::size(harness.ll.RQ) == 2);
+
+        champsim::channel::request_type write;
+        write.address = harness.uut.NUM_SET << LOG2_BLOCK_SIZE;
+        write.v_address = write.address;
+        write.type = access_type::WRITE;
+        REQUIRE(harness.ul.add_wq(write));
+        for (int i = 0; i < 1000; ++i)
+          harness.uut._operate();
+
+        THEN("Both reads return when memory responds once for the block") {
+          harness.run_merging_memory();
+          for (int i = 0; i < 1000 && std::size(harness.ul.returned) < 2; ++i)
+            harness.uut._operate();
+
+          REQUIRE(harness.memory_reads == 9);
+          REQUIRE(std::size(harness.ul.returned) == 2);
+        }
+      }
+    }
+  }
+}
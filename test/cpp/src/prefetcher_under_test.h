@@ -0,0 +1,56 @@
+#ifndef TEST_PREFETCHER_UNDER_TEST_H
+#define TEST_PREFETCHER_UNDER_TEST_H
+
+#include <array>
+
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "cache.h"
+
+namespace test
+{
+  /*
+   * A cache between a producer of demand reads and a lower level that returns them, for observing the prefetches of its prefetcher
+   */
+  struct prefetcher_under_test
+  {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut;
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+    uint64_t next_instr_id = 1;
+
+    template <typename B>
+    explicit prefetcher_under_test(B builder, uint64_t latency = 0)
+        : mock_ll{latency}, uut{builder.upper_levels({&mock_ul.queues}).lower_level(&mock_ll.queues)}
+    {
+      for (auto elem : elements) {
+        elem->initialize();
+        elem->warmup = false;
+        elem->begin_phase();
+      }
+    }
+
+    void run(uint64_t cycles)
+    {
+      for (uint64_t i = 0; i < cycles; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+    }
+
+    // Issue a demand read, then run for the given number of cycles
+    void access(uint64_t address, uint64_t cycles = 100)
+    {
+      champsim::channel::request_type packet;
+      packet.address = address;
+      packet.v_address = address;
+      packet.ip = 0xcafecafe;
+      packet.instr_id = next_instr_id++;
+      packet.cpu = 0;
+      REQUIRE(mock_ul.issue(packet));
+      run(cycles);
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,53 @@
+import os
+import tempfile
+import unittest
+
+import config.modules
+
+class DefinesFunctionTests(unittest.TestCase):
+
+    def write_module(self, dirname, contents):
+        with open(os.path.join(dirname, 'module.cc'), 'wt') as wfp:
+            wfp.write(contents)
+
+    def test_defined(self):
+        with tempfile.TemporaryDirectory() as dtemp:
+            self.write_module(dtemp, 'void CACHE::prefetcher_aggressiveness_update(unsigned level) {}\n')
+            self.assertTrue(config.modules.defines_function({'fname': dtemp}, 'prefetcher_aggressiveness_update'))
+
+    def test_not_defined(self):
+        with tempfile.TemporaryDirectory() as dtemp:
+            self.write_module(dtemp, 'void CACHE::impl_prefetcher_aggressiveness_update(unsigned level) {}\n')
+            self.assertFalse(config.modules.defines_function({'fname': dtemp}, 'prefetcher_aggressiveness_update'))
+
+    def test_no_path(self):
+        self.assertTrue(config.modules.defines_function({}, 'prefetcher_aggressiveness_update'))
+
+class OptionalFunctionTests(unittest.TestCase):
+
+    def test_undefined_is_not_called(self):
+        with tempfile.TemporaryDirectory() as dtemp:
+            with open(os.path.join(dtemp, 'module.cc'), 'wt') as wfp:
+                wfp.write('void CACHE::prefetcher_initialize() {}\n')
+
+            pref_data = {'test': {'name': 'test', 'fname': dtemp, **config.modules.get_pref_data('test')}}
+            decls, defs = config.modules.get_cache_module_lines(pref_data, {})
+            decls, defs = list(decls), '\n'.join(defs)
+
+            self.assertIn('[[]] void pref_test_prefetcher_initialize();', decls)
+            self.assertFalse(any('aggressiveness' in line for line in decls))
+            self.assertIn('impl_prefetcher_aggressiveness_update(unsigned level)', defs)
+            self.assertNotIn('intern_->pref_test_prefetcher_aggressiveness_update', defs)
+
+    def test_defined_is_called(self):
+        with tempfile.TemporaryDirectory() as dtemp:
+            with open(os.path.join(dtemp, 'module.cc'), 'wt') as wfp:
+                wfp.write('void CACHE::prefetcher_configuration_update(unsigned degree, unsigned distance) {}\n')
+
+            pref_data = {'test': {'name': 'test', 'fname': dtemp, **config.modules.get_pref_data('test')}}
+            decls, defs = config.modules.get_cache_module_lines(pref_data, {})
+            decls, defs = list(decls), '\n'.join(defs)
+
+            self.assertIn('[[]] void pref_test_prefetcher_configuration_update(unsigned, unsigned);', decls)
+            self.assertIn('intern_->pref_test_prefetcher_configuration_update(degree, distance);', defs)
+            self.assertNotIn('intern_->pref_test_prefetcher_aggressiveness_update', defs)